@@ -0,0 +1,1391 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ThreadPool.h"
+
+// An ordered map from keys to values, or an ordered set of keys if Value is void, stored in a
+// B+ tree. Each node keeps its keys in one array that fills a few cache lines, so a search reads
+// a handful of nodes instead of one scattered node per comparison as in std::map. All the keys
+// are in the leaves, which are linked in order for fast iteration and range scans, and the inner
+// nodes hold copies of keys that separate their children.
+// Keys and values must be default constructible and movable.
+template <class Key, class Value = void, class Compare = std::less<Key>>
+class BTree
+{
+public:
+	// Whether this is a set of keys rather than a map.
+	static constexpr bool is_set = std::is_void_v<Value>;
+
+	// The type of the values of a map. A set has no values, so this is its key type.
+	using mapped_type = std::conditional_t<is_set, Key, Value>;
+
+	// The most keys a node holds. Each node's keys take about four 64-byte cache lines.
+	static constexpr size_t node_capacity = std::max<size_t>(8, 256 / sizeof(Key));
+
+	// The most levels a tree can have. Every inner node but the root has at least five children,
+	// so a tree this tall would need more than 5^46 keys.
+	static constexpr size_t max_height = 48;
+
+private:
+	struct Node;
+	struct Leaf;
+	struct Inner;
+	template <bool is_const>
+	class basic_iterator;
+	enum class Order { preorder, postorder, level_order };
+	template <Order order>
+	class node_iterator;
+	template <Order order>
+	class NodeRange;
+
+public:
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+	using preorder_iterator = node_iterator<Order::preorder>;
+	using postorder_iterator = node_iterator<Order::postorder>;
+	using level_order_iterator = node_iterator<Order::level_order>;
+	class NodeView;
+
+	explicit BTree(Compare less = Compare());
+	BTree(const BTree& other);
+	BTree(BTree&& other) noexcept;
+	~BTree();
+	BTree& operator=(const BTree& other);
+	BTree& operator=(BTree&& other) noexcept;
+
+	// Builds a set from sorted keys, or a map from pairs of keys and values sorted by key, in O(n)
+	// time. The leaves are filled, which makes scans as fast as possible.
+	// Throws std::invalid_argument if the keys are not in increasing order or a key repeats.
+	template <class InputIt>
+	static BTree from_sorted(InputIt first, InputIt last, Compare less = Compare());
+
+	// Adds the key to a set. Returns whether it was added, which it is not if it was already there.
+	bool insert(const Key& key);
+
+	// Adds the key with the value to a map, unless the key is already there.
+	// Returns whether it was added.
+	bool insert(const Key& key, const mapped_type& value);
+
+	// Removes the key and its value. Returns whether it was there.
+	bool erase(const Key& key);
+
+	// Deletes all the keys and values.
+	void clear() noexcept;
+
+	// Returns an iterator to the key, or end() if it is not there.
+	iterator find(const Key& key);
+	const_iterator find(const Key& key) const;
+
+	// Returns whether the key is there.
+	bool contains(const Key& key) const;
+
+	// Returns an iterator to the first key that is not less than the given key, or end().
+	iterator lower_bound(const Key& key);
+	const_iterator lower_bound(const Key& key) const;
+
+	// Returns an iterator to the first key that is greater than the given key, or end().
+	iterator upper_bound(const Key& key);
+	const_iterator upper_bound(const Key& key) const;
+
+	// Returns a reference to a map's value for the key.
+	// Throws std::out_of_range if the key is not there.
+	mapped_type& at(const Key& key);
+	const mapped_type& at(const Key& key) const;
+
+	// Returns a reference to a map's value for the key, adding the key with a default value first
+	// if it is not there.
+	mapped_type& operator[](const Key& key);
+
+	// Calls visit(key) for a set, or visit(key, value) for a map, for each key from low up to
+	// but not including high, in order, and returns how many keys there were. The scan walks the
+	// linked leaves without going back up the tree.
+	template <class Visit>
+	size_t scan(const Key& low, const Key& high, Visit visit) const;
+
+	// Calls visit(key) for a set, or visit(key, value) for a map, for every key in order.
+	template <class Visit>
+	void inorder(Visit visit) const;
+
+	// Calls visit(node, depth) for each node in preorder: each node before its children, from the
+	// first child to the last. The root's depth is 0. This is also a depth-first traversal.
+	template <class Visit>
+	void preorder(Visit visit) const;
+
+	// Calls visit(node, depth) for each node in postorder: each node after its children.
+	template <class Visit>
+	void postorder(Visit visit) const;
+
+	// Calls visit(node, depth) for each node in level order, a breadth-first traversal: the root,
+	// then its children, then their children, and so on, from left to right.
+	template <class Visit>
+	void level_order(Visit visit) const;
+
+	// Calls visit(node, depth) for each node a level at a time like level_order, but splits each
+	// level among the pool's threads. Every node at one depth is visited before any deeper node,
+	// but visit may be called from multiple threads at once and in any order within a level.
+	template <class Visit>
+	void parallel_level_order(Visit visit, ThreadPool& pool = ThreadPool::shared()) const;
+
+	// Return ranges of iterators over the nodes in each order, for range-based for loops.
+	// The iterators keep the path from the root in a fixed-size array, so traversals neither
+	// recurse nor allocate memory, however big the tree is.
+	NodeRange<Order::preorder> preorder_nodes() const noexcept;
+	NodeRange<Order::postorder> postorder_nodes() const noexcept;
+	NodeRange<Order::level_order> level_order_nodes() const noexcept;
+
+	// Returns the number of levels of nodes, which is 0 for an empty tree.
+	size_t height() const noexcept;
+
+	// Prints the keys of each node, one level per line, such as "[5 9]" and then "[1 3] [5 7] [9]".
+	void print(std::ostream& stream) const;
+
+	// Writes the tree's nodes in preorder to a binary stream, so that read rebuilds the same shape.
+	// Requires trivially copyable keys and values. The format is only meant to be read back on
+	// the same platform by a tree with the same types.
+	void write(std::ostream& stream) const;
+
+	// Reads a tree written by write. Throws std::runtime_error if the stream ends early or does
+	// not hold a tree of this type.
+	static BTree read(std::istream& stream, Compare less = Compare());
+
+	// Returns the number of keys.
+	size_t size() const noexcept;
+
+	// Returns true if there are no keys, false otherwise.
+	bool empty() const noexcept;
+
+	// Returns whether two trees have the same keys and values.
+	bool operator==(const BTree& other) const;
+	bool operator!=(const BTree& other) const;
+
+	iterator begin() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+	iterator end() noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+
+	// A read-only view of one node, for the traversals.
+	class NodeView
+	{
+	public:
+		bool is_leaf() const noexcept { return node->is_leaf; }
+		size_t key_count() const noexcept { return node->count; }
+		const Key& key(size_t index) const noexcept { return node->keys()[index]; }
+
+		// An inner node has one more child than it has keys, and a leaf has none.
+		size_t child_count() const noexcept { return node->is_leaf ? 0 : node->count + 1; }
+		NodeView child(size_t index) const noexcept { return NodeView(static_cast<const Inner*>(node)->children[index]); }
+
+		// Returns a leaf's values. A set's leaves have no values.
+		const mapped_type& value(size_t index) const noexcept
+		{
+			static_assert(!is_set, "Sets have no values.");
+			return static_cast<const Leaf*>(node)->values[index];
+		}
+
+	private:
+		friend class BTree;
+		const Node* node;
+		explicit NodeView(const Node* node) noexcept : node{ node } {};
+	};
+
+private:
+	// Takes the place of a set's values, which do not exist.
+	struct NoValues {};
+
+	struct Node
+	{
+		const bool is_leaf;
+		size_t count = 0;
+		explicit Node(bool is_leaf) noexcept : is_leaf{ is_leaf } {};
+		const Key* keys() const noexcept;
+	};
+
+	// Nodes have room for one more key than their capacity, which lets an insertion go ahead
+	// and then split the node if it overflowed.
+	struct Leaf : Node
+	{
+		std::array<Key, node_capacity + 1> keys;
+		std::conditional_t<is_set, NoValues, std::array<mapped_type, node_capacity + 1>> values;
+		Leaf* previous = nullptr;
+		Leaf* next = nullptr;
+		Leaf() : Node(true) {};
+	};
+
+	// Every key in children[i] is less than keys[i], and every key in children[i + 1] is at least keys[i].
+	struct Inner : Node
+	{
+		std::array<Key, node_capacity + 1> keys;
+		std::array<Node*, node_capacity + 2> children{};
+		Inner() : Node(false) {};
+	};
+
+	template <bool is_const>
+	class basic_iterator
+	{
+		using value_reference = std::conditional_t<is_const, const mapped_type&, mapped_type&>;
+
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::conditional_t<is_set, Key, std::pair<const Key, mapped_type>>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = std::conditional_t<is_set, const Key&, std::pair<const Key&, value_reference>>;
+
+		basic_iterator() noexcept {};
+
+		// Allows converting an iterator to a const_iterator.
+		template <bool other_is_const, class = std::enable_if_t<is_const && !other_is_const>>
+		basic_iterator(const basic_iterator<other_is_const>& other) noexcept
+			: leaf{ other.leaf }, index{ other.index }, owner{ other.owner } {};
+
+		// A set's iterators refer to keys, and a map's to pairs of references to a key and its value.
+		reference operator*() const noexcept
+		{
+			if constexpr (is_set)
+				return leaf->keys[index];
+			else
+				return reference(leaf->keys[index], leaf->values[index]);
+		}
+
+		const Key& key() const noexcept { return leaf->keys[index]; }
+
+		// Returns a map's value.
+		value_reference value() const noexcept
+		{
+			static_assert(!is_set, "Sets have no values.");
+			return leaf->values[index];
+		}
+
+		basic_iterator& operator++() noexcept
+		{
+			if (++index == leaf->count)
+			{
+				leaf = leaf->next;
+				index = 0;
+			}
+			return *this;
+		}
+
+		basic_iterator operator++(int) noexcept
+		{
+			basic_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		// Decrementing end() moves to the last key.
+		basic_iterator& operator--() noexcept
+		{
+			if (leaf == nullptr)
+			{
+				leaf = owner->last_leaf;
+				index = leaf->count - 1;
+			}
+			else if (index == 0)
+			{
+				leaf = leaf->previous;
+				index = leaf->count - 1;
+			}
+			else
+				index -= 1;
+			return *this;
+		}
+
+		basic_iterator operator--(int) noexcept
+		{
+			basic_iterator temp = *this;
+			--*this;
+			return temp;
+		}
+
+		bool operator==(const basic_iterator& other) const noexcept
+		{
+			return leaf == other.leaf && index == other.index;
+		}
+
+		bool operator!=(const basic_iterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		friend class BTree;
+		template <bool>
+		friend class basic_iterator;
+		std::conditional_t<is_const, const Leaf*, Leaf*> leaf = nullptr;  // nullptr at end().
+		size_t index = 0;
+		const BTree* owner = nullptr;
+		basic_iterator(std::conditional_t<is_const, const Leaf*, Leaf*> leaf, size_t index, const BTree* owner) noexcept
+			: leaf{ leaf }, index{ index }, owner{ owner } {};
+	};
+
+	// Walks the nodes without recursion, keeping the path from the root to the current node.
+	template <Order order>
+	class node_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = NodeView;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = NodeView;
+
+		node_iterator() noexcept {};
+
+		NodeView operator*() const noexcept { return NodeView(path[_depth].node); }
+
+		// Returns the current node's depth, which is 0 for the root.
+		size_t depth() const noexcept { return _depth; }
+
+		node_iterator& operator++() noexcept
+		{
+			if constexpr (order == Order::preorder)
+			{
+				if (!path[_depth].node->is_leaf)
+					descend(_depth + 1);
+				else if (!next_sibling())
+					finish();
+			}
+			else if constexpr (order == Order::postorder)
+			{
+				// After the last child comes its parent, and after any other child comes the
+				// first leaf below the next child.
+				if (_depth == 0)
+					finish();
+				else if (path[_depth - 1].child == path[_depth - 1].node->count)
+					_depth -= 1;
+				else
+				{
+					next_sibling();
+					descend(max_height);
+				}
+			}
+			else
+			{
+				// Move to the next node at the same depth, or to the first node one level down.
+				if (next_sibling())
+					descend(level);
+				else
+				{
+					level += 1;
+					descend(level);
+					if (_depth < level)
+						finish();
+				}
+			}
+			return *this;
+		}
+
+		node_iterator operator++(int) noexcept
+		{
+			node_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		bool operator==(const node_iterator& other) const noexcept
+		{
+			return path[_depth].node == other.path[other._depth].node;
+		}
+
+		bool operator!=(const node_iterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		friend class BTree;
+
+		struct Frame
+		{
+			const Node* node = nullptr;
+			size_t child = 0;  // The index of the child the path continues into.
+		};
+
+		std::array<Frame, max_height> path{};
+		size_t _depth = 0;
+		size_t level = 0;  // The depth of level order's current level.
+
+		// Starts at the first node at the given depth below root for level order, or at the
+		// first node for the other orders.
+		explicit node_iterator(const Node* root, size_t start_level = 0) noexcept
+			: level{ start_level }
+		{
+			path[0].node = root;
+			if (root == nullptr)
+				return;
+			if constexpr (order == Order::postorder)
+				descend(max_height);
+			else if constexpr (order == Order::level_order)
+			{
+				descend(level);
+				if (_depth < level)
+					finish();
+			}
+		}
+
+		// Makes this the end iterator.
+		void finish() noexcept
+		{
+			path[0].node = nullptr;
+			_depth = 0;
+		}
+
+		// Follows first children down from the current node until reaching a leaf or the
+		// given depth. Since all leaves are at the same depth, this reaches the depth if any node does.
+		void descend(size_t limit) noexcept
+		{
+			while (_depth < limit && !path[_depth].node->is_leaf)
+			{
+				path[_depth].child = 0;
+				path[_depth + 1] = { static_cast<const Inner*>(path[_depth].node)->children[0], 0 };
+				_depth += 1;
+			}
+		}
+
+		// Moves to the next sibling of the current node or of its nearest ancestor that has
+		// one, and returns false at the root if there is none.
+		bool next_sibling() noexcept
+		{
+			for (; _depth > 0; _depth--)
+			{
+				Frame& parent = path[_depth - 1];
+				if (parent.child < parent.node->count)
+				{
+					parent.child += 1;
+					path[_depth] = { static_cast<const Inner*>(parent.node)->children[parent.child], 0 };
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+
+	template <Order order>
+	class NodeRange
+	{
+	public:
+		node_iterator<order> begin() const noexcept { return node_iterator<order>(root); }
+		node_iterator<order> end() const noexcept { return node_iterator<order>(); }
+
+	private:
+		friend class BTree;
+		const Node* root;
+		explicit NodeRange(const Node* root) noexcept : root{ root } {};
+	};
+
+	Node* root = nullptr;
+	Leaf* first_leaf = nullptr;
+	Leaf* last_leaf = nullptr;
+	size_t _size = 0;
+	Compare less;
+
+	// The fewest keys a node other than the root has.
+	static constexpr size_t min_count = node_capacity / 2;
+
+	// Deletes the node and everything below it.
+	static void destroy(Node* node) noexcept;
+
+	// Returns the leaf the key belongs in. The tree must not be empty.
+	Leaf* find_leaf(const Key& key) const;
+
+	// Returns the position of the first key in the leaf that is not less than the given key.
+	size_t leaf_lower_bound(const Leaf* leaf, const Key& key) const;
+
+	// Returns the leaf and index of the first key not less than (or if after_equal, greater than) the key.
+	std::pair<Leaf*, size_t> bound(const Key& key, bool after_equal) const;
+
+	// Inserts the key and value into the subtree below node unless the key is there, and returns
+	// whether it did. If the node overflowed, it splits it and sets split to its new right
+	// sibling and separator to the first key under that sibling.
+	bool insert_into(Node* node, const Key& key, const mapped_type* value, Node*& split, Key& separator);
+
+	// Removes the key from the subtree below node and returns whether it was there.
+	bool erase_from(Node* node, const Key& key);
+
+	// Refills parent->children[i], which has too few keys, from a sibling or by merging with one.
+	void rebalance(Inner* parent, size_t i);
+
+	// Moves count keys and values from one leaf's position to another's.
+	static void move_entries(Leaf* from, size_t from_index, Leaf* to, size_t to_index, size_t count);
+
+	// Builds the inner levels above the given nodes, whose smallest keys are lows, and makes the
+	// top one the root.
+	void build_levels(std::vector<Node*> nodes, std::vector<Key> lows);
+
+};
+
+////////////////////////////////
+// BTree<Key, Value, Compare> //
+////////////////////////////////
+
+template <class Key, class Value, class Compare>
+inline const Key* BTree<Key, Value, Compare>::Node::keys() const noexcept
+{
+	return is_leaf ? static_cast<const Leaf*>(this)->keys.data() : static_cast<const Inner*>(this)->keys.data();
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>::BTree(Compare less)
+	: less{ less }
+{
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>::BTree(const BTree& other)
+	: less{ other.less }
+{
+	// Copying the leaves and then building the levels above them takes O(n) time.
+	std::vector<Node*> leaves;
+	std::vector<Key> lows;
+	for (const Leaf* leaf = other.first_leaf; leaf != nullptr; leaf = leaf->next)
+	{
+		Leaf* copy = new Leaf(*leaf);
+		copy->previous = last_leaf;
+		copy->next = nullptr;
+		(last_leaf ? last_leaf->next : first_leaf) = copy;
+		last_leaf = copy;
+		leaves.push_back(copy);
+		lows.push_back(copy->keys[0]);
+	}
+	_size = other._size;
+	build_levels(std::move(leaves), std::move(lows));
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>::BTree(BTree&& other) noexcept
+	: less{ other.less }
+{
+	*this = std::move(other);
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>::~BTree()
+{
+	clear();
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>& BTree<Key, Value, Compare>::operator=(const BTree& other)
+{
+	if (this != &other)
+		*this = BTree(other);
+	return *this;
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare>& BTree<Key, Value, Compare>::operator=(BTree&& other) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		root = other.root;
+		first_leaf = other.first_leaf;
+		last_leaf = other.last_leaf;
+		_size = other._size;
+		less = other.less;
+		other.root = nullptr;
+		other.first_leaf = nullptr;
+		other.last_leaf = nullptr;
+		other._size = 0;
+	}
+	return *this;
+}
+
+template <class Key, class Value, class Compare>
+template <class InputIt>
+inline BTree<Key, Value, Compare> BTree<Key, Value, Compare>::from_sorted(InputIt first, InputIt last, Compare less)
+{
+	BTree tree(less);
+	std::vector<Node*> leaves;
+	std::vector<Key> lows;
+	for (; first != last; ++first)
+	{
+		const auto& item = *first;
+		const Key* key;
+		if constexpr (is_set)
+			key = &item;
+		else
+			key = &item.first;
+		if (tree.last_leaf != nullptr && !less(tree.last_leaf->keys[tree.last_leaf->count - 1], *key))
+		{
+			tree.build_levels(std::move(leaves), std::move(lows));
+			throw std::invalid_argument("The keys must be sorted and must not repeat.");
+		}
+		if (tree.last_leaf == nullptr || tree.last_leaf->count == node_capacity)
+		{
+			Leaf* leaf = new Leaf;
+			leaf->previous = tree.last_leaf;
+			(tree.last_leaf ? tree.last_leaf->next : tree.first_leaf) = leaf;
+			tree.last_leaf = leaf;
+			leaves.push_back(leaf);
+			lows.push_back(*key);
+		}
+		Leaf* leaf = tree.last_leaf;
+		leaf->keys[leaf->count] = *key;
+		if constexpr (!is_set)
+			leaf->values[leaf->count] = item.second;
+		leaf->count += 1;
+		tree._size += 1;
+	}
+
+	// Even out the last two leaves if the last one has too few keys.
+	Leaf* leaf = tree.last_leaf;
+	if (leaf != nullptr && leaf->previous != nullptr && leaf->count < min_count)
+	{
+		Leaf* previous = leaf->previous;
+		const size_t moved = (previous->count - leaf->count) / 2;
+		move_entries(leaf, 0, leaf, moved, leaf->count);
+		move_entries(previous, previous->count - moved, leaf, 0, moved);
+		previous->count -= moved;
+		leaf->count += moved;
+		lows.back() = leaf->keys[0];
+	}
+	tree.build_levels(std::move(leaves), std::move(lows));
+	return tree;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::insert(const Key& key)
+{
+	static_assert(is_set, "A map's keys need values.");
+	Node* split = nullptr;
+	Key separator{};
+	if (root == nullptr)
+		root = first_leaf = last_leaf = new Leaf;
+	if (!insert_into(root, key, nullptr, split, separator))
+		return false;
+	if (split != nullptr)
+	{
+		Inner* new_root = new Inner;
+		new_root->keys[0] = std::move(separator);
+		new_root->children[0] = root;
+		new_root->children[1] = split;
+		new_root->count = 1;
+		root = new_root;
+	}
+	_size += 1;
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::insert(const Key& key, const mapped_type& value)
+{
+	static_assert(!is_set, "A set's keys have no values.");
+	Node* split = nullptr;
+	Key separator{};
+	if (root == nullptr)
+		root = first_leaf = last_leaf = new Leaf;
+	if (!insert_into(root, key, &value, split, separator))
+		return false;
+	if (split != nullptr)
+	{
+		Inner* new_root = new Inner;
+		new_root->keys[0] = std::move(separator);
+		new_root->children[0] = root;
+		new_root->children[1] = split;
+		new_root->count = 1;
+		root = new_root;
+	}
+	_size += 1;
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::erase(const Key& key)
+{
+	if (root == nullptr || !erase_from(root, key))
+		return false;
+	_size -= 1;
+	// Remove an inner root that is left with one child, or a leaf root that is left empty.
+	if (!root->is_leaf && root->count == 0)
+	{
+		Inner* old_root = static_cast<Inner*>(root);
+		root = old_root->children[0];
+		delete old_root;
+	}
+	else if (root->is_leaf && root->count == 0)
+	{
+		delete static_cast<Leaf*>(root);
+		root = first_leaf = last_leaf = nullptr;
+	}
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::clear() noexcept
+{
+	destroy(root);
+	root = nullptr;
+	first_leaf = nullptr;
+	last_leaf = nullptr;
+	_size = 0;
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::iterator BTree<Key, Value, Compare>::find(const Key& key)
+{
+	auto [leaf, index] = bound(key, false);
+	if (leaf == nullptr || less(key, leaf->keys[index]))
+		return end();
+	return iterator(leaf, index, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::find(const Key& key) const
+{
+	return const_cast<BTree*>(this)->find(key);
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::contains(const Key& key) const
+{
+	return find(key) != end();
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::iterator BTree<Key, Value, Compare>::lower_bound(const Key& key)
+{
+	auto [leaf, index] = bound(key, false);
+	return iterator(leaf, index, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::lower_bound(const Key& key) const
+{
+	return const_cast<BTree*>(this)->lower_bound(key);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::iterator BTree<Key, Value, Compare>::upper_bound(const Key& key)
+{
+	auto [leaf, index] = bound(key, true);
+	return iterator(leaf, index, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::upper_bound(const Key& key) const
+{
+	return const_cast<BTree*>(this)->upper_bound(key);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::mapped_type& BTree<Key, Value, Compare>::at(const Key& key)
+{
+	static_assert(!is_set, "A set's keys have no values.");
+	iterator it = find(key);
+	if (it == end())
+		throw std::out_of_range("The key is not in the map.");
+	return it.value();
+}
+
+template <class Key, class Value, class Compare>
+inline const typename BTree<Key, Value, Compare>::mapped_type& BTree<Key, Value, Compare>::at(const Key& key) const
+{
+	return const_cast<BTree*>(this)->at(key);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::mapped_type& BTree<Key, Value, Compare>::operator[](const Key& key)
+{
+	static_assert(!is_set, "A set's keys have no values.");
+	iterator it = find(key);
+	if (it != end())
+		return it.value();
+	insert(key, mapped_type());
+	return find(key).value();
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline size_t BTree<Key, Value, Compare>::scan(const Key& low, const Key& high, Visit visit) const
+{
+	auto [leaf, index] = bound(low, false);
+	size_t count = 0;
+	for (; leaf != nullptr; leaf = leaf->next, index = 0)
+	{
+		for (; index < leaf->count; index++)
+		{
+			if (!less(leaf->keys[index], high))
+				return count;
+			if constexpr (is_set)
+				visit(leaf->keys[index]);
+			else
+				visit(leaf->keys[index], leaf->values[index]);
+			count += 1;
+		}
+	}
+	return count;
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline void BTree<Key, Value, Compare>::inorder(Visit visit) const
+{
+	for (const Leaf* leaf = first_leaf; leaf != nullptr; leaf = leaf->next)
+	{
+		for (size_t i = 0; i < leaf->count; i++)
+		{
+			if constexpr (is_set)
+				visit(leaf->keys[i]);
+			else
+				visit(leaf->keys[i], leaf->values[i]);
+		}
+	}
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline void BTree<Key, Value, Compare>::preorder(Visit visit) const
+{
+	for (preorder_iterator it = preorder_nodes().begin(); it != preorder_iterator(); ++it)
+		visit(*it, it.depth());
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline void BTree<Key, Value, Compare>::postorder(Visit visit) const
+{
+	for (postorder_iterator it = postorder_nodes().begin(); it != postorder_iterator(); ++it)
+		visit(*it, it.depth());
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline void BTree<Key, Value, Compare>::level_order(Visit visit) const
+{
+	// Each level starts again from the root, but there are few nodes above the leaves, so this
+	// walks about 1 + 2 / node_capacity times as many nodes as a queue of nodes would.
+	for (level_order_iterator it = level_order_nodes().begin(); it != level_order_iterator(); ++it)
+		visit(*it, it.depth());
+}
+
+template <class Key, class Value, class Compare>
+template <class Visit>
+inline void BTree<Key, Value, Compare>::parallel_level_order(Visit visit, ThreadPool& pool) const
+{
+	// Visit the top levels on this thread until one has enough nodes to share out, and then
+	// give the threads whole subtrees below those nodes, one level at a time.
+	std::vector<const Node*> subtrees;
+	if (root != nullptr)
+		subtrees.push_back(root);
+	size_t top_depth = 0;
+	while (!subtrees.empty() && subtrees.size() < 4 * pool.concurrency() && !subtrees[0]->is_leaf)
+	{
+		std::vector<const Node*> children;
+		for (const Node* node : subtrees)
+		{
+			visit(NodeView(node), top_depth);
+			const Inner* inner = static_cast<const Inner*>(node);
+			children.insert(children.end(), inner->children.begin(), inner->children.begin() + inner->count + 1);
+		}
+		subtrees.swap(children);
+		top_depth += 1;
+	}
+	const size_t levels = height() - top_depth;
+	for (size_t level = 0; level < levels; level++)
+	{
+		pool.run(subtrees.size(), [&](size_t i)
+			{
+				for (level_order_iterator it(subtrees[i], level); it != level_order_iterator() && it.depth() == level; ++it)
+					visit(*it, top_depth + level);
+			});
+	}
+}
+
+template <class Key, class Value, class Compare>
+inline auto BTree<Key, Value, Compare>::preorder_nodes() const noexcept -> NodeRange<Order::preorder>
+{
+	return NodeRange<Order::preorder>(root);
+}
+
+template <class Key, class Value, class Compare>
+inline auto BTree<Key, Value, Compare>::postorder_nodes() const noexcept -> NodeRange<Order::postorder>
+{
+	return NodeRange<Order::postorder>(root);
+}
+
+template <class Key, class Value, class Compare>
+inline auto BTree<Key, Value, Compare>::level_order_nodes() const noexcept -> NodeRange<Order::level_order>
+{
+	return NodeRange<Order::level_order>(root);
+}
+
+template <class Key, class Value, class Compare>
+inline size_t BTree<Key, Value, Compare>::height() const noexcept
+{
+	// All the leaves are at the same depth, so the first path down is as long as any.
+	size_t levels = 0;
+	for (const Node* node = root; node != nullptr; levels++)
+		node = node->is_leaf ? nullptr : static_cast<const Inner*>(node)->children[0];
+	return levels;
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::print(std::ostream& stream) const
+{
+	for (level_order_iterator it = level_order_nodes().begin(); it != level_order_iterator(); )
+	{
+		const size_t depth = it.depth();
+		NodeView node = *it;
+		stream << '[';
+		for (size_t i = 0; i < node.key_count(); i++)
+			stream << (i > 0 ? " " : "") << node.key(i);
+		stream << ']';
+		++it;
+		stream << (it != level_order_iterator() && it.depth() == depth ? ' ' : '\n');
+	}
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::write(std::ostream& stream) const
+{
+	static_assert(std::is_trivially_copyable_v<Key>, "write requires a trivially copyable key type.");
+	static_assert(is_set || std::is_trivially_copyable_v<mapped_type>, "write requires a trivially copyable value type.");
+	const std::uint64_t header[] = { node_capacity, _size };
+	stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	// Each node is written as its key count times two, plus one for a leaf, followed by its
+	// keys and then a map leaf's values.
+	for (NodeView node : preorder_nodes())
+	{
+		const std::uint64_t count = node.key_count() * 2 + node.is_leaf();
+		stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		stream.write(reinterpret_cast<const char*>(&node.key(0)), std::streamsize(node.key_count() * sizeof(Key)));
+		if constexpr (!is_set)
+			if (node.is_leaf())
+				stream.write(reinterpret_cast<const char*>(&node.value(0)), std::streamsize(node.key_count() * sizeof(mapped_type)));
+	}
+}
+
+template <class Key, class Value, class Compare>
+inline BTree<Key, Value, Compare> BTree<Key, Value, Compare>::read(std::istream& stream, Compare less)
+{
+	static_assert(std::is_trivially_copyable_v<Key>, "read requires a trivially copyable key type.");
+	static_assert(is_set || std::is_trivially_copyable_v<mapped_type>, "read requires a trivially copyable value type.");
+	std::uint64_t header[2];
+	if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+		throw std::runtime_error("The stream ended before the tree's header.");
+	if (header[0] != node_capacity)
+		throw std::runtime_error("The stream does not hold a BTree of this type.");
+	BTree tree(less);
+	if (header[1] == 0)
+		return tree;
+
+	// Rebuild the nodes in preorder, keeping the path of inner nodes whose children are still
+	// being read and how many children each has so far.
+	std::array<std::pair<Inner*, size_t>, max_height> path;
+	size_t depth = 0;
+	size_t leaf_depth = max_height;
+	do
+	{
+		std::uint64_t count;
+		if (!stream.read(reinterpret_cast<char*>(&count), sizeof(count)))
+			throw std::runtime_error("The stream ended before the tree's nodes.");
+		const bool is_leaf = count % 2 != 0;
+		count /= 2;
+		if (count == 0 || count > node_capacity || depth == max_height - 1
+			|| (is_leaf ? leaf_depth != max_height && leaf_depth != depth : depth >= leaf_depth))
+			throw std::runtime_error("The stream does not hold a BTree of this type.");
+
+		Node* node;
+		Key* keys;
+		if (is_leaf)
+		{
+			Leaf* leaf = new Leaf;
+			leaf->previous = tree.last_leaf;
+			(tree.last_leaf ? tree.last_leaf->next : tree.first_leaf) = leaf;
+			tree.last_leaf = leaf;
+			node = leaf;
+			keys = leaf->keys.data();
+		}
+		else
+		{
+			Inner* inner = new Inner;
+			node = inner;
+			keys = inner->keys.data();
+		}
+		if (depth == 0)
+			tree.root = node;
+		else
+			path[depth - 1].first->children[path[depth - 1].second++] = node;
+		node->count = size_t(count);
+
+		if (!stream.read(reinterpret_cast<char*>(keys), std::streamsize(count * sizeof(Key))))
+			throw std::runtime_error("The stream ended before the tree's nodes.");
+		if (is_leaf)
+		{
+			if constexpr (!is_set)
+				if (!stream.read(reinterpret_cast<char*>(tree.last_leaf->values.data()), std::streamsize(count * sizeof(mapped_type))))
+					throw std::runtime_error("The stream ended before the tree's nodes.");
+			tree._size += size_t(count);
+			leaf_depth = depth;
+			// Go back up past the inner nodes whose children have all been read.
+			while (depth > 0 && path[depth - 1].second == path[depth - 1].first->count + 1)
+				depth -= 1;
+		}
+		else
+		{
+			path[depth] = { static_cast<Inner*>(node), 0 };
+			depth += 1;
+		}
+	} while (depth > 0);
+	if (tree._size != header[1])
+		throw std::runtime_error("The stream does not hold a BTree of this type.");
+	return tree;
+}
+
+template <class Key, class Value, class Compare>
+inline size_t BTree<Key, Value, Compare>::size() const noexcept
+{
+	return _size;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::operator==(const BTree& other) const
+{
+	if (_size != other._size)
+		return false;
+	for (auto a = begin(), b = other.begin(); a != end(); ++a, ++b)
+	{
+		if (less(a.key(), b.key()) || less(b.key(), a.key()))
+			return false;
+		if constexpr (!is_set)
+			if (!(a.value() == b.value()))
+				return false;
+	}
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::operator!=(const BTree& other) const
+{
+	return !(*this == other);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::iterator BTree<Key, Value, Compare>::begin() noexcept
+{
+	return iterator(first_leaf, 0, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::begin() const noexcept
+{
+	return const_iterator(first_leaf, 0, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::iterator BTree<Key, Value, Compare>::end() noexcept
+{
+	return iterator(nullptr, 0, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::end() const noexcept
+{
+	return const_iterator(nullptr, 0, this);
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::const_iterator BTree<Key, Value, Compare>::cend() const noexcept
+{
+	return end();
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::destroy(Node* node) noexcept
+{
+	if (node == nullptr)
+		return;
+	if (node->is_leaf)
+	{
+		delete static_cast<Leaf*>(node);
+		return;
+	}
+	Inner* inner = static_cast<Inner*>(node);
+	for (size_t i = 0; i <= inner->count; i++)
+		destroy(inner->children[i]);
+	delete inner;
+}
+
+template <class Key, class Value, class Compare>
+inline typename BTree<Key, Value, Compare>::Leaf* BTree<Key, Value, Compare>::find_leaf(const Key& key) const
+{
+	Node* node = root;
+	while (!node->is_leaf)
+	{
+		const Inner* inner = static_cast<const Inner*>(node);
+		const size_t i = size_t(std::upper_bound(inner->keys.begin(), inner->keys.begin() + inner->count, key, less) - inner->keys.begin());
+		node = inner->children[i];
+	}
+	return static_cast<Leaf*>(node);
+}
+
+template <class Key, class Value, class Compare>
+inline size_t BTree<Key, Value, Compare>::leaf_lower_bound(const Leaf* leaf, const Key& key) const
+{
+	return size_t(std::lower_bound(leaf->keys.begin(), leaf->keys.begin() + leaf->count, key, less) - leaf->keys.begin());
+}
+
+template <class Key, class Value, class Compare>
+inline std::pair<typename BTree<Key, Value, Compare>::Leaf*, size_t> BTree<Key, Value, Compare>::bound(const Key& key, bool after_equal) const
+{
+	if (root == nullptr)
+		return { nullptr, 0 };
+	Leaf* leaf = find_leaf(key);
+	size_t index = after_equal
+		? size_t(std::upper_bound(leaf->keys.begin(), leaf->keys.begin() + leaf->count, key, less) - leaf->keys.begin())
+		: leaf_lower_bound(leaf, key);
+	if (index == leaf->count)
+	{
+		leaf = leaf->next;
+		index = 0;
+	}
+	return { leaf, index };
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::insert_into(Node* node, const Key& key, const mapped_type* value, Node*& split, Key& separator)
+{
+	if (node->is_leaf)
+	{
+		Leaf* leaf = static_cast<Leaf*>(node);
+		const size_t index = leaf_lower_bound(leaf, key);
+		if (index < leaf->count && !less(key, leaf->keys[index]))
+			return false;
+		move_entries(leaf, index, leaf, index + 1, leaf->count - index);
+		leaf->keys[index] = key;
+		if constexpr (!is_set)
+			leaf->values[index] = *value;
+		leaf->count += 1;
+		if (leaf->count <= node_capacity)
+			return true;
+
+		// Split the leaf in half.
+		Leaf* right = new Leaf;
+		const size_t left_count = leaf->count / 2;
+		move_entries(leaf, left_count, right, 0, leaf->count - left_count);
+		right->count = leaf->count - left_count;
+		leaf->count = left_count;
+		right->previous = leaf;
+		right->next = leaf->next;
+		(leaf->next ? leaf->next->previous : last_leaf) = right;
+		leaf->next = right;
+		split = right;
+		separator = right->keys[0];
+		return true;
+	}
+
+	Inner* inner = static_cast<Inner*>(node);
+	const size_t i = size_t(std::upper_bound(inner->keys.begin(), inner->keys.begin() + inner->count, key, less) - inner->keys.begin());
+	Node* child_split = nullptr;
+	Key child_separator{};
+	if (!insert_into(inner->children[i], key, value, child_split, child_separator))
+		return false;
+	if (child_split == nullptr)
+		return true;
+
+	std::move_backward(inner->keys.begin() + i, inner->keys.begin() + inner->count, inner->keys.begin() + inner->count + 1);
+	std::move_backward(inner->children.begin() + i + 1, inner->children.begin() + inner->count + 1, inner->children.begin() + inner->count + 2);
+	inner->keys[i] = std::move(child_separator);
+	inner->children[i + 1] = child_split;
+	inner->count += 1;
+	if (inner->count <= node_capacity)
+		return true;
+
+	// Split the inner node around its middle key, which moves up to the parent.
+	Inner* right = new Inner;
+	const size_t middle = inner->count / 2;
+	right->count = inner->count - middle - 1;
+	std::move(inner->keys.begin() + middle + 1, inner->keys.begin() + inner->count, right->keys.begin());
+	std::copy(inner->children.begin() + middle + 1, inner->children.begin() + inner->count + 1, right->children.begin());
+	separator = std::move(inner->keys[middle]);
+	inner->count = middle;
+	split = right;
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline bool BTree<Key, Value, Compare>::erase_from(Node* node, const Key& key)
+{
+	if (node->is_leaf)
+	{
+		Leaf* leaf = static_cast<Leaf*>(node);
+		const size_t index = leaf_lower_bound(leaf, key);
+		if (index == leaf->count || less(key, leaf->keys[index]))
+			return false;
+		move_entries(leaf, index + 1, leaf, index, leaf->count - index - 1);
+		leaf->count -= 1;
+		return true;
+	}
+
+	// The separators above an erased key can stay, since they still separate the children.
+	Inner* inner = static_cast<Inner*>(node);
+	const size_t i = size_t(std::upper_bound(inner->keys.begin(), inner->keys.begin() + inner->count, key, less) - inner->keys.begin());
+	if (!erase_from(inner->children[i], key))
+		return false;
+	if (inner->children[i]->count < min_count)
+		rebalance(inner, i);
+	return true;
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::rebalance(Inner* parent, size_t i)
+{
+	Node* const child = parent->children[i];
+	Node* const left = i > 0 ? parent->children[i - 1] : nullptr;
+	Node* const right = i < parent->count ? parent->children[i + 1] : nullptr;
+
+	if (left != nullptr && left->count > min_count)
+	{
+		// Take the left sibling's last key.
+		if (child->is_leaf)
+		{
+			Leaf* to = static_cast<Leaf*>(child);
+			Leaf* from = static_cast<Leaf*>(left);
+			move_entries(to, 0, to, 1, to->count);
+			move_entries(from, from->count - 1, to, 0, 1);
+			parent->keys[i - 1] = to->keys[0];
+		}
+		else
+		{
+			Inner* to = static_cast<Inner*>(child);
+			Inner* from = static_cast<Inner*>(left);
+			std::move_backward(to->keys.begin(), to->keys.begin() + to->count, to->keys.begin() + to->count + 1);
+			std::move_backward(to->children.begin(), to->children.begin() + to->count + 1, to->children.begin() + to->count + 2);
+			to->keys[0] = std::move(parent->keys[i - 1]);
+			to->children[0] = from->children[from->count];
+			parent->keys[i - 1] = std::move(from->keys[from->count - 1]);
+		}
+		left->count -= 1;
+		child->count += 1;
+	}
+	else if (right != nullptr && right->count > min_count)
+	{
+		// Take the right sibling's first key.
+		if (child->is_leaf)
+		{
+			Leaf* to = static_cast<Leaf*>(child);
+			Leaf* from = static_cast<Leaf*>(right);
+			move_entries(from, 0, to, to->count, 1);
+			move_entries(from, 1, from, 0, from->count - 1);
+			parent->keys[i] = from->keys[0];
+		}
+		else
+		{
+			Inner* to = static_cast<Inner*>(child);
+			Inner* from = static_cast<Inner*>(right);
+			to->keys[to->count] = std::move(parent->keys[i]);
+			to->children[to->count + 1] = from->children[0];
+			parent->keys[i] = std::move(from->keys[0]);
+			std::move(from->keys.begin() + 1, from->keys.begin() + from->count, from->keys.begin());
+			std::copy(from->children.begin() + 1, from->children.begin() + from->count + 1, from->children.begin());
+		}
+		right->count -= 1;
+		child->count += 1;
+	}
+	else
+	{
+		// Merge the child with a sibling, which both have too few keys to share.
+		const size_t j = left != nullptr ? i - 1 : i;
+		Node* const merged = parent->children[j];
+		Node* const removed = parent->children[j + 1];
+		if (merged->is_leaf)
+		{
+			Leaf* to = static_cast<Leaf*>(merged);
+			Leaf* from = static_cast<Leaf*>(removed);
+			move_entries(from, 0, to, to->count, from->count);
+			to->count += from->count;
+			to->next = from->next;
+			(from->next ? from->next->previous : last_leaf) = to;
+			delete from;
+		}
+		else
+		{
+			Inner* to = static_cast<Inner*>(merged);
+			Inner* from = static_cast<Inner*>(removed);
+			to->keys[to->count] = std::move(parent->keys[j]);
+			std::move(from->keys.begin(), from->keys.begin() + from->count, to->keys.begin() + to->count + 1);
+			std::copy(from->children.begin(), from->children.begin() + from->count + 1, to->children.begin() + to->count + 1);
+			to->count += from->count + 1;
+			delete from;
+		}
+		std::move(parent->keys.begin() + j + 1, parent->keys.begin() + parent->count, parent->keys.begin() + j);
+		std::copy(parent->children.begin() + j + 2, parent->children.begin() + parent->count + 1, parent->children.begin() + j + 1);
+		parent->count -= 1;
+	}
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::move_entries(Leaf* from, size_t from_index, Leaf* to, size_t to_index, size_t count)
+{
+	// Moving within one leaf to a later position must start from the end.
+	if (from == to && to_index > from_index)
+	{
+		std::move_backward(from->keys.begin() + from_index, from->keys.begin() + from_index + count, to->keys.begin() + to_index + count);
+		if constexpr (!is_set)
+			std::move_backward(from->values.begin() + from_index, from->values.begin() + from_index + count, to->values.begin() + to_index + count);
+	}
+	else
+	{
+		std::move(from->keys.begin() + from_index, from->keys.begin() + from_index + count, to->keys.begin() + to_index);
+		if constexpr (!is_set)
+			std::move(from->values.begin() + from_index, from->values.begin() + from_index + count, to->values.begin() + to_index);
+	}
+}
+
+template <class Key, class Value, class Compare>
+inline void BTree<Key, Value, Compare>::build_levels(std::vector<Node*> nodes, std::vector<Key> lows)
+{
+	// Group each level's nodes evenly under as few parents as can hold them, which gives every
+	// parent at least min_count keys, until one node is left.
+	while (nodes.size() > 1)
+	{
+		const size_t parent_count = (nodes.size() + node_capacity) / (node_capacity + 1);
+		std::vector<Node*> parents;
+		std::vector<Key> parent_lows;
+		for (size_t p = 0; p < parent_count; p++)
+		{
+			const size_t first = nodes.size() * p / parent_count;
+			const size_t last = nodes.size() * (p + 1) / parent_count;
+			Inner* parent = new Inner;
+			for (size_t n = first; n < last; n++)
+			{
+				parent->children[n - first] = nodes[n];
+				if (n > first)
+					parent->keys[n - first - 1] = lows[n];
+			}
+			parent->count = last - first - 1;
+			parents.push_back(parent);
+			parent_lows.push_back(std::move(lows[first]));
+		}
+		nodes.swap(parents);
+		lows.swap(parent_lows);
+	}
+	root = nodes.empty() ? nullptr : nodes[0];
+}
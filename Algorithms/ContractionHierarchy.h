@@ -0,0 +1,629 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "dijkstra.h"
+#include "PriorityQueues.h"
+
+namespace Dijkstra
+{
+	// A contraction hierarchy of a graph, for answering shortest path queries on large road-like
+	// graphs far faster than Dijkstra's algorithm can.
+	// Preprocessing ranks the vertexes by importance and contracts them from least to most important.
+	// Contracting a vertex removes it and adds a shortcut edge between each pair of its neighbors
+	// whose shortest path went through it. A query then searches only upward in rank from both
+	// ends, which settles a few hundred vertexes even on graphs with millions, and unpacks the
+	// shortcuts of the path it finds back into the original edges.
+	template <class Name, class Cost>
+	class ContractionHierarchy
+	{
+	public:
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+
+		// Scratch space for queries. Reusing one for many queries avoids allocating and clearing
+		// arrays the size of the graph each time. Each thread needs its own.
+		class Workspace;
+
+		ContractionHierarchy() {}
+
+		// Preprocesses a graph. The graph's edges must have nonnegative costs.
+		explicit ContractionHierarchy(const CsrGraph<Name, Cost>& graph);
+
+		// Finds the shortest path between two vertexes.
+		// Returns the shortest path's vertex names and total cost.
+		// Throws std::invalid_argument if there is no valid path or a vertex is not in the graph.
+		Path<Name, Cost> query(const Name& start, const Name& end) const;
+		Path<Name, Cost> query(Workspace& workspace, const Name& start, const Name& end) const;
+
+		// Finds the shortest path between two vertexes given by their IDs in the original graph.
+		// Returns the shortest path's vertex IDs and total cost.
+		// Throws std::invalid_argument if there is no valid path or a vertex is not in the graph.
+		Path<VertexId, Cost> query_ids(VertexId start, VertexId end) const;
+		Path<VertexId, Cost> query_ids(Workspace& workspace, VertexId start, VertexId end) const;
+
+		VertexId vertex_count() const noexcept;
+
+		// Returns the number of shortcut edges preprocessing added.
+		size_t shortcut_count() const noexcept;
+
+		// Returns the position of a vertex in the contraction order, where 0 is the least important.
+		VertexId rank(VertexId vertex) const;
+
+		// Writes the hierarchy to a binary stream with one bulk write per array.
+		// Requires trivially copyable Name and Cost types. The format is only meant to be read
+		// back on the same platform.
+		void write(std::ostream& stream) const;
+
+		// Reads a hierarchy written by write. Throws std::runtime_error if the stream ends early,
+		// does not hold a hierarchy, or holds ranks, arcs, or shortcuts that are out of bounds or
+		// out of rank order.
+		static ContractionHierarchy read(std::istream& stream);
+
+	private:
+		static constexpr std::uint64_t file_magic = 0x31304843;  // "CH01"
+		static constexpr VertexId npos = std::numeric_limits<VertexId>::max();
+		static constexpr Cost unreached = std::numeric_limits<Cost>::max();
+
+		// An edge of the hierarchy. For a shortcut, middle is the contracted vertex it skips.
+		struct Arc
+		{
+			VertexId vertex;
+			Cost cost;
+			VertexId middle;
+		};
+
+		std::vector<Name> names;
+		std::vector<VertexId> ranks;
+		// The edges from each vertex to higher ranked vertexes.
+		std::vector<std::uint64_t> up_offsets{ 0 };
+		std::vector<Arc> up_arcs;
+		// The edges into each vertex from higher ranked vertexes, each given by its source.
+		std::vector<std::uint64_t> down_offsets{ 0 };
+		std::vector<Arc> down_arcs;
+		size_t shortcuts = 0;
+
+		class Contractor;
+
+		// Returns the cost of the edge from a vertex to a higher ranked one, and the vertex it skips.
+		const Arc& find_up_arc(VertexId from, VertexId to) const;
+
+		// Returns the cost of the edge to a vertex from a higher ranked one, and the vertex it skips.
+		const Arc& find_down_arc(VertexId to, VertexId from) const;
+
+		// Appends the original vertexes of the edge from a to b, not including a.
+		void unpack(VertexId a, VertexId b, VertexId middle, std::vector<VertexId>& path) const;
+	};
+
+	template <class Name, class Cost>
+	class ContractionHierarchy<Name, Cost>::Workspace
+	{
+	public:
+		Workspace() {}
+		explicit Workspace(VertexId vertex_count)
+		{
+			for (int side = 0; side < 2; side++)
+			{
+				costs[side].assign(vertex_count, unreached);
+				parents[side].assign(vertex_count, npos);
+			}
+		}
+
+	private:
+		friend class ContractionHierarchy;
+		// Index 0 is the upward search from the start and index 1 is the upward search from the end.
+		std::vector<Cost> costs[2];
+		std::vector<VertexId> parents[2];
+		std::vector<VertexId> touched[2];  // The vertexes whose costs must be reset after a query.
+		LazyBinaryHeap<Cost> queues[2];
+
+		// Resets the costs a query touched and empties the queues, ready for the next query.
+		void reset()
+		{
+			for (int side = 0; side < 2; side++)
+			{
+				for (VertexId v : touched[side])
+					costs[side][v] = unreached;
+				touched[side].clear();
+				queues[side].clear();
+			}
+		}
+	};
+
+	// The state of the graph during preprocessing, as adjacency lists that shrink and gain
+	// shortcuts as vertexes are contracted.
+	template <class Name, class Cost>
+	class ContractionHierarchy<Name, Cost>::Contractor
+	{
+	public:
+		explicit Contractor(const CsrGraph<Name, Cost>& graph)
+			: out(graph.vertex_count()), in(graph.vertex_count()), contracted_neighbors(graph.vertex_count()), is_target(graph.vertex_count()), witness_costs(graph.vertex_count(), unreached)
+		{
+			for (VertexId source = 0; source < graph.vertex_count(); source++)
+				for (auto e = graph.first_edge(source); e < graph.last_edge(source); e++)
+					if (graph.target(e) != source)
+						add_edge(source, graph.target(e), graph.weight(e), npos);
+		}
+
+		// Returns the vertex's priority for contraction, where lower is sooner: the number of
+		// shortcuts contracting it would add, less the edges it would remove, plus the number of
+		// its neighbors already contracted, which spreads contraction evenly across the graph.
+		long long priority(VertexId vertex)
+		{
+			const long long shortcut_count = contract(vertex, false);
+			return shortcut_count - (long long)(out[vertex].size() + in[vertex].size()) + contracted_neighbors[vertex];
+		}
+
+		// Removes a vertex from the graph, adding the shortcuts its neighbors need.
+		// Returns the number of shortcuts added.
+		size_t contract(VertexId vertex)
+		{
+			const size_t shortcut_count = contract(vertex, true);
+			for (const Arc& arc : out[vertex])
+			{
+				remove_edge(in[arc.vertex], vertex);
+				contracted_neighbors[arc.vertex] += 1;
+			}
+			for (const Arc& arc : in[vertex])
+			{
+				remove_edge(out[arc.vertex], vertex);
+				contracted_neighbors[arc.vertex] += 1;
+			}
+			return shortcut_count;
+		}
+
+		// The edges leaving and entering each vertex that has not been contracted.
+		// A contracted vertex keeps the edges it had when it was contracted.
+		std::vector<std::vector<Arc>> out;
+		std::vector<std::vector<Arc>> in;
+
+	private:
+		// Witness searches give up after settling this many vertexes and assume there is no
+		// witness, which can only add unneeded shortcuts. Estimating priorities only needs
+		// rough shortcut counts, so those searches give up much sooner.
+		static constexpr size_t witness_settle_limit = 500;
+		static constexpr size_t estimate_settle_limit = 10;
+
+		std::vector<long long> contracted_neighbors;
+		std::vector<char> is_target;  // Whether each vertex is an out-neighbor of the vertex being contracted.
+		std::vector<Cost> witness_costs;
+		std::vector<VertexId> witness_touched;
+		LazyBinaryHeap<Cost> witness_queue;
+
+		// Finds the shortcuts needed to contract a vertex and adds them if add is true.
+		// Returns the number of shortcuts needed.
+		size_t contract(VertexId vertex, bool add)
+		{
+			size_t shortcut_count = 0;
+			Cost max_out_cost = 0;
+			for (const Arc& arc : out[vertex])
+			{
+				max_out_cost = std::max(max_out_cost, arc.cost);
+				is_target[arc.vertex] = true;
+			}
+			for (const Arc& in_arc : in[vertex])
+			{
+				// One search from each in-neighbor finds the witnesses for all of the out-neighbors:
+				// paths that avoid the vertex and are no more expensive than going through it.
+				witness_search(in_arc.vertex, vertex, in_arc.cost + max_out_cost, out[vertex].size(),
+					add ? witness_settle_limit : estimate_settle_limit);
+				for (const Arc& out_arc : out[vertex])
+				{
+					if (out_arc.vertex == in_arc.vertex)
+						continue;
+					const Cost shortcut_cost = in_arc.cost + out_arc.cost;
+					if (witness_costs[out_arc.vertex] <= shortcut_cost)
+						continue;
+					shortcut_count += 1;
+					if (add)
+						add_edge(in_arc.vertex, out_arc.vertex, shortcut_cost, vertex);
+				}
+				for (VertexId v : witness_touched)
+					witness_costs[v] = unreached;
+				witness_touched.clear();
+			}
+			for (const Arc& arc : out[vertex])
+				is_target[arc.vertex] = false;
+			return shortcut_count;
+		}
+
+		// Finds the costs of paths from the source that avoid a vertex, stopping once every target
+		// is settled or the costs exceed max_cost.
+		void witness_search(VertexId source, VertexId avoid, Cost max_cost, size_t target_count, size_t settle_limit)
+		{
+			witness_costs[source] = 0;
+			witness_touched.push_back(source);
+			witness_queue.clear();
+			witness_queue.push(source, 0);
+			size_t settled = 0;
+			while (!witness_queue.empty() && settled < settle_limit && target_count > 0)
+			{
+				const auto [cost, vertex] = witness_queue.pop();
+				if (cost > witness_costs[vertex])
+					continue;
+				if (cost > max_cost)
+					break;
+				settled += 1;
+				if (is_target[vertex])
+					target_count -= 1;
+				for (const Arc& arc : out[vertex])
+				{
+					if (arc.vertex == avoid)
+						continue;
+					const Cost neighbor_cost = cost + arc.cost;
+					if (neighbor_cost < witness_costs[arc.vertex])
+					{
+						if (witness_costs[arc.vertex] == unreached)
+							witness_touched.push_back(arc.vertex);
+						witness_costs[arc.vertex] = neighbor_cost;
+						witness_queue.push(arc.vertex, neighbor_cost);
+					}
+				}
+			}
+		}
+
+		// Adds an edge, or lowers the cost of an existing edge between the same vertexes.
+		void add_edge(VertexId source, VertexId target, Cost cost, VertexId middle)
+		{
+			if (set_edge(out[source], target, cost, middle))
+				set_edge(in[target], source, cost, middle);
+		}
+
+		// Returns whether the arc was added or lowered.
+		static bool set_edge(std::vector<Arc>& arcs, VertexId vertex, Cost cost, VertexId middle)
+		{
+			for (Arc& arc : arcs)
+				if (arc.vertex == vertex)
+				{
+					if (cost >= arc.cost)
+						return false;
+					arc.cost = cost;
+					arc.middle = middle;
+					return true;
+				}
+			arcs.push_back({ vertex, cost, middle });
+			return true;
+		}
+
+		static void remove_edge(std::vector<Arc>& arcs, VertexId vertex)
+		{
+			for (size_t i = 0; i < arcs.size(); i++)
+				if (arcs[i].vertex == vertex)
+				{
+					arcs[i] = arcs.back();
+					arcs.pop_back();
+					return;
+				}
+		}
+	};
+
+	//////////////////////////////////////
+	// ContractionHierarchy<Name, Cost> //
+	//////////////////////////////////////
+
+	template <class Name, class Cost>
+	inline ContractionHierarchy<Name, Cost>::ContractionHierarchy(const CsrGraph<Name, Cost>& graph)
+		: names(graph.names().begin(), graph.names().end()), ranks(graph.vertex_count(), npos)
+	{
+		const VertexId n = graph.vertex_count();
+		Contractor contractor(graph);
+		std::vector<long long> priorities(n);
+		using Entry = std::pair<long long, VertexId>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> order;
+		for (VertexId v = 0; v < n; v++)
+		{
+			priorities[v] = contractor.priority(v);
+			order.push({ priorities[v], v });
+		}
+		VertexId next_rank = 0;
+		while (!order.empty())
+		{
+			const auto [priority, vertex] = order.top();
+			order.pop();
+			if (ranks[vertex] != npos || priority != priorities[vertex])
+				continue;  // The entry is stale.
+			// Priorities change as the graph does, so check that this one is still the lowest.
+			priorities[vertex] = contractor.priority(vertex);
+			if (!order.empty() && priorities[vertex] > order.top().first)
+			{
+				order.push({ priorities[vertex], vertex });
+				continue;
+			}
+			shortcuts += contractor.contract(vertex);
+			ranks[vertex] = next_rank++;
+			// The vertex's remaining edges all lead to higher ranked vertexes.
+			for (const Arc& arc : contractor.out[vertex])
+				up_arcs.push_back(arc);
+			for (const Arc& arc : contractor.in[vertex])
+				down_arcs.push_back(arc);
+			up_offsets.push_back(up_arcs.size());
+			down_offsets.push_back(down_arcs.size());
+			for (const std::vector<Arc>* arcs : { &contractor.out[vertex], &contractor.in[vertex] })
+				for (const Arc& arc : *arcs)
+					if (ranks[arc.vertex] == npos)
+					{
+						priorities[arc.vertex] = contractor.priority(arc.vertex);
+						order.push({ priorities[arc.vertex], arc.vertex });
+					}
+		}
+
+		// The arcs were added in rank order, so put them in vertex ID order for lookups by ID.
+		std::vector<VertexId> by_rank(n);
+		for (VertexId v = 0; v < n; v++)
+			by_rank[ranks[v]] = v;
+		for (auto [offsets, arcs] : { std::make_pair(&up_offsets, &up_arcs), std::make_pair(&down_offsets, &down_arcs) })
+		{
+			std::vector<std::uint64_t> id_offsets(size_t(n) + 1, 0);
+			std::vector<Arc> id_arcs;
+			id_arcs.reserve(arcs->size());
+			for (VertexId v = 0; v < n; v++)
+			{
+				const VertexId r = ranks[v];
+				id_arcs.insert(id_arcs.end(), arcs->begin() + (*offsets)[r], arcs->begin() + (*offsets)[r + size_t(1)]);
+				id_offsets[v + size_t(1)] = id_arcs.size();
+			}
+			*offsets = std::move(id_offsets);
+			*arcs = std::move(id_arcs);
+		}
+	}
+
+	template <class Name, class Cost>
+	inline Path<Name, Cost> ContractionHierarchy<Name, Cost>::query(const Name& start, const Name& end) const
+	{
+		Workspace workspace(vertex_count());
+		return query(workspace, start, end);
+	}
+
+	template <class Name, class Cost>
+	inline Path<Name, Cost> ContractionHierarchy<Name, Cost>::query(Workspace& workspace, const Name& start, const Name& end) const
+	{
+		auto start_it = std::lower_bound(names.begin(), names.end(), start);
+		auto end_it = std::lower_bound(names.begin(), names.end(), end);
+		if (start_it == names.end() || *start_it != start || end_it == names.end() || *end_it != end)
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		Path<VertexId, Cost> id_path = query_ids(workspace, VertexId(start_it - names.begin()), VertexId(end_it - names.begin()));
+		std::vector<Name> path;
+		path.reserve(id_path.path.size());
+		for (VertexId vertex : id_path.path)
+			path.push_back(names[vertex]);
+		return Path<Name, Cost>(path, id_path.cost);
+	}
+
+	template <class Name, class Cost>
+	inline Path<typename ContractionHierarchy<Name, Cost>::VertexId, Cost> ContractionHierarchy<Name, Cost>::query_ids(VertexId start, VertexId end) const
+	{
+		Workspace workspace(vertex_count());
+		return query_ids(workspace, start, end);
+	}
+
+	template <class Name, class Cost>
+	inline Path<typename ContractionHierarchy<Name, Cost>::VertexId, Cost> ContractionHierarchy<Name, Cost>::query_ids(
+		Workspace& workspace, VertexId start, VertexId end) const
+	{
+		if (start >= vertex_count() || end >= vertex_count())
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		if (workspace.costs[0].size() != vertex_count())
+			workspace = Workspace(vertex_count());
+		// Reset the workspace however the query ends, including when unpacking throws, so that a
+		// failed query cannot leave costs behind for later ones.
+		struct Reset
+		{
+			Workspace& workspace;
+			~Reset() { workspace.reset(); }
+		} reset{ workspace };
+		const std::vector<std::uint64_t>* offsets[2] = { &up_offsets, &down_offsets };
+		const std::vector<Arc>* arcs[2] = { &up_arcs, &down_arcs };
+		const VertexId sources[2] = { start, end };
+		for (int side = 0; side < 2; side++)
+		{
+			workspace.costs[side][sources[side]] = 0;
+			workspace.touched[side].push_back(sources[side]);
+			workspace.queues[side].push(sources[side], 0);
+		}
+
+		// Each search only goes up, so neither can stop when they meet. Each continues until its
+		// next cost is at least the best path found, since no later meeting could be cheaper.
+		Cost best = unreached;
+		VertexId meeting = npos;
+		while (!workspace.queues[0].empty() || !workspace.queues[1].empty())
+		{
+			for (int side = 0; side < 2; side++)
+			{
+				LazyBinaryHeap<Cost>& queue = workspace.queues[side];
+				if (queue.empty())
+					continue;
+				const auto [cost, vertex] = queue.pop();
+				std::vector<Cost>& costs = workspace.costs[side];
+				if (cost > costs[vertex])
+					continue;
+				if (cost >= best)
+				{
+					queue.clear();
+					continue;
+				}
+				const Cost other_cost = workspace.costs[1 - side][vertex];
+				if (other_cost != unreached && cost + other_cost < best)
+				{
+					best = cost + other_cost;
+					meeting = vertex;
+				}
+				for (auto a = (*offsets[side])[vertex]; a < (*offsets[side])[vertex + size_t(1)]; a++)
+				{
+					const Arc& arc = (*arcs[side])[a];
+					const Cost neighbor_cost = cost + arc.cost;
+					if (neighbor_cost < costs[arc.vertex])
+					{
+						if (costs[arc.vertex] == unreached)
+							workspace.touched[side].push_back(arc.vertex);
+						costs[arc.vertex] = neighbor_cost;
+						workspace.parents[side][arc.vertex] = vertex;
+						queue.push(arc.vertex, neighbor_cost);
+					}
+				}
+			}
+		}
+
+		std::vector<VertexId> path;
+		if (meeting != npos)
+		{
+			// Collect the upward path from the start to the meeting vertex, then unpack each edge
+			// of it and of the upward path from the meeting vertex back to the end.
+			std::vector<VertexId> forward;
+			for (VertexId v = meeting; v != start; v = workspace.parents[0][v])
+				forward.push_back(v);
+			path.push_back(start);
+			VertexId previous = start;
+			for (auto it = forward.rbegin(); it != forward.rend(); ++it)
+			{
+				unpack(previous, *it, find_up_arc(previous, *it).middle, path);
+				previous = *it;
+			}
+			for (VertexId v = meeting; v != end; v = workspace.parents[1][v])
+			{
+				const VertexId next = workspace.parents[1][v];
+				unpack(v, next, find_down_arc(next, v).middle, path);
+			}
+		}
+		if (meeting == npos)
+			throw std::invalid_argument("No path found.");
+		return Path<VertexId, Cost>(path, best);
+	}
+
+	template <class Name, class Cost>
+	inline typename ContractionHierarchy<Name, Cost>::VertexId ContractionHierarchy<Name, Cost>::vertex_count() const noexcept
+	{
+		return VertexId(names.size());
+	}
+
+	template <class Name, class Cost>
+	inline size_t ContractionHierarchy<Name, Cost>::shortcut_count() const noexcept
+	{
+		return shortcuts;
+	}
+
+	template <class Name, class Cost>
+	inline typename ContractionHierarchy<Name, Cost>::VertexId ContractionHierarchy<Name, Cost>::rank(VertexId vertex) const
+	{
+		return ranks.at(vertex);
+	}
+
+	template <class Name, class Cost>
+	inline void ContractionHierarchy<Name, Cost>::write(std::ostream& stream) const
+	{
+		static_assert(std::is_trivially_copyable_v<Name> && std::is_trivially_copyable_v<Cost>,
+			"write requires trivially copyable name and cost types.");
+		const std::uint64_t header[] = { file_magic, names.size(), up_arcs.size(), down_arcs.size(), shortcuts };
+		stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(names.data()), std::streamsize(names.size() * sizeof(Name)));
+		stream.write(reinterpret_cast<const char*>(ranks.data()), std::streamsize(ranks.size() * sizeof(VertexId)));
+		stream.write(reinterpret_cast<const char*>(up_offsets.data()), std::streamsize(up_offsets.size() * sizeof(std::uint64_t)));
+		stream.write(reinterpret_cast<const char*>(up_arcs.data()), std::streamsize(up_arcs.size() * sizeof(Arc)));
+		stream.write(reinterpret_cast<const char*>(down_offsets.data()), std::streamsize(down_offsets.size() * sizeof(std::uint64_t)));
+		stream.write(reinterpret_cast<const char*>(down_arcs.data()), std::streamsize(down_arcs.size() * sizeof(Arc)));
+	}
+
+	template <class Name, class Cost>
+	inline ContractionHierarchy<Name, Cost> ContractionHierarchy<Name, Cost>::read(std::istream& stream)
+	{
+		static_assert(std::is_trivially_copyable_v<Name> && std::is_trivially_copyable_v<Cost>,
+			"read requires trivially copyable name and cost types.");
+		std::uint64_t header[5];
+		if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+			throw std::runtime_error("The stream ended before the hierarchy's header.");
+		if (header[0] != file_magic || header[1] > std::numeric_limits<VertexId>::max())
+			throw std::runtime_error("The stream does not hold a ContractionHierarchy.");
+		ContractionHierarchy hierarchy;
+		hierarchy.names.resize(header[1]);
+		hierarchy.ranks.resize(header[1]);
+		hierarchy.up_offsets.resize(header[1] + 1);
+		hierarchy.up_arcs.resize(header[2]);
+		hierarchy.down_offsets.resize(header[1] + 1);
+		hierarchy.down_arcs.resize(header[3]);
+		hierarchy.shortcuts = header[4];
+		if (!stream.read(reinterpret_cast<char*>(hierarchy.names.data()), std::streamsize(hierarchy.names.size() * sizeof(Name)))
+			|| !stream.read(reinterpret_cast<char*>(hierarchy.ranks.data()), std::streamsize(hierarchy.ranks.size() * sizeof(VertexId)))
+			|| !stream.read(reinterpret_cast<char*>(hierarchy.up_offsets.data()), std::streamsize(hierarchy.up_offsets.size() * sizeof(std::uint64_t)))
+			|| !stream.read(reinterpret_cast<char*>(hierarchy.up_arcs.data()), std::streamsize(hierarchy.up_arcs.size() * sizeof(Arc)))
+			|| !stream.read(reinterpret_cast<char*>(hierarchy.down_offsets.data()), std::streamsize(hierarchy.down_offsets.size() * sizeof(std::uint64_t)))
+			|| !stream.read(reinterpret_cast<char*>(hierarchy.down_arcs.data()), std::streamsize(hierarchy.down_arcs.size() * sizeof(Arc))))
+			throw std::runtime_error("The stream ended before the hierarchy's arrays.");
+
+		// Queries index by the ranks and arcs, and unpacking a shortcut recurses into arcs of lower
+		// ranked vertexes, so check that every vertex ID is in bounds, the ranks are a permutation,
+		// the arcs lead upward, and each shortcut skips a vertex ranked below both of its ends.
+		const VertexId n = VertexId(header[1]);
+		std::vector<char> rank_used(n);
+		for (VertexId r : hierarchy.ranks)
+		{
+			if (r >= n || rank_used[r])
+				throw std::runtime_error("The stream holds a ContractionHierarchy with invalid ranks.");
+			rank_used[r] = true;
+		}
+		for (auto [offsets, arcs] : { std::make_pair(&hierarchy.up_offsets, &hierarchy.up_arcs), std::make_pair(&hierarchy.down_offsets, &hierarchy.down_arcs) })
+		{
+			if (offsets->front() != 0 || offsets->back() != arcs->size() || !std::is_sorted(offsets->begin(), offsets->end()))
+				throw std::runtime_error("The stream does not hold a ContractionHierarchy.");
+			for (VertexId v = 0; v < n; v++)
+				for (auto a = (*offsets)[v]; a < (*offsets)[v + size_t(1)]; a++)
+				{
+					const Arc& arc = (*arcs)[a];
+					if (arc.vertex >= n || hierarchy.ranks[arc.vertex] <= hierarchy.ranks[v]
+						|| (arc.middle != npos && (arc.middle >= n || hierarchy.ranks[arc.middle] >= hierarchy.ranks[v])))
+						throw std::runtime_error("The stream holds a ContractionHierarchy with an invalid arc.");
+				}
+		}
+		return hierarchy;
+	}
+
+	template <class Name, class Cost>
+	inline const typename ContractionHierarchy<Name, Cost>::Arc& ContractionHierarchy<Name, Cost>::find_up_arc(VertexId from, VertexId to) const
+	{
+		for (auto a = up_offsets[from]; a < up_offsets[from + size_t(1)]; a++)
+			if (up_arcs[a].vertex == to)
+				return up_arcs[a];
+		throw std::runtime_error("The hierarchy is missing an edge.");
+	}
+
+	template <class Name, class Cost>
+	inline const typename ContractionHierarchy<Name, Cost>::Arc& ContractionHierarchy<Name, Cost>::find_down_arc(VertexId to, VertexId from) const
+	{
+		for (auto a = down_offsets[to]; a < down_offsets[to + size_t(1)]; a++)
+			if (down_arcs[a].vertex == from)
+				return down_arcs[a];
+		throw std::runtime_error("The hierarchy is missing an edge.");
+	}
+
+	template <class Name, class Cost>
+	inline void ContractionHierarchy<Name, Cost>::unpack(VertexId a, VertexId b, VertexId middle, std::vector<VertexId>& path) const
+	{
+		// A shortcut from a to b skipping m replaced the edges from a to m and from m to b. m was
+		// contracted before both, so those edges are the down arc into m and the up arc out of m.
+		struct Edge
+		{
+			VertexId from;
+			VertexId to;
+			VertexId middle;
+		};
+		std::vector<Edge> stack{ { a, b, middle } };
+		while (stack.size())
+		{
+			const Edge edge = stack.back();
+			stack.pop_back();
+			if (edge.middle == npos)
+			{
+				path.push_back(edge.to);
+				continue;
+			}
+			const VertexId m = edge.middle;
+			stack.push_back({ m, edge.to, find_up_arc(m, edge.to).middle });
+			stack.push_back({ edge.from, m, find_down_arc(m, edge.from).middle });
+		}
+	}
+}
@@ -0,0 +1,800 @@
+#pragma once
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// A linked list whose nodes also point to the nodes before them, so that it can be
+// traversed in both directions and indexed from whichever end or known position is closest.
+template <class T>
+class DoublyLinkedList
+{
+	class Node;
+	template <bool is_const>
+	class basic_iterator;
+
+public:
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	DoublyLinkedList() noexcept {};
+	DoublyLinkedList(std::initializer_list<T> data_list);
+	DoublyLinkedList(const DoublyLinkedList<T>& other);
+	DoublyLinkedList(DoublyLinkedList<T>&& other) noexcept;
+	~DoublyLinkedList();
+	DoublyLinkedList<T>& operator=(std::initializer_list<T> data_list);
+	DoublyLinkedList<T>& operator=(const DoublyLinkedList<T>& other);
+	DoublyLinkedList<T>& operator=(DoublyLinkedList<T>&& other) noexcept;
+
+	// Adds a node with the given value to the end of the list in O(1) time.
+	void append(T data);
+
+	// Adds a node with the given value to the start of the list in O(1) time.
+	void prepend(T data);
+
+	// Combines two lists, adding each value in the given list to the end of this list.
+	void extend(const DoublyLinkedList<T>& other);
+
+	// Combines two lists, adding each value in the given initializer list to the end of this list.
+	void extend(std::initializer_list<T> data_list);
+
+	// Adds a node with the given value at any index in the list.
+	// Throws std::out_of_range if index > the length of the list.
+	void insert(T data, size_t index);
+
+	// Prints the contents of the list, elements separated by commas and spaces.
+	void print(std::ostream& stream) const;
+
+	// Deletes a node at a given index and returns its contents.
+	// Throws std::out_of_range if index >= the length of the list.
+	T remove(size_t index);
+
+	// Deletes nodes inclusively between two given indexes.
+	// Throws std::out_of_range if the smaller index >= the length of the list.
+	void remove(size_t index1, size_t index2);
+
+	// Deletes the first node and returns its contents.
+	// Throws std::out_of_range if the list is empty.
+	T pop_front();
+
+	// Deletes the last node and returns its contents.
+	// Throws std::out_of_range if the list is empty.
+	T pop_back();
+
+	// Returns a reference to the first value. Throws std::out_of_range if the list is empty.
+	T& front();
+	const T& front() const;
+
+	// Returns a reference to the last value. Throws std::out_of_range if the list is empty.
+	T& back();
+	const T& back() const;
+
+	// Deletes all the nodes in the list.
+	void clear();
+
+	// Returns the number of nodes in the list.
+	size_t size() const noexcept;
+
+	// An alias for the size function.
+	size_t length() const noexcept;
+
+	// Returns true if the list is empty, false otherwise.
+	bool empty() const noexcept;
+
+	// Finds a value, returning a 0-based index as if an array.
+	std::optional<size_t> find(const T& data) const;
+
+	// Reverses the entire list.
+	void reverse();
+
+	// Swaps two linked lists.
+	void swap(DoublyLinkedList<T>& other);
+
+	// Collects the data from all nodes into a vector and returns it.
+	std::vector<T> vector() const;
+
+	// Determines whether two linked lists have the same data and length.
+	bool operator==(const DoublyLinkedList<T>& other) const;
+
+	// Determines whether two linked lists do not have the same data and length.
+	bool operator!=(const DoublyLinkedList<T>& other) const;
+
+	// Returns a reference to an element of the list as if an array.
+	// The walk starts from the head, the tail, the most recently accessed position, or
+	// the position index, whichever is closest, so accessing neighboring indexes one after
+	// another takes O(1) amortized time.
+	// The non-const overload remembers the position it reached and builds the position index, so it
+	// must not be called on the same list from multiple threads at once. The const overload only
+	// reads them, so it can be.
+	// Throws std::out_of_range if the index is out of bounds.
+	T& operator[](size_t index);
+	const T& operator[](size_t index) const;
+
+	// Starts keeping an index of every k-th node, where k grows with log2 of the list's length,
+	// which makes accessing any index take O(log n) time.
+	// The index costs one pointer per k nodes. Inserting or removing a node invalidates only
+	// the part of the index after it, which is rebuilt the next time it is needed. The whole index
+	// is rebuilt with a larger k when the length passes the next power of two.
+	// Copies, moves, and swaps carry whether the index is on.
+	void enable_position_index();
+
+	// Stops keeping the position index and frees its memory.
+	void disable_position_index();
+
+	iterator begin() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+	iterator end() noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+	reverse_iterator rbegin() noexcept;
+	const_reverse_iterator rbegin() const noexcept;
+	reverse_iterator rend() noexcept;
+	const_reverse_iterator rend() const noexcept;
+
+private:
+
+	class Node
+	{
+	public:
+		T data{};
+		std::unique_ptr<Node> next;
+		Node* previous = nullptr;
+		Node(T data) : data{data} {};
+	};
+
+	template <bool is_const>
+	class basic_iterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<is_const, const T*, T*>;
+		using reference = std::conditional_t<is_const, const T&, T&>;
+
+		basic_iterator() noexcept {};
+
+		// Allows converting an iterator to a const_iterator.
+		template <bool other_is_const, class = std::enable_if_t<is_const && !other_is_const>>
+		basic_iterator(const basic_iterator<other_is_const>& other) noexcept
+			: current{ other.current }, list{ other.list } {};
+
+		reference operator*() const noexcept { return current->data; }
+		pointer operator->() const noexcept { return &current->data; }
+
+		basic_iterator& operator++() noexcept
+		{
+			current = current->next.get();
+			return *this;
+		}
+
+		basic_iterator operator++(int) noexcept
+		{
+			basic_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		// Decrementing the end iterator moves it to the last node.
+		basic_iterator& operator--() noexcept
+		{
+			current = current != nullptr ? current->previous : list->tail;
+			return *this;
+		}
+
+		basic_iterator operator--(int) noexcept
+		{
+			basic_iterator temp = *this;
+			--*this;
+			return temp;
+		}
+
+		bool operator==(const basic_iterator& other) const noexcept { return current == other.current; }
+		bool operator!=(const basic_iterator& other) const noexcept { return current != other.current; }
+
+	private:
+		friend class DoublyLinkedList;
+		template <bool>
+		friend class basic_iterator;
+		Node* current = nullptr;
+		const DoublyLinkedList* list = nullptr;
+		basic_iterator(Node* current, const DoublyLinkedList* list) noexcept : current{ current }, list{ list } {};
+	};
+
+	std::unique_ptr<Node> head;
+	Node* tail = nullptr;
+	size_t _size = 0;
+
+	// The most recently reached node and its index. finger is nullptr when no position is remembered.
+	// Only non-const methods change the finger and the checkpoints, so that const methods can be
+	// called concurrently.
+	Node* finger = nullptr;
+	size_t finger_index = 0;
+
+	// The position index: checkpoints[k] is the node at index k * checkpoint_stride.
+	// Only the first valid_checkpoints entries are up to date.
+	bool indexing = false;
+	std::vector<Node*> checkpoints;
+	size_t valid_checkpoints = 0;
+	size_t checkpoint_stride = 1;
+
+	// Returns the closest node to the given index among the head, the tail, the finger,
+	// and the valid checkpoints, and sets position to that node's index.
+	Node* closest_known(size_t index, size_t& position) const;
+
+	// Walks from the node at the given position to the node at the given index and returns it.
+	static Node* walk(Node* node, size_t position, size_t index) noexcept;
+
+	// Returns the node at the given index, starting the walk from the closest known position,
+	// without changing the known positions.
+	// Throws std::out_of_range if the index is out of bounds.
+	Node* walk_to(size_t index) const;
+
+	// Returns the node at the given index like walk_to, but first builds checkpoints toward it
+	// if the position index is on, and then remembers its position.
+	Node* node_at(size_t index);
+
+	// Makes the checkpoints up to and including the given one valid.
+	void build_checkpoints(size_t last_checkpoint);
+
+	// Links a new node in before the given node, or at the end of the list if position is nullptr.
+	Node* link_before(Node* position, T data);
+
+	// Unlinks a node from the list and returns ownership of it.
+	std::unique_ptr<Node> unlink(Node* node);
+
+	// Forgets remembered positions at or after the given index,
+	// for use when the nodes there are about to move or be deleted.
+	void forget_positions(size_t index = 0) noexcept;
+};
+
+/////////////////////////
+// DoublyLinkedList<T> //
+/////////////////////////
+
+template<class T>
+inline DoublyLinkedList<T>::DoublyLinkedList(std::initializer_list<T> data_list)
+{
+	extend(data_list);
+}
+
+template<class T>
+inline DoublyLinkedList<T>::DoublyLinkedList(const DoublyLinkedList<T>& other)
+	: indexing{ other.indexing }
+{
+	extend(other);
+}
+
+template<class T>
+inline DoublyLinkedList<T>::DoublyLinkedList(DoublyLinkedList<T>&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+template<class T>
+inline DoublyLinkedList<T>::~DoublyLinkedList()
+{
+	clear();
+}
+
+template<class T>
+inline DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(std::initializer_list<T> data_list)
+{
+	clear();
+	extend(data_list);
+	return *this;
+}
+
+template<class T>
+inline DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(const DoublyLinkedList<T>& other)
+{
+	if (this != &other)
+	{
+		clear();
+		extend(other);
+		indexing = other.indexing;
+	}
+	return *this;
+}
+
+template<class T>
+inline DoublyLinkedList<T>& DoublyLinkedList<T>::operator=(DoublyLinkedList<T>&& other) noexcept
+{
+	if (this != &other)
+	{
+		clear();
+		head = std::move(other.head);
+		tail = other.tail;
+		_size = other._size;
+		indexing = other.indexing;
+		other.tail = nullptr;
+		other._size = 0;
+		other.forget_positions();
+	}
+	return *this;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::append(T data)
+{
+	link_before(nullptr, data);
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::prepend(T data)
+{
+	link_before(head.get(), data);
+	forget_positions();
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::extend(const DoublyLinkedList<T>& other)
+{
+	// Copying the size first makes extending a list with itself stop at its original end.
+	size_t count = other._size;
+	for (const Node* node = other.head.get(); count > 0; node = node->next.get(), count--)
+		link_before(nullptr, node->data);
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::extend(std::initializer_list<T> data_list)
+{
+	for (const T& e : data_list)
+		link_before(nullptr, e);
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::insert(T data, size_t index)
+{
+	if (index > _size)
+		throw std::out_of_range("The insertion index must be <= the length of the list.");
+	Node* position = index < _size ? node_at(index) : nullptr;
+	forget_positions(index);
+	finger = link_before(position, data);
+	finger_index = index;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::print(std::ostream& stream) const
+{
+	for (const Node* node = head.get(); node != nullptr; node = node->next.get())
+	{
+		stream << node->data;
+		if (node->next != nullptr)
+			stream << ", ";
+	}
+}
+
+template<class T>
+inline T DoublyLinkedList<T>::remove(size_t index)
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is already empty.");
+	Node* node = node_at(index);
+	forget_positions(index);
+	if (node->previous != nullptr)
+	{
+		finger = node->previous;
+		finger_index = index - 1;
+	}
+	return std::move(unlink(node)->data);
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::remove(size_t index1, size_t index2)
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is already empty.");
+	if (index1 > index2)
+	{
+		size_t temp = std::move(index1);
+		index1 = std::move(index2);
+		index2 = std::move(temp);
+	}
+	Node* node = node_at(index1);
+	forget_positions(index1);
+	for (size_t i = index1; i <= index2 && node != nullptr; i++)
+	{
+		Node* next = node->next.get();
+		unlink(node);
+		node = next;
+	}
+}
+
+template<class T>
+inline T DoublyLinkedList<T>::pop_front()
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is already empty.");
+	forget_positions();
+	return std::move(unlink(head.get())->data);
+}
+
+template<class T>
+inline T DoublyLinkedList<T>::pop_back()
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is already empty.");
+	forget_positions(_size - 1);
+	return std::move(unlink(tail)->data);
+}
+
+template<class T>
+inline T& DoublyLinkedList<T>::front()
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is empty.");
+	return head->data;
+}
+
+template<class T>
+inline const T& DoublyLinkedList<T>::front() const
+{
+	if (head == nullptr)
+		throw std::out_of_range("The list is empty.");
+	return head->data;
+}
+
+template<class T>
+inline T& DoublyLinkedList<T>::back()
+{
+	if (tail == nullptr)
+		throw std::out_of_range("The list is empty.");
+	return tail->data;
+}
+
+template<class T>
+inline const T& DoublyLinkedList<T>::back() const
+{
+	if (tail == nullptr)
+		throw std::out_of_range("The list is empty.");
+	return tail->data;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::clear()
+{
+	// Unlink the nodes one at a time so that destroying a long list does not recurse once per node.
+	while (head != nullptr)
+		head = std::move(head->next);
+	tail = nullptr;
+	_size = 0;
+	forget_positions();
+}
+
+template<class T>
+inline size_t DoublyLinkedList<T>::size() const noexcept
+{
+	return _size;
+}
+
+template<class T>
+inline size_t DoublyLinkedList<T>::length() const noexcept
+{
+	return size();
+}
+
+template<class T>
+inline bool DoublyLinkedList<T>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template<class T>
+inline std::optional<size_t> DoublyLinkedList<T>::find(const T& data) const
+{
+	size_t index = 0;
+	for (const Node* node = head.get(); node != nullptr; node = node->next.get(), index++)
+	{
+		if (node->data == data)
+			return index;
+	}
+	return {};
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::reverse()
+{
+	std::unique_ptr<Node> rest = std::move(head);
+	tail = rest.get();
+	while (rest != nullptr)
+	{
+		std::unique_ptr<Node> node = std::move(rest);
+		rest = std::move(node->next);
+		node->previous = nullptr;
+		if (head != nullptr)
+			head->previous = node.get();
+		node->next = std::move(head);
+		head = std::move(node);
+	}
+	forget_positions();
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::swap(DoublyLinkedList<T>& other)
+{
+	std::swap(head, other.head);
+	std::swap(tail, other.tail);
+	std::swap(_size, other._size);
+	std::swap(indexing, other.indexing);
+	forget_positions();
+	other.forget_positions();
+}
+
+template<class T>
+inline std::vector<T> DoublyLinkedList<T>::vector() const
+{
+	std::vector<T> v;
+	v.reserve(_size);
+	for (const T& e : *this)
+		v.push_back(e);
+	return v;
+}
+
+template<class T>
+inline bool DoublyLinkedList<T>::operator==(const DoublyLinkedList<T>& other) const
+{
+	if (_size != other._size)
+		return false;
+	const Node* node = head.get();
+	const Node* other_node = other.head.get();
+	for (; node != nullptr; node = node->next.get(), other_node = other_node->next.get())
+	{
+		if (!(node->data == other_node->data))
+			return false;
+	}
+	return true;
+}
+
+template<class T>
+inline bool DoublyLinkedList<T>::operator!=(const DoublyLinkedList<T>& other) const
+{
+	return !(*this == other);
+}
+
+template<class T>
+inline T& DoublyLinkedList<T>::operator[](size_t index)
+{
+	return node_at(index)->data;
+}
+
+template<class T>
+inline const T& DoublyLinkedList<T>::operator[](size_t index) const
+{
+	return walk_to(index)->data;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::enable_position_index()
+{
+	indexing = true;
+	valid_checkpoints = 0;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::disable_position_index()
+{
+	indexing = false;
+	valid_checkpoints = 0;
+	checkpoints.clear();
+	checkpoints.shrink_to_fit();
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::iterator DoublyLinkedList<T>::begin() noexcept
+{
+	return iterator(head.get(), this);
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_iterator DoublyLinkedList<T>::begin() const noexcept
+{
+	return const_iterator(head.get(), this);
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_iterator DoublyLinkedList<T>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::iterator DoublyLinkedList<T>::end() noexcept
+{
+	return iterator(nullptr, this);
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_iterator DoublyLinkedList<T>::end() const noexcept
+{
+	return const_iterator(nullptr, this);
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_iterator DoublyLinkedList<T>::cend() const noexcept
+{
+	return end();
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::reverse_iterator DoublyLinkedList<T>::rbegin() noexcept
+{
+	return reverse_iterator(end());
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_reverse_iterator DoublyLinkedList<T>::rbegin() const noexcept
+{
+	return const_reverse_iterator(end());
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::reverse_iterator DoublyLinkedList<T>::rend() noexcept
+{
+	return reverse_iterator(begin());
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::const_reverse_iterator DoublyLinkedList<T>::rend() const noexcept
+{
+	return const_reverse_iterator(begin());
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::Node* DoublyLinkedList<T>::closest_known(size_t index, size_t& position) const
+{
+	// Start from whichever known node is closest to the index.
+	Node* node = head.get();
+	position = 0;
+	size_t distance = index;
+	if (_size - 1 - index < distance)
+	{
+		node = tail;
+		position = _size - 1;
+		distance = _size - 1 - index;
+	}
+	if (finger != nullptr)
+	{
+		const size_t finger_distance = finger_index > index ? finger_index - index : index - finger_index;
+		if (finger_distance < distance)
+		{
+			node = finger;
+			position = finger_index;
+			distance = finger_distance;
+		}
+	}
+	const size_t checkpoint = index / checkpoint_stride;
+	if (indexing && checkpoint < valid_checkpoints && index - checkpoint * checkpoint_stride < distance)
+	{
+		node = checkpoints[checkpoint];
+		position = checkpoint * checkpoint_stride;
+	}
+	return node;
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::Node* DoublyLinkedList<T>::walk(Node* node, size_t position, size_t index) noexcept
+{
+	for (; position < index; position++)
+		node = node->next.get();
+	for (; position > index; position--)
+		node = node->previous;
+	return node;
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::Node* DoublyLinkedList<T>::walk_to(size_t index) const
+{
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	size_t position = 0;
+	Node* node = closest_known(index, position);
+	return walk(node, position, index);
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::Node* DoublyLinkedList<T>::node_at(size_t index)
+{
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	size_t position = 0;
+	Node* node = closest_known(index, position);
+	const size_t distance = position > index ? position - index : index - position;
+	if (indexing && distance > checkpoint_stride)
+	{
+		if (valid_checkpoints == 0 || (size_t(1) << checkpoint_stride) < _size)
+		{
+			// Choose the stride when building the index from scratch, and rebuild the index whenever
+			// the length passes the next power of two, so that the stride tracks log2 of the length.
+			valid_checkpoints = 0;
+			checkpoint_stride = 8;
+			while ((size_t(1) << checkpoint_stride) < _size)
+				checkpoint_stride += 1;
+		}
+		const size_t checkpoint = index / checkpoint_stride;
+		build_checkpoints(checkpoint);
+		node = checkpoints[checkpoint];
+		position = checkpoint * checkpoint_stride;
+	}
+	node = walk(node, position, index);
+	finger = node;
+	finger_index = index;
+	return node;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::build_checkpoints(size_t last_checkpoint)
+{
+	if (last_checkpoint < valid_checkpoints)
+		return;
+	if (checkpoints.size() <= last_checkpoint)
+		checkpoints.resize(last_checkpoint + 1);
+	size_t checkpoint = valid_checkpoints;
+	Node* node = head.get();
+	if (checkpoint > 0)
+	{
+		// Continue from the last valid checkpoint instead of the head.
+		checkpoint -= 1;
+		node = checkpoints[checkpoint];
+	}
+	checkpoints[checkpoint] = node;
+	while (checkpoint < last_checkpoint)
+	{
+		for (size_t i = 0; i < checkpoint_stride; i++)
+			node = node->next.get();
+		checkpoint += 1;
+		checkpoints[checkpoint] = node;
+	}
+	valid_checkpoints = last_checkpoint + 1;
+}
+
+template<class T>
+inline typename DoublyLinkedList<T>::Node* DoublyLinkedList<T>::link_before(Node* position, T data)
+{
+	std::unique_ptr<Node> node = std::make_unique<Node>(data);
+	Node* new_node = node.get();
+	Node* previous = position != nullptr ? position->previous : tail;
+	std::unique_ptr<Node>& link = previous != nullptr ? previous->next : head;
+	node->previous = previous;
+	node->next = std::move(link);
+	if (node->next != nullptr)
+		node->next->previous = new_node;
+	else
+		tail = new_node;
+	link = std::move(node);
+	_size += 1;
+	return new_node;
+}
+
+template<class T>
+inline std::unique_ptr<typename DoublyLinkedList<T>::Node> DoublyLinkedList<T>::unlink(Node* node)
+{
+	std::unique_ptr<Node>& link = node->previous != nullptr ? node->previous->next : head;
+	std::unique_ptr<Node> owned = std::move(link);
+	link = std::move(owned->next);
+	if (link != nullptr)
+		link->previous = owned->previous;
+	else
+		tail = owned->previous;
+	owned->previous = nullptr;
+	_size -= 1;
+	return owned;
+}
+
+template<class T>
+inline void DoublyLinkedList<T>::forget_positions(size_t index) noexcept
+{
+	if (finger != nullptr && finger_index >= index)
+		finger = nullptr;
+	// Checkpoint k is still valid if the node it points to comes before the index.
+	const size_t still_valid = (index + checkpoint_stride - 1) / checkpoint_stride;
+	if (valid_checkpoints > still_valid)
+		valid_checkpoints = still_valid;
+}
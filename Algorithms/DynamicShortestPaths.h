@@ -0,0 +1,259 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "dijkstra.h"
+#include "PriorityQueues.h"
+
+namespace Dijkstra
+{
+	// A shortest path tree from one source that is kept up to date as edges are added, removed,
+	// or change cost, in the style of Ramalingam and Reps' dynamic shortest path algorithm.
+	// An update only revisits the vertexes whose shortest paths it can change: the whole subtree
+	// below a more expensive or removed tree edge, even the vertexes there whose costs turn out
+	// not to change, and the vertexes a cheaper or added edge improves.
+	// The graph is copied into adjacency lists that can change. It keeps at most one edge from
+	// each vertex to each other vertex, so parallel edges are merged into the cheapest one.
+	template <class Name, class Cost>
+	class DynamicShortestPaths
+	{
+	public:
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+
+		// A change to the edge from source to target. An unreachable_cost<Cost>() cost removes the
+		// edge, and any other cost adds it or replaces its cost.
+		struct EdgeUpdate
+		{
+			VertexId source{};
+			VertexId target{};
+			Cost cost{};
+		};
+
+		// Copies the graph and finds the shortest paths from source.
+		// Throws std::invalid_argument if the source is not in the graph.
+		// Each edge must have a nonnegative cost.
+		DynamicShortestPaths(const CsrGraph<Name, Cost>& graph, VertexId source);
+
+		// Changes the graph's edges and then repairs the shortest path tree once for all of them,
+		// which is faster than repairing it after each. Later updates to the same edge win.
+		// Throws std::invalid_argument if an update refers to a vertex that is not in the graph or
+		// has a negative cost, in which case none of the updates are made.
+		void update(const std::vector<EdgeUpdate>& updates);
+		void update(VertexId source, VertexId target, Cost cost);
+
+		// Returns the current shortest path tree.
+		const ShortestPathTree<VertexId, Cost>& tree() const noexcept;
+
+		// Returns the cost of the edge from source to target, or unreachable_cost<Cost>() if there is none.
+		Cost edge_cost(VertexId source, VertexId target) const;
+
+		VertexId vertex_count() const noexcept;
+
+		// Returns how many times the last update reset or settled a vertex, which measures how
+		// much of the tree it had to repair.
+		size_t touched_count() const noexcept;
+
+	private:
+		static constexpr Cost unreached = unreachable_cost<Cost>();
+
+		// An edge in an adjacency list, to or from vertex.
+		struct Arc
+		{
+			VertexId vertex;
+			Cost cost;
+		};
+
+		std::vector<std::vector<Arc>> out_arcs;
+		std::vector<std::vector<Arc>> in_arcs;
+		ShortestPathTree<VertexId, Cost> paths;
+		LazyBinaryHeap<Cost> queue;
+		std::vector<bool> affected;  // Marks the vertexes below a broken tree edge during an update.
+		std::vector<VertexId> affected_vertexes;
+		size_t touched = 0;
+
+		// Sets the edge's cost in both adjacency lists, adding or removing it as needed, and
+		// returns its previous cost.
+		Cost set_arc(VertexId source, VertexId target, Cost cost);
+
+		// Lowers the vertex's cost and queues it if the path through previous is cheaper.
+		void relax(VertexId vertex, VertexId previous, Cost cost);
+
+		// Settles the queued vertexes in order of cost, relaxing their edges.
+		void propagate();
+	};
+
+	//////////////////////////////////////
+	// DynamicShortestPaths<Name, Cost> //
+	//////////////////////////////////////
+
+	template <class Name, class Cost>
+	inline DynamicShortestPaths<Name, Cost>::DynamicShortestPaths(const CsrGraph<Name, Cost>& graph, VertexId source)
+		: out_arcs(graph.vertex_count()), in_arcs(graph.vertex_count()), queue(graph.vertex_count()), affected(graph.vertex_count(), false)
+	{
+		if (source >= graph.vertex_count())
+			throw std::invalid_argument("The source vertex must be in the graph.");
+		for (VertexId v = 0; v < graph.vertex_count(); v++)
+		{
+			std::vector<Arc>& arcs = out_arcs[v];
+			for (auto e = graph.first_edge(v); e < graph.last_edge(v); e++)
+				arcs.push_back({ graph.target(e), graph.weight(e) });
+			// Keep only the cheapest of each group of parallel edges.
+			std::sort(arcs.begin(), arcs.end(), [](const Arc& left, const Arc& right)
+				{ return left.vertex < right.vertex || (left.vertex == right.vertex && left.cost < right.cost); });
+			arcs.erase(std::unique(arcs.begin(), arcs.end(), [](const Arc& left, const Arc& right)
+				{ return left.vertex == right.vertex; }), arcs.end());
+			for (const Arc& arc : arcs)
+				in_arcs[arc.vertex].push_back({ v, arc.cost });
+		}
+		paths.source = source;
+		paths.costs.assign(graph.vertex_count(), unreached);
+		paths.previous.resize(graph.vertex_count());
+		for (VertexId v = 0; v < graph.vertex_count(); v++)
+			paths.previous[v] = v;
+		relax(source, source, 0);
+		propagate();
+	}
+
+	template <class Name, class Cost>
+	inline void DynamicShortestPaths<Name, Cost>::update(const std::vector<EdgeUpdate>& updates)
+	{
+		for (const EdgeUpdate& update : updates)
+			if (update.source >= vertex_count() || update.target >= vertex_count() || update.cost < 0)
+				throw std::invalid_argument("Edge updates must be between vertexes in the graph and cost at least 0.");
+
+		// Change the edges. A tree edge that got more expensive or was removed breaks the shortest
+		// paths of every vertex below it, which are collected below.
+		for (const EdgeUpdate& update : updates)
+		{
+			const Cost old_cost = set_arc(update.source, update.target, update.cost);
+			if (update.cost > old_cost && paths.previous[update.target] == update.source
+				&& update.target != paths.source && !affected[update.target])
+			{
+				affected[update.target] = true;
+				affected_vertexes.push_back(update.target);
+			}
+		}
+		for (size_t i = 0; i < affected_vertexes.size(); i++)
+		{
+			const VertexId vertex = affected_vertexes[i];
+			for (const Arc& arc : out_arcs[vertex])
+				if (paths.previous[arc.vertex] == vertex && arc.vertex != vertex && !affected[arc.vertex])
+				{
+					affected[arc.vertex] = true;
+					affected_vertexes.push_back(arc.vertex);
+				}
+		}
+
+		// The other vertexes' paths still exist, so their costs are upper bounds. Each broken
+		// vertex starts from its cheapest edge from them.
+		for (VertexId vertex : affected_vertexes)
+		{
+			paths.costs[vertex] = unreached;
+			paths.previous[vertex] = vertex;
+		}
+		for (VertexId vertex : affected_vertexes)
+			for (const Arc& arc : in_arcs[vertex])
+				if (!affected[arc.vertex] && paths.costs[arc.vertex] != unreached)
+					relax(vertex, arc.vertex, paths.costs[arc.vertex] + arc.cost);
+		for (VertexId vertex : affected_vertexes)
+			affected[vertex] = false;
+		touched = affected_vertexes.size();
+		affected_vertexes.clear();
+
+		// A cheaper or added edge may start cheaper paths. Edges from broken vertexes are
+		// relaxed when those vertexes are settled.
+		for (const EdgeUpdate& update : updates)
+		{
+			const Cost source_cost = paths.costs[update.source];
+			if (source_cost != unreached && update.cost != unreached && update.cost == edge_cost(update.source, update.target))
+				relax(update.target, update.source, source_cost + update.cost);
+		}
+		propagate();
+	}
+
+	template <class Name, class Cost>
+	inline void DynamicShortestPaths<Name, Cost>::update(VertexId source, VertexId target, Cost cost)
+	{
+		update({ EdgeUpdate{ source, target, cost } });
+	}
+
+	template <class Name, class Cost>
+	inline const ShortestPathTree<typename DynamicShortestPaths<Name, Cost>::VertexId, Cost>& DynamicShortestPaths<Name, Cost>::tree() const noexcept
+	{
+		return paths;
+	}
+
+	template <class Name, class Cost>
+	inline Cost DynamicShortestPaths<Name, Cost>::edge_cost(VertexId source, VertexId target) const
+	{
+		for (const Arc& arc : out_arcs[source])
+			if (arc.vertex == target)
+				return arc.cost;
+		return unreached;
+	}
+
+	template <class Name, class Cost>
+	inline typename DynamicShortestPaths<Name, Cost>::VertexId DynamicShortestPaths<Name, Cost>::vertex_count() const noexcept
+	{
+		return VertexId(out_arcs.size());
+	}
+
+	template <class Name, class Cost>
+	inline size_t DynamicShortestPaths<Name, Cost>::touched_count() const noexcept
+	{
+		return touched;
+	}
+
+	template <class Name, class Cost>
+	inline Cost DynamicShortestPaths<Name, Cost>::set_arc(VertexId source, VertexId target, Cost cost)
+	{
+		// Sets or removes the arc to vertex in one adjacency list and returns its previous cost.
+		auto set = [cost](std::vector<Arc>& arcs, VertexId vertex)
+		{
+			auto arc = std::find_if(arcs.begin(), arcs.end(), [vertex](const Arc& a) { return a.vertex == vertex; });
+			if (arc == arcs.end())
+			{
+				if (cost != unreached)
+					arcs.push_back({ vertex, cost });
+				return unreached;
+			}
+			const Cost old_cost = arc->cost;
+			if (cost != unreached)
+				arc->cost = cost;
+			else
+			{
+				*arc = arcs.back();
+				arcs.pop_back();
+			}
+			return old_cost;
+		};
+		set(in_arcs[target], source);
+		return set(out_arcs[source], target);
+	}
+
+	template <class Name, class Cost>
+	inline void DynamicShortestPaths<Name, Cost>::relax(VertexId vertex, VertexId previous, Cost cost)
+	{
+		if (cost >= paths.costs[vertex])
+			return;
+		paths.costs[vertex] = cost;
+		paths.previous[vertex] = previous;
+		queue.push(vertex, cost);
+	}
+
+	template <class Name, class Cost>
+	inline void DynamicShortestPaths<Name, Cost>::propagate()
+	{
+		while (!queue.empty())
+		{
+			const auto [cost, vertex] = queue.pop();
+			if (cost > paths.costs[vertex])
+				continue;  // A cheaper entry for this vertex was already settled.
+			touched += 1;
+			for (const Arc& arc : out_arcs[vertex])
+				relax(arc.vertex, vertex, cost + arc.cost);
+		}
+	}
+}
@@ -0,0 +1,867 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A singly linked list whose nodes live in one contiguous vector and link to each other with
+// 32-bit indexes instead of pointers. Deleted nodes' slots are kept on a free list and reused.
+// Copying the list copies two vectors, and compact() puts the nodes in traversal order so that
+// walking the list reads memory sequentially.
+template <class T>
+class FlatLinkedList
+{
+	template <bool is_const>
+	class basic_iterator;
+
+public:
+	using index_type = std::uint32_t;
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+
+	// The index that marks the end of a chain of nodes.
+	static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+	FlatLinkedList() noexcept {};
+	FlatLinkedList(T data);
+	FlatLinkedList(std::initializer_list<T> data_list);
+	FlatLinkedList<T>& operator=(std::initializer_list<T> data_list);
+
+	// Adds a node with the given value to the end of the list in O(1) amortized time.
+	void append(T data);
+
+	// Combines two lists, adding each value in the given list to the end of this list.
+	void extend(const FlatLinkedList<T>& other);
+
+	// Combines two lists, adding each value in the given initializer list to the end of this list.
+	void extend(std::initializer_list<T> data_list);
+
+	// Adds a node with the given value at any index in the list.
+	// Throws std::out_of_range if index > the length of the list.
+	void insert(T data, size_t index);
+
+	// Adds nodes with the given values starting at any index in the list.
+	// Throws std::out_of_range if index > the length of the list.
+	void insert_multiple(std::initializer_list<T> data_list, size_t index);
+
+	// Adds a node with the given value after the given position and returns an iterator to it.
+	// The position may be before_begin(). Takes O(1) amortized time.
+	// Throws std::out_of_range if the position is end().
+	iterator insert_after(const_iterator position, T data);
+
+	// Deletes the node after the given position and returns an iterator to the node that followed it.
+	// Takes O(1) time. Throws std::out_of_range if there is no node after the position.
+	iterator erase_after(const_iterator position);
+
+	// Prints the contents of the list, elements separated by commas and spaces.
+	void print(std::ostream& stream) const;
+
+	// Deletes a node at a given index and returns its contents.
+	// Throws std::out_of_range if index >= the length of the list.
+	T remove(size_t index);
+
+	// Deletes nodes inclusively between two given indexes.
+	// Throws std::out_of_range if the smaller index >= the length of the list.
+	void remove(size_t index1, size_t index2);
+
+	// Deletes all the nodes in the list. The storage is kept for reuse.
+	void clear();
+
+	// Returns the number of nodes in the list.
+	size_t size() const noexcept;
+
+	// An alias for the size function.
+	size_t length() const noexcept;
+
+	// Returns true if the list is empty, false otherwise.
+	bool empty() const noexcept;
+
+	// Returns the number of nodes the list can hold before it has to reallocate its storage.
+	size_t capacity() const noexcept;
+
+	// Reserves storage for at least the given number of nodes.
+	// Throws std::length_error if the number does not fit in index_type.
+	void reserve(size_t node_count);
+
+	// Finds a value, returning a 0-based index as if an array.
+	std::optional<size_t> find(const T& data) const;
+
+	// Reverses the entire list by relinking its nodes.
+	void reverse();
+
+	// Swaps two linked lists.
+	void swap(FlatLinkedList<T>& other) noexcept;
+
+	// Moves the values into traversal order at the front of the storage, drops the free list,
+	// and releases unused storage. Afterward, iterating reads memory sequentially and indexing
+	// takes O(1) time until a node is inserted or removed anywhere but the end.
+	void compact();
+
+	// Sorts the list. The sort is stable. It compacts the list and then sorts the contiguous values,
+	// so it is much faster than relinking nodes one at a time.
+	template <class Compare = std::less<T>>
+	void sort(Compare less = Compare());
+
+	// Removes each value that equals the value before it, and returns the number of values removed.
+	template <class BinaryPredicate = std::equal_to<T>>
+	size_t unique(BinaryPredicate equal = BinaryPredicate());
+
+	// Calls a given function on each value in the list, replacing each value with the result.
+	template <class Function>
+	void map(Function f);
+
+	// Creates and returns a list with only the nodes with values that make a given function return true.
+	template <class Predicate>
+	FlatLinkedList<T> filter(Predicate f) const;
+
+	// Returns the combination of all values in the list, combined from left to right using a given function.
+	// Returns T{} if the list is empty.
+	template <class BinaryOperation>
+	T reduce(BinaryOperation f) const;
+
+	// Collects the data from all nodes into a vector and returns it.
+	std::vector<T> vector() const;
+
+	// Writes the list's storage to a binary stream with one bulk write per array.
+	// Requires a trivially copyable T. The format is only meant to be read back on the same platform.
+	void write(std::ostream& stream) const;
+
+	// Reads a list written by write. Throws std::runtime_error if the stream ends early, holds
+	// something else or another version of the format, or holds links that do not form a list.
+	static FlatLinkedList<T> read(std::istream& stream);
+
+	// The first field of the format that write writes, and the format's version, which follows it.
+	static constexpr index_type file_magic = 0x54534c46;  // "FLST"
+	static constexpr index_type file_version = 1;
+
+	// Determines whether two linked lists have the same data and length.
+	bool operator==(const FlatLinkedList<T>& other) const;
+
+	// Determines whether two linked lists do not have the same data and length.
+	bool operator!=(const FlatLinkedList<T>& other) const;
+
+	// Returns a reference to an element of the list as if an array.
+	// Takes O(1) time on a compacted list. Otherwise, accessing increasing indexes one after
+	// another takes O(1) amortized time per access, and other accesses take O(n) time.
+	// The non-const overload remembers the position it reached, so it must not be called on the
+	// same list from multiple threads at once. The const overload only reads it, so it can be.
+	// Throws std::out_of_range if the index is out of bounds.
+	T& operator[](size_t index);
+	const T& operator[](size_t index) const;
+
+	// Returns an iterator to the position before the first node, for use with the *_after functions.
+	iterator before_begin() noexcept;
+	const_iterator before_begin() const noexcept;
+	iterator begin() noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
+	iterator end() noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
+
+private:
+
+	template <bool is_const>
+	class basic_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<is_const, const T*, T*>;
+		using reference = std::conditional_t<is_const, const T&, T&>;
+		using list_pointer = std::conditional_t<is_const, const FlatLinkedList*, FlatLinkedList*>;
+
+		basic_iterator() noexcept {};
+
+		// Allows converting an iterator to a const_iterator.
+		template <bool other_is_const, class = std::enable_if_t<is_const && !other_is_const>>
+		basic_iterator(const basic_iterator<other_is_const>& other) noexcept
+			: list{ other.list }, slot{ other.slot }, before_begin{ other.before_begin } {};
+
+		reference operator*() const noexcept { return list->values[slot]; }
+		pointer operator->() const noexcept { return &list->values[slot]; }
+
+		// Incrementing before_begin() moves to the first node.
+		basic_iterator& operator++() noexcept
+		{
+			if (before_begin)
+				slot = list->head;
+			else if (slot != npos)
+				slot = list->links[slot];
+			before_begin = false;
+			return *this;
+		}
+
+		basic_iterator operator++(int) noexcept
+		{
+			basic_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		bool operator==(const basic_iterator& other) const noexcept
+		{
+			return slot == other.slot && before_begin == other.before_begin
+				&& (!before_begin || list == other.list);
+		}
+
+		bool operator!=(const basic_iterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		friend class FlatLinkedList;
+		template <bool>
+		friend class basic_iterator;
+		list_pointer list = nullptr;
+		index_type slot = npos;
+		bool before_begin = false;
+		basic_iterator(list_pointer list, index_type slot, bool before_begin = false) noexcept
+			: list{ list }, slot{ slot }, before_begin{ before_begin } {};
+	};
+
+	std::vector<T> values;  // values[i] is the value in slot i.
+	std::vector<index_type> links;  // links[i] is the slot after slot i, or npos.
+	index_type head = npos;
+	index_type tail = npos;
+	index_type free_head = npos;  // The first unused slot. Unused slots are linked through links.
+	index_type _size = 0;
+
+	// Whether slot i holds the list's i-th value for every i < _size.
+	bool in_order = true;
+
+	// The most recently reached slot and its index. finger is npos when no position is remembered.
+	// Only non-const methods change it, so that const methods can be called concurrently.
+	index_type finger = npos;
+	size_t finger_index = 0;
+
+	// Returns the slot at the given index without changing the remembered position.
+	// Throws std::out_of_range if the index is out of bounds.
+	index_type walk_to(size_t index) const;
+
+	// Returns the slot at the given index like walk_to, and remembers its position.
+	index_type slot_at(size_t index);
+
+	// Returns a reference to the link that holds the slot after the given slot, or to head if slot is npos.
+	index_type& link_after(index_type slot) noexcept;
+
+	// Returns the slot before the given position, or npos for before_begin().
+	// Throws std::out_of_range if the position is end(), or std::invalid_argument if it belongs to
+	// another list.
+	index_type slot_before(const const_iterator& position) const;
+
+	// Stores a value in a free slot, growing the storage if there is none, and returns the slot.
+	// The slot is not linked into the list.
+	index_type allocate(T data);
+
+	// Adds a slot to the free list and resets its value.
+	void release(index_type slot);
+
+	// Links a new node with the given value in after the given slot, or at the front if previous is npos.
+	index_type link_in(index_type previous, T data);
+
+	// Unlinks and frees the node after the given slot, or the first node if previous is npos,
+	// and returns its value.
+	T unlink_after(index_type previous);
+
+	// Forgets the remembered position if it is at or after the given index.
+	void forget_position(size_t index = 0) noexcept;
+};
+
+///////////////////////
+// FlatLinkedList<T> //
+///////////////////////
+
+template<class T>
+inline FlatLinkedList<T>::FlatLinkedList(T data)
+{
+	append(data);
+}
+
+template<class T>
+inline FlatLinkedList<T>::FlatLinkedList(std::initializer_list<T> data_list)
+{
+	extend(data_list);
+}
+
+template<class T>
+inline FlatLinkedList<T>& FlatLinkedList<T>::operator=(std::initializer_list<T> data_list)
+{
+	clear();
+	extend(data_list);
+	return *this;
+}
+
+template<class T>
+inline void FlatLinkedList<T>::append(T data)
+{
+	const bool stays_in_order = in_order && free_head == npos && values.size() == _size;
+	link_in(tail, data);
+	in_order = stays_in_order;
+}
+
+template<class T>
+inline void FlatLinkedList<T>::extend(const FlatLinkedList<T>& other)
+{
+	reserve(size_t(_size) + other._size);
+	// Copying the size first makes extending a list with itself stop at its original end.
+	index_type count = other._size;
+	for (index_type slot = other.head; count > 0; slot = other.links[slot], count--)
+		append(other.values[slot]);
+}
+
+template<class T>
+inline void FlatLinkedList<T>::extend(std::initializer_list<T> data_list)
+{
+	reserve(size_t(_size) + data_list.size());
+	for (const T& e : data_list)
+		append(e);
+}
+
+template<class T>
+inline void FlatLinkedList<T>::insert(T data, size_t index)
+{
+	if (index > _size)
+		throw std::out_of_range("The insertion index must be <= the length of the list.");
+	if (index == _size)
+	{
+		append(data);
+		return;
+	}
+	const index_type previous = index > 0 ? slot_at(index - 1) : npos;
+	forget_position(index);
+	link_in(previous, data);
+	in_order = false;
+}
+
+template<class T>
+inline void FlatLinkedList<T>::insert_multiple(std::initializer_list<T> data_list, size_t index)
+{
+	if (index > _size)
+		throw std::out_of_range("The insertion index must be <= the length of the list.");
+	for (const T& e : data_list)
+		insert(e, index++);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::iterator FlatLinkedList<T>::insert_after(const_iterator position, T data)
+{
+	const index_type previous = slot_before(position);
+	if (previous == tail && previous != npos)
+	{
+		append(data);
+		return iterator(this, tail);
+	}
+	forget_position();
+	in_order = false;
+	return iterator(this, link_in(previous, data));
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::iterator FlatLinkedList<T>::erase_after(const_iterator position)
+{
+	const index_type previous = slot_before(position);
+	if (link_after(previous) == npos)
+		throw std::out_of_range("There is no node after the given position.");
+	forget_position();
+	in_order = false;
+	unlink_after(previous);
+	return iterator(this, link_after(previous));
+}
+
+template<class T>
+inline void FlatLinkedList<T>::print(std::ostream& stream) const
+{
+	for (index_type slot = head; slot != npos; slot = links[slot])
+	{
+		stream << values[slot];
+		if (links[slot] != npos)
+			stream << ", ";
+	}
+}
+
+template<class T>
+inline T FlatLinkedList<T>::remove(size_t index)
+{
+	if (_size == 0)
+		throw std::out_of_range("The list is already empty.");
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	const index_type previous = index > 0 ? slot_at(index - 1) : npos;
+	forget_position(index);
+	if (index + 1 != _size)
+		in_order = false;
+	return unlink_after(previous);
+}
+
+template<class T>
+inline void FlatLinkedList<T>::remove(size_t index1, size_t index2)
+{
+	if (_size == 0)
+		throw std::out_of_range("The list is already empty.");
+	if (index1 > index2)
+	{
+		size_t temp = std::move(index1);
+		index1 = std::move(index2);
+		index2 = std::move(temp);
+	}
+	if (index1 >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	const index_type previous = index1 > 0 ? slot_at(index1 - 1) : npos;
+	forget_position(index1);
+	if (index2 + 1 < _size)
+		in_order = false;
+	for (size_t i = index1; i <= index2 && link_after(previous) != npos; i++)
+		unlink_after(previous);
+}
+
+template<class T>
+inline void FlatLinkedList<T>::clear()
+{
+	values.clear();
+	links.clear();
+	head = npos;
+	tail = npos;
+	free_head = npos;
+	_size = 0;
+	in_order = true;
+	forget_position();
+}
+
+template<class T>
+inline size_t FlatLinkedList<T>::size() const noexcept
+{
+	return _size;
+}
+
+template<class T>
+inline size_t FlatLinkedList<T>::length() const noexcept
+{
+	return size();
+}
+
+template<class T>
+inline bool FlatLinkedList<T>::empty() const noexcept
+{
+	return _size == 0;
+}
+
+template<class T>
+inline size_t FlatLinkedList<T>::capacity() const noexcept
+{
+	return values.capacity();
+}
+
+template<class T>
+inline void FlatLinkedList<T>::reserve(size_t node_count)
+{
+	if (node_count >= npos)
+		throw std::length_error("A FlatLinkedList cannot hold that many nodes.");
+	values.reserve(node_count);
+	links.reserve(node_count);
+}
+
+template<class T>
+inline std::optional<size_t> FlatLinkedList<T>::find(const T& data) const
+{
+	size_t index = 0;
+	for (index_type slot = head; slot != npos; slot = links[slot], index++)
+	{
+		if (values[slot] == data)
+			return index;
+	}
+	return {};
+}
+
+template<class T>
+inline void FlatLinkedList<T>::reverse()
+{
+	index_type previous = npos;
+	index_type current = head;
+	tail = head;
+	while (current != npos)
+	{
+		const index_type next = links[current];
+		links[current] = previous;
+		previous = current;
+		current = next;
+	}
+	head = previous;
+	in_order = _size < 2;
+	forget_position();
+}
+
+template<class T>
+inline void FlatLinkedList<T>::swap(FlatLinkedList<T>& other) noexcept
+{
+	std::swap(values, other.values);
+	std::swap(links, other.links);
+	std::swap(head, other.head);
+	std::swap(tail, other.tail);
+	std::swap(free_head, other.free_head);
+	std::swap(_size, other._size);
+	std::swap(in_order, other.in_order);
+	forget_position();
+	other.forget_position();
+}
+
+template<class T>
+inline void FlatLinkedList<T>::compact()
+{
+	if (!in_order || values.size() != _size)
+	{
+		std::vector<T> ordered_values;
+		ordered_values.reserve(_size);
+		for (index_type slot = head; slot != npos; slot = links[slot])
+			ordered_values.push_back(std::move(values[slot]));
+		values = std::move(ordered_values);
+	}
+	else
+		values.shrink_to_fit();
+	links.assign(_size, npos);
+	links.shrink_to_fit();
+	for (index_type i = 0; i + 1 < _size; i++)
+		links[i] = i + 1;
+	head = _size > 0 ? 0 : npos;
+	tail = _size > 0 ? _size - 1 : npos;
+	free_head = npos;
+	in_order = true;
+	forget_position();
+}
+
+template<class T>
+template<class Compare>
+inline void FlatLinkedList<T>::sort(Compare less)
+{
+	compact();
+	std::stable_sort(values.begin(), values.end(), less);
+}
+
+template<class T>
+template<class BinaryPredicate>
+inline size_t FlatLinkedList<T>::unique(BinaryPredicate equal)
+{
+	size_t removed = 0;
+	for (index_type slot = head; slot != npos; slot = links[slot])
+	{
+		while (links[slot] != npos && equal(values[slot], values[links[slot]]))
+		{
+			unlink_after(slot);
+			removed += 1;
+		}
+	}
+	if (removed > 0)
+	{
+		in_order = false;
+		forget_position();
+	}
+	return removed;
+}
+
+template<class T>
+template<class Function>
+inline void FlatLinkedList<T>::map(Function f)
+{
+	for (index_type slot = head; slot != npos; slot = links[slot])
+		values[slot] = f(values[slot]);
+}
+
+template<class T>
+template<class Predicate>
+inline FlatLinkedList<T> FlatLinkedList<T>::filter(Predicate f) const
+{
+	FlatLinkedList<T> other;
+	for (index_type slot = head; slot != npos; slot = links[slot])
+	{
+		if (f(values[slot]))
+			other.append(values[slot]);
+	}
+	return other;
+}
+
+template<class T>
+template<class BinaryOperation>
+inline T FlatLinkedList<T>::reduce(BinaryOperation f) const
+{
+	if (head == npos)
+		return T{};
+	T result = values[head];
+	for (index_type slot = links[head]; slot != npos; slot = links[slot])
+		result = f(result, values[slot]);
+	return result;
+}
+
+template<class T>
+inline std::vector<T> FlatLinkedList<T>::vector() const
+{
+	if (in_order)
+		return std::vector<T>(values.begin(), values.begin() + _size);
+	std::vector<T> v;
+	v.reserve(_size);
+	for (index_type slot = head; slot != npos; slot = links[slot])
+		v.push_back(values[slot]);
+	return v;
+}
+
+template<class T>
+inline void FlatLinkedList<T>::write(std::ostream& stream) const
+{
+	static_assert(std::is_trivially_copyable_v<T>, "write requires a trivially copyable value type.");
+	const index_type header[] = { file_magic, file_version, index_type(values.size()), head, tail, free_head, _size, index_type(in_order) };
+	stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(T)));
+	stream.write(reinterpret_cast<const char*>(links.data()), std::streamsize(links.size() * sizeof(index_type)));
+}
+
+template<class T>
+inline FlatLinkedList<T> FlatLinkedList<T>::read(std::istream& stream)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "read requires a trivially copyable value type.");
+	index_type header[8];
+	if (!stream.read(reinterpret_cast<char*>(header), sizeof(header)))
+		throw std::runtime_error("The stream ended before the list's header.");
+	if (header[0] != file_magic)
+		throw std::runtime_error("The stream does not hold a FlatLinkedList.");
+	if (header[1] != file_version)
+		throw std::runtime_error("The stream holds a FlatLinkedList of version " + std::to_string(header[1])
+			+ ", but this program reads version " + std::to_string(file_version) + ".");
+	FlatLinkedList<T> list;
+	const index_type slot_count = header[2];
+	if (slot_count == npos || header[6] > slot_count)
+		throw std::runtime_error("The stream holds a corrupt FlatLinkedList.");
+	list.values.resize(slot_count);
+	list.links.resize(slot_count);
+	if (!stream.read(reinterpret_cast<char*>(list.values.data()), std::streamsize(slot_count * sizeof(T)))
+		|| !stream.read(reinterpret_cast<char*>(list.links.data()), std::streamsize(slot_count * sizeof(index_type))))
+		throw std::runtime_error("The stream ended before the list's nodes.");
+	list.head = header[3];
+	list.tail = header[4];
+	list.free_head = header[5];
+	list._size = header[6];
+	list.in_order = header[7] != 0;
+
+	// Every link must be a slot or npos, the list must reach its tail after exactly _size slots, and
+	// the free list must end, with no slot reached twice, so that no later walk leaves the storage.
+	auto is_link = [&](index_type slot) { return slot < slot_count || slot == npos; };
+	if (!is_link(list.head) || !is_link(list.tail) || !is_link(list.free_head)
+		|| !std::all_of(list.links.begin(), list.links.end(), is_link))
+		throw std::runtime_error("The stream holds a FlatLinkedList with a link out of bounds.");
+	std::vector<bool> reached(slot_count);
+	index_type last = npos;
+	index_type slot = list.head;
+	for (index_type position = 0; position < list._size; position++)
+	{
+		if (slot == npos || reached[slot] || (list.in_order && slot != position))
+			throw std::runtime_error("The stream holds a corrupt FlatLinkedList.");
+		reached[slot] = true;
+		last = slot;
+		slot = list.links[slot];
+	}
+	if (slot != npos || last != list.tail)
+		throw std::runtime_error("The stream holds a corrupt FlatLinkedList.");
+	for (slot = list.free_head; slot != npos; slot = list.links[slot])
+	{
+		if (reached[slot])
+			throw std::runtime_error("The stream holds a corrupt FlatLinkedList.");
+		reached[slot] = true;
+	}
+	return list;
+}
+
+template<class T>
+inline bool FlatLinkedList<T>::operator==(const FlatLinkedList<T>& other) const
+{
+	if (_size != other._size)
+		return false;
+	for (index_type slot = head, other_slot = other.head; slot != npos; slot = links[slot], other_slot = other.links[other_slot])
+	{
+		if (!(values[slot] == other.values[other_slot]))
+			return false;
+	}
+	return true;
+}
+
+template<class T>
+inline bool FlatLinkedList<T>::operator!=(const FlatLinkedList<T>& other) const
+{
+	return !(*this == other);
+}
+
+template<class T>
+inline T& FlatLinkedList<T>::operator[](size_t index)
+{
+	return values[slot_at(index)];
+}
+
+template<class T>
+inline const T& FlatLinkedList<T>::operator[](size_t index) const
+{
+	return values[walk_to(index)];
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::iterator FlatLinkedList<T>::before_begin() noexcept
+{
+	return iterator(this, npos, true);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::const_iterator FlatLinkedList<T>::before_begin() const noexcept
+{
+	return const_iterator(this, npos, true);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::iterator FlatLinkedList<T>::begin() noexcept
+{
+	return iterator(this, head);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::const_iterator FlatLinkedList<T>::begin() const noexcept
+{
+	return const_iterator(this, head);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::const_iterator FlatLinkedList<T>::cbegin() const noexcept
+{
+	return begin();
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::iterator FlatLinkedList<T>::end() noexcept
+{
+	return iterator(this, npos);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::const_iterator FlatLinkedList<T>::end() const noexcept
+{
+	return const_iterator(this, npos);
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::const_iterator FlatLinkedList<T>::cend() const noexcept
+{
+	return end();
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type FlatLinkedList<T>::walk_to(size_t index) const
+{
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	if (in_order)
+		return index_type(index);
+	index_type slot = head;
+	size_t position = 0;
+	if (finger != npos && finger_index <= index)
+	{
+		slot = finger;
+		position = finger_index;
+	}
+	for (; position < index; position++)
+		slot = links[slot];
+	return slot;
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type FlatLinkedList<T>::slot_at(size_t index)
+{
+	const index_type slot = walk_to(index);
+	if (!in_order)
+	{
+		finger = slot;
+		finger_index = index;
+	}
+	return slot;
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type& FlatLinkedList<T>::link_after(index_type slot) noexcept
+{
+	return slot != npos ? links[slot] : head;
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type FlatLinkedList<T>::slot_before(const const_iterator& position) const
+{
+	if (position.list != this)
+		throw std::invalid_argument("The position is in a different list.");
+	if (!position.before_begin && position.slot == npos)
+		throw std::out_of_range("There is no position after the end of the list.");
+	return position.slot;
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type FlatLinkedList<T>::allocate(T data)
+{
+	if (free_head != npos)
+	{
+		const index_type slot = free_head;
+		free_head = links[slot];
+		values[slot] = std::move(data);
+		return slot;
+	}
+	if (values.size() >= npos - 1)
+		throw std::length_error("A FlatLinkedList cannot hold that many nodes.");
+	values.push_back(std::move(data));
+	links.push_back(npos);
+	return index_type(values.size() - 1);
+}
+
+template<class T>
+inline void FlatLinkedList<T>::release(index_type slot)
+{
+	values[slot] = T{};
+	links[slot] = free_head;
+	free_head = slot;
+}
+
+template<class T>
+inline typename FlatLinkedList<T>::index_type FlatLinkedList<T>::link_in(index_type previous, T data)
+{
+	const index_type slot = allocate(std::move(data));
+	index_type& link = link_after(previous);
+	links[slot] = link;
+	link = slot;
+	if (links[slot] == npos)
+		tail = slot;
+	_size += 1;
+	return slot;
+}
+
+template<class T>
+inline T FlatLinkedList<T>::unlink_after(index_type previous)
+{
+	index_type& link = link_after(previous);
+	const index_type slot = link;
+	link = links[slot];
+	if (link == npos)
+		tail = previous;
+	T data = std::move(values[slot]);
+	release(slot);
+	_size -= 1;
+	if (_size == 0)
+		in_order = true;
+	return data;
+}
+
+template<class T>
+inline void FlatLinkedList<T>::forget_position(size_t index) noexcept
+{
+	if (finger != npos && finger_index >= index)
+		finger = npos;
+}
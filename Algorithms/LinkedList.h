@@ -1,13 +1,26 @@
 #pragma once
 #include <exception>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
+#include "ThreadPool.h"
+#include "tracing.h"
 
 template <class T>
 class LinkedList
 {
+	class Node;
+	template <bool is_const>
+	class basic_iterator;
+
 public:
+	using iterator = basic_iterator<false>;
+	using const_iterator = basic_iterator<true>;
+
 	LinkedList() noexcept {};
 	LinkedList(T data);
 	LinkedList(std::initializer_list<T> data_list);
@@ -18,7 +31,7 @@ public:
 	LinkedList<T>& operator=(const LinkedList<T>& other);
 	LinkedList<T>& operator=(LinkedList<T>&& other) noexcept;
 
-	// Adds a node with the given value to the end of the list.
+	// Adds a node with the given value to the end of the list in O(1) time.
 	void append(T data);
 
 	// Combines two lists, adding each value in the given list to the end of this list.
@@ -28,17 +41,19 @@ public:
 	void extend(std::initializer_list<T> data_list);
 
 	// Adds a node with the given value at any index in the list.
-	// Throws std::out_of_range if index >= the length of the list.
+	// Inserting at increasing indexes one after another takes O(1) amortized time per insertion.
+	// Throws std::out_of_range if index > the length of the list.
 	void insert(T data, size_t index);
 
 	// Adds nodes with the given values starting at any index in the list.
-	// Throws std::out_of_range if index >= the length of the list.
+	// Throws std::out_of_range if index > the length of the list.
 	void insert_multiple(std::initializer_list<T> data_list, size_t index);
 
 	// Prints the contents of the list, elements separated by commas and spaces.
 	void print(std::ostream& stream) const;
 
 	// Deletes a node at a given index and returns its contents.
+	// Removing at increasing indexes one after another takes O(1) amortized time per removal.
 	// Throws std::out_of_range if index >= the length of the list.
 	T remove(size_t index);
 
@@ -46,6 +61,36 @@ public:
 	// Throws std::out_of_range if index1 >= the length of the list.
 	void remove(size_t index1, size_t index2);
 
+	// Adds a node with the given value after the given position and returns an iterator to it.
+	// The position may be before_begin(). Takes O(1) time.
+	// Throws std::out_of_range if the position is end().
+	iterator insert_after(const_iterator position, T data);
+
+	// Adds nodes with the given values after the given position and returns an iterator to the
+	// last one, or to the position if there are no values. Takes O(1) time per value.
+	// Throws std::out_of_range if the position is end().
+	iterator insert_after(const_iterator position, std::initializer_list<T> data_list);
+
+	// Deletes the node after the given position and returns an iterator to the node that followed it.
+	// Takes O(1) time. Throws std::out_of_range if there is no node after the position.
+	iterator erase_after(const_iterator position);
+
+	// Deletes the nodes between two positions, exclusively, and returns an iterator to last.
+	iterator erase_after(const_iterator first, const_iterator last);
+
+	// Moves all the nodes of another list to after the given position in this list. Takes O(1) time.
+	// Throws std::invalid_argument if the other list is this list.
+	void splice_after(const_iterator position, LinkedList<T>& other);
+	void splice_after(const_iterator position, LinkedList<T>&& other);
+
+	// Moves the node after it, from another list or this one, to after the given position.
+	// Takes O(1) time. Throws std::out_of_range if there is no node after it.
+	void splice_after(const_iterator position, LinkedList<T>& other, const_iterator it);
+
+	// Moves the nodes between first and last, exclusively, from another list or this one, to after
+	// the given position, which must not be one of them. Takes time linear in the number of nodes moved.
+	void splice_after(const_iterator position, LinkedList<T>& other, const_iterator first, const_iterator last);
+
 	// Deletes all the nodes in the list.
 	void clear();
 
@@ -67,14 +112,47 @@ public:
 	// Swaps two linked lists.
 	void swap(LinkedList<T>& other);
 
-	// Calls a given function on each value in the list.
-	void map(T(*f)(T data));
+	// Sorts the list by relinking its nodes with a bottom-up natural merge sort.
+	// The sort is stable, uses O(1) extra space, and neither copies nor allocates any values.
+	template <class Compare = std::less<T>>
+	void sort(Compare less = Compare());
+
+	// Moves all the nodes of another sorted list into this sorted list, keeping this list sorted.
+	// Of equal values, those from this list come first. The other list is left empty.
+	template <class Compare = std::less<T>>
+	void merge(LinkedList<T>&& other, Compare less = Compare());
+
+	// Removes each value that equals the value before it, and returns the number of values removed.
+	template <class BinaryPredicate = std::equal_to<T>>
+	size_t unique(BinaryPredicate equal = BinaryPredicate());
+
+	// Calls a given function on each value in the list, replacing each value with the result.
+	template <class Function>
+	void map(Function f);
 
 	// Creates and returns a list with only the nodes with values that make a given function return true.
-	LinkedList<T> filter(bool(*f)(T data)) const;
+	template <class Predicate>
+	LinkedList<T> filter(Predicate f) const;
 
-	// Returns the combination of all values in the list, combined using a given function.
-	T reduce(T(*f)(T data1, T data2)) const;
+	// Returns the combination of all values in the list, combined from left to right using a given function.
+	// Returns T{} if the list is empty.
+	template <class BinaryOperation>
+	T reduce(BinaryOperation f) const;
+
+	// Like map, but splits the list into chunks that are processed concurrently.
+	// The function must be safe to call from multiple threads at once.
+	template <class Function>
+	void parallel_map(Function f, ThreadPool& pool = ThreadPool::shared());
+
+	// Like filter, but splits the list into chunks that are processed concurrently.
+	// The order of the values is kept. The function must be safe to call from multiple threads at once.
+	template <class Predicate>
+	LinkedList<T> parallel_filter(Predicate f, ThreadPool& pool = ThreadPool::shared()) const;
+
+	// Like reduce, but reduces chunks of the list concurrently and then combines their results in order.
+	// The function must be associative and safe to call from multiple threads at once.
+	template <class BinaryOperation>
+	T parallel_reduce(BinaryOperation f, ThreadPool& pool = ThreadPool::shared()) const;
 
 	// Collects the data from all nodes into a vector and returns it.
 	std::vector<T> vector() const;
@@ -86,10 +164,13 @@ public:
 	bool operator!=(const LinkedList<T>& other) const;
 
 	// Returns a reference to an element of the list as if an array but with O(n) complexity.
+	// Accessing increasing indexes one after another takes O(1) amortized time per access.
 	// Throws std::out_of_range if the index is out of bounds.
 	T& operator[](size_t index);
 
 	// Returns a reference to an element of the list as if an array but with O(n) complexity.
+	// This walks from the position the non-const overload last reached when that comes first, but
+	// does not remember the position it reaches, so it can be called from multiple threads at once.
 	// Throws std::out_of_range if the index is out of bounds.
 	const T& operator[](size_t index) const;
 
@@ -102,85 +183,139 @@ private:
 		std::unique_ptr<Node> next;
 		Node() noexcept {};
 		Node(T data) : data{data} {};
-		Node(const Node& node);
-
-		// Adds a value to the end of the list.
-		void append(T data);
-
-		// Adds a value at any index > 0 in the list. The index is relative.
-		// Throws std::out_of_range if index >= the length of the list.
-		void insert(T data, size_t index);
-
-		// Adds values starting at any index > 0 in the list. The index is relative.
-		// Throws std::out_of_range if index >= the length of the list.
-		void insert_multiple(std::initializer_list<T> data_list, size_t index);
 
 		// Prints the contents of the list, elements separated by commas and spaces.
 		void print(std::ostream& stream) const;
 
-		// Deletes and returns the contents of a node at a given index > 0. The index is relative.
-		// Throws std::out_of_range if index >= the length of the list.
-		T remove(size_t index);
-
-		// Deletes nodes inclusively between two given indexes.
-		// The indexes are relative.
-		// Returns the number of nodes removed.
-		// Throws std::out_of_range if index1 >= the length of the list.
-		size_t remove(size_t index1, size_t index2);
-
 		// Finds a value, returning its relative index based on the given starting index.
 		std::optional<size_t> find(T data, size_t index = 0) const;
+	};
 
-		// Calls a given function on each value in the list.
-		void map(T(*f)(T data));
+	template <bool is_const>
+	class basic_iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<is_const, const T*, T*>;
+		using reference = std::conditional_t<is_const, const T&, T&>;
 
-		// Returns the combination of all values in the list, combined using a given function.
-		T reduce(T(*f)(T data1, T data2)) const;
+		basic_iterator() noexcept {};
 
-		// Determines whether two linked lists have the same data and length.
-		bool operator==(const Node& other) const;
+		// Allows converting an iterator to a const_iterator.
+		template <bool other_is_const, class = std::enable_if_t<is_const && !other_is_const>>
+		basic_iterator(const basic_iterator<other_is_const>& other) noexcept
+			: current{ other.current }, owner{ other.owner } {};
 
-		// Returns a reference to an element of the list as if an array but with O(n) complexity.
-		// The index is relative.
-		// Throws std::out_of_range if the index is out of bounds.
-		T& operator[](size_t index);
+		reference operator*() const noexcept { return current->data; }
+		pointer operator->() const noexcept { return &current->data; }
 
-		// Returns a reference to an element of the list as if an array but with O(n) complexity.
-		// The index is relative.
-		// Throws std::out_of_range if the index is out of bounds.
-		const T& operator[](size_t index) const;
-	};
+		// Incrementing before_begin() moves to the first node.
+		basic_iterator& operator++() noexcept
+		{
+			if (current != nullptr)
+				current = current->next.get();
+			else if (owner != nullptr)
+				current = owner->head.get();
+			owner = nullptr;
+			return *this;
+		}
 
-public:
+		basic_iterator operator++(int) noexcept
+		{
+			basic_iterator temp = *this;
+			++*this;
+			return temp;
+		}
+
+		bool operator==(const basic_iterator& other) const noexcept
+		{
+			return current == other.current && owner == other.owner;
+		}
+
+		bool operator!=(const basic_iterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
 
-	class iterator
-	{
-	public:
-		friend class LinkedList;
-		iterator() noexcept;
-		iterator(Node*& current) noexcept;
-		iterator(const Node*& current) noexcept;
-		iterator(std::unique_ptr<Node>& current) noexcept;
-		iterator(const std::unique_ptr<Node>& current) noexcept;
-		T& operator*() noexcept;
-		const T& operator*() const noexcept;
-		iterator& operator++() noexcept;
-		iterator operator++(int) noexcept;
-		bool operator!=(const iterator& other) const noexcept;
 	private:
-		Node* previous = nullptr;
+		friend class LinkedList;
+		template <bool>
+		friend class basic_iterator;
 		Node* current = nullptr;
+		const LinkedList* owner = nullptr;  // Only set for before_begin(), which has no node of its own.
+		explicit basic_iterator(Node* current, const LinkedList* owner = nullptr) noexcept
+			: current{ current }, owner{ owner } {};
 	};
 
+public:
+
+	// Returns an iterator to the position before the first node, for use with the *_after functions.
+	iterator before_begin() noexcept;
+	const_iterator before_begin() const noexcept;
+	const_iterator cbefore_begin() const noexcept;
 	iterator begin() noexcept;
-	const iterator begin() const noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator cbegin() const noexcept;
 	iterator end() noexcept;
-	const iterator end() const noexcept;
+	const_iterator end() const noexcept;
+	const_iterator cend() const noexcept;
 
 private:
 
 	std::unique_ptr<Node> head;
+	Node* tail = nullptr;
 	size_t _size = 0;
+
+	// The most recently reached node and its index, so that walking forward from it
+	// can replace walking from the head. finger is nullptr when no position is remembered.
+	// Only non-const methods change it, so that const methods can be called concurrently.
+	Node* finger = nullptr;
+	size_t finger_index = 0;
+
+	// Returns the node at the given index, walking from the remembered position when it comes first,
+	// without changing the remembered position.
+	// Throws std::out_of_range if the index is out of bounds.
+	Node* walk_to(size_t index) const;
+
+	// Returns the node at the given index like walk_to, and remembers its position.
+	Node* node_at(size_t index);
+
+	// Returns the node before the given index, or nullptr if the index is 0.
+	// Throws std::out_of_range if index > the length of the list.
+	Node* node_before(size_t index);
+
+	// Returns the link that owns the node after the given node, or the head if node is nullptr.
+	std::unique_ptr<Node>& link_after(Node* node) noexcept;
+
+	// Returns the link that owns the node after the given position in this list.
+	// Throws std::out_of_range if the position is end(),
+	// or std::invalid_argument if it is another list's before_begin().
+	std::unique_ptr<Node>& link_after(const const_iterator& position);
+
+	// Forgets the remembered position if it is at or after the given index,
+	// for use when the nodes there are about to move or be deleted.
+	void forget_position(size_t index = 0) noexcept;
+
+	// Splits the list into up to chunk_count runs of consecutive nodes of nearly equal length
+	// and calls f(chunk_index, first_node, node_count) for each run using the given thread pool.
+	// Returns the number of runs.
+	template <class Function>
+	size_t for_each_chunk(size_t chunk_count, Function f, ThreadPool& pool) const;
+
+	// Detaches the longest run of sorted nodes from the front of a chain and returns the run.
+	template <class Compare>
+	static std::unique_ptr<Node> take_run(std::unique_ptr<Node>& chain, Compare& less);
+
+	// Merges two sorted chains of nodes into the empty link given by out.
+	// Returns the last node of the merged chain, or nullptr if both chains are empty.
+	template <class Compare>
+	static Node* merge_chains(
+		std::unique_ptr<Node> left, std::unique_ptr<Node> right, std::unique_ptr<Node>* out, Compare& less);
+
+	// Chooses how many chunks the parallel functions split the list into.
+	size_t parallel_chunk_count(const ThreadPool& pool) const noexcept;
 };
 
 ///////////////////
@@ -191,29 +326,20 @@ template<class T>
 inline LinkedList<T>::LinkedList(T data)
 {
 	head = std::make_unique<Node>(data);
+	tail = head.get();
 	_size = 1;
 }
 
 template<class T>
 inline LinkedList<T>::LinkedList(std::initializer_list<T> data_list)
 {
-	std::unique_ptr<Node>* temp = &head;
-	for (T e : data_list)
-	{
-		*temp = std::make_unique<Node>(e);
-		temp = &(*temp)->next;
-	}
-	_size = data_list.size();
+	extend(data_list);
 }
 
 template<class T>
 inline LinkedList<T>::LinkedList(const LinkedList<T>& other)
 {
-	if (other.head != nullptr)
-	{
-		head = std::make_unique<Node>(other.head->data);
-		_size = other.size();
-	}
+	extend(other);
 }
 
 template<class T>
@@ -232,23 +358,18 @@ template<class T>
 inline LinkedList<T>& LinkedList<T>::operator=(std::initializer_list<T> data_list)
 {
 	clear();
-	Node** temp = &head;
-	for (T e : data_list)
-	{
-		*temp = std::make_unique<Node>(e);
-		temp = &(*temp)->next;
-	}
-	_size = data_list.size();
+	extend(data_list);
 	return *this;
 }
 
 template<class T>
 inline LinkedList<T>& LinkedList<T>::operator=(const LinkedList<T>& other)
 {
-	clear();
-	if (other.head != nullptr)
-		head = std::make_unique<Node>(*other.head);
-	_size = other.size();
+	if (this != &other)
+	{
+		clear();
+		extend(other);
+	}
 	return *this;
 }
 
@@ -259,9 +380,12 @@ inline LinkedList<T>& LinkedList<T>::operator=(LinkedList<T>&& other) noexcept
 	{
 		clear();
 		head = std::move(other.head);
+		tail = other.tail;
 		_size = std::move(other._size);
 		other.head = nullptr;
+		other.tail = nullptr;
 		other._size = 0;
+		other.finger = nullptr;
 	}
 	return *this;
 }
@@ -269,77 +393,60 @@ inline LinkedList<T>& LinkedList<T>::operator=(LinkedList<T>&& other) noexcept
 template <class T>
 inline void LinkedList<T>::append(T data)
 {
-	if (head != nullptr)
-		head->append(data);
-	else
-		head = std::make_unique<Node>(data);
+	std::unique_ptr<Node>& link = link_after(tail);
+	link = std::make_unique<Node>(data);
+	tail = link.get();
 	_size += 1;
 }
 
 template <class T>
 inline void LinkedList<T>::extend(const LinkedList<T>& other)
 {
-	std::unique_ptr<Node>* ptr = &head;
-	while (*ptr != nullptr)
-		ptr = &(*ptr)->next;
-	for (T e : other)
-	{
-		*ptr = std::make_unique<Node>(e);
-		ptr = &(*ptr)->next;
-	}
-	_size += other.size();
+	// Copying the size first makes extending a list with itself stop at its original end.
+	size_t count = other._size;
+	for (const Node* node = other.head.get(); count > 0; node = node->next.get(), count--)
+		append(node->data);
 }
 
 template<class T>
 inline void LinkedList<T>::extend(std::initializer_list<T> data_list)
 {
-	std::unique_ptr<Node>* ptr = &head;
-	while (*ptr != nullptr)
-		ptr = &(*ptr)->next;
 	for (T e : data_list)
-	{
-		*ptr = std::make_unique<Node>(e);
-		ptr = &(*ptr)->next;
-	}
-	_size += data_list.size();
+		append(e);
 }
 
 template<class T>
 inline void LinkedList<T>::insert(T data, size_t index)
 {
-	if (index > 0)
-	{
-		if (head == nullptr)
-			throw std::out_of_range("The insertion index must be < the length of the list.");
-		head->insert(data, index);
-	}
-	else
-	{
-		std::unique_ptr<Node> temp = std::move(head);
-		head = std::make_unique<Node>(data);
-		head->next = std::move(temp);
-	}
+	if (index > _size)
+		throw std::out_of_range("The insertion index must be <= the length of the list.");
+	ALGORITHMS_TRACE_COUNT("LinkedList inserts", 1);
+	std::unique_ptr<Node>& link = link_after(node_before(index));
+	std::unique_ptr<Node> node = std::make_unique<Node>(data);
+	node->next = std::move(link);
+	link = std::move(node);
+	if (link->next == nullptr)
+		tail = link.get();
+	forget_position(index);
 	_size += 1;
 }
 
 template<class T>
 inline void LinkedList<T>::insert_multiple(std::initializer_list<T> data_list, size_t index)
 {
-	if (index > 0)
-	{
-		if (head == nullptr)
-			throw std::out_of_range("The insertion index must be < the length of the list.");
-		head->insert_multiple(data_list, index);
-	}
-	else
+	if (index > _size)
+		throw std::out_of_range("The insertion index must be <= the length of the list.");
+	std::unique_ptr<Node>* link = &link_after(node_before(index));
+	for (T e : data_list)
 	{
-		for (auto it = std::rbegin(data_list); it != std::rend(data_list); it++)
-		{
-			std::unique_ptr<Node> temp = std::move(head);
-			head = std::make_unique<Node>(*it);
-			head->next = std::move(temp);
-		}
+		std::unique_ptr<Node> node = std::make_unique<Node>(e);
+		node->next = std::move(*link);
+		*link = std::move(node);
+		if ((*link)->next == nullptr)
+			tail = link->get();
+		link = &(*link)->next;
 	}
+	forget_position(index);
 	_size += data_list.size();
 }
 
@@ -355,15 +462,17 @@ inline T LinkedList<T>::remove(size_t index)
 {
 	if (head == nullptr)
 		throw std::out_of_range("The list is already empty.");
-	if (index > 0)
-	{
-		T temp = head->remove(index);
-		_size -= 1;
-		return temp;
-	}
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	ALGORITHMS_TRACE_COUNT("LinkedList removes", 1);
+	Node* previous = node_before(index);
+	std::unique_ptr<Node>& link = link_after(previous);
+	forget_position(index);
+	T temp_data = std::move(link->data);
+	link = std::move(link->next);
+	if (link == nullptr)
+		tail = previous;
 	_size -= 1;
-	T temp_data = head->data;
-	head = std::move(head->next);
 	return temp_data;
 }
 
@@ -378,28 +487,168 @@ inline void LinkedList<T>::remove(size_t index1, size_t index2)
 		index1 = std::move(index2);
 		index2 = std::move(temp);
 	}
-	if (index1 > 0)
+	if (index1 >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	Node* previous = node_before(index1);
+	std::unique_ptr<Node>& link = link_after(previous);
+	forget_position(index1);
+	for (size_t i = index1; i <= index2 && link != nullptr; i++)
 	{
-		_size -= head->remove(index1, index2);
-		return;
+		link = std::move(link->next);
+		_size -= 1;
 	}
-	for (size_t i = 0; i <= index2 - index1; i++)
+	if (link == nullptr)
+		tail = previous;
+}
+
+template<class T>
+inline typename LinkedList<T>::iterator LinkedList<T>::insert_after(const_iterator position, T data)
+{
+	std::unique_ptr<Node>& link = link_after(position);
+	std::unique_ptr<Node> node = std::make_unique<Node>(data);
+	node->next = std::move(link);
+	link = std::move(node);
+	if (link->next == nullptr)
+		tail = link.get();
+	forget_position();
+	_size += 1;
+	return iterator(link.get());
+}
+
+template<class T>
+inline typename LinkedList<T>::iterator LinkedList<T>::insert_after(
+	const_iterator position, std::initializer_list<T> data_list)
+{
+	iterator last(position.current, position.owner);
+	for (T e : data_list)
+		last = insert_after(last, e);
+	return last;
+}
+
+template<class T>
+inline typename LinkedList<T>::iterator LinkedList<T>::erase_after(const_iterator position)
+{
+	std::unique_ptr<Node>& link = link_after(position);
+	if (link == nullptr)
+		throw std::out_of_range("There is no node after the given position.");
+	forget_position();
+	link = std::move(link->next);
+	if (link == nullptr)
+		tail = position.current;
+	_size -= 1;
+	return iterator(link.get());
+}
+
+template<class T>
+inline typename LinkedList<T>::iterator LinkedList<T>::erase_after(const_iterator first, const_iterator last)
+{
+	std::unique_ptr<Node>& link = link_after(first);
+	forget_position();
+	while (link != nullptr && link.get() != last.current)
 	{
-		if (head == nullptr)
-		{
-			_size -= i;
-			return;
-		}
-		head = std::move(head->next);
+		link = std::move(link->next);
+		_size -= 1;
+	}
+	if (link == nullptr)
+		tail = first.current;
+	return iterator(last.current, last.owner);
+}
+
+template<class T>
+inline void LinkedList<T>::splice_after(const_iterator position, LinkedList<T>& other)
+{
+	if (this == &other)
+		throw std::invalid_argument("A list cannot be spliced into itself.");
+	std::unique_ptr<Node>& link = link_after(position);
+	if (other.head == nullptr)
+		return;
+	other.tail->next = std::move(link);
+	if (other.tail->next == nullptr)
+		tail = other.tail;
+	link = std::move(other.head);
+	_size += other._size;
+	other.tail = nullptr;
+	other._size = 0;
+	forget_position();
+	other.forget_position();
+}
+
+template<class T>
+inline void LinkedList<T>::splice_after(const_iterator position, LinkedList<T>&& other)
+{
+	splice_after(position, other);
+}
+
+template<class T>
+inline void LinkedList<T>::splice_after(const_iterator position, LinkedList<T>& other, const_iterator it)
+{
+	// Find both links before unlinking anything, so that a bad position throws with both lists intact.
+	std::unique_ptr<Node>& link = link_after(position);
+	std::unique_ptr<Node>& source = other.link_after(it);
+	if (source == nullptr)
+		throw std::out_of_range("There is no node after the given position.");
+	// Moving a node to right after itself or right after the node before it changes nothing.
+	if ((position.current == it.current && position.owner == it.owner) || position.current == source.get())
+		return;
+
+	std::unique_ptr<Node> node = std::move(source);
+	source = std::move(node->next);
+	if (source == nullptr)
+		other.tail = it.current;
+	other._size -= 1;
+	other.forget_position();
+
+	node->next = std::move(link);
+	link = std::move(node);
+	if (link->next == nullptr)
+		tail = link.get();
+	_size += 1;
+	forget_position();
+}
+
+template<class T>
+inline void LinkedList<T>::splice_after(
+	const_iterator position, LinkedList<T>& other, const_iterator first, const_iterator last)
+{
+	// Find both links before unlinking anything, so that a bad position throws with both lists intact.
+	std::unique_ptr<Node>& link = link_after(position);
+	std::unique_ptr<Node>& source = other.link_after(first);
+	if (source == nullptr || source.get() == last.current)
+		return;
+
+	// Find the last node to move, counting the nodes on the way.
+	Node* final_node = source.get();
+	size_t count = 1;
+	while (final_node->next != nullptr && final_node->next.get() != last.current)
+	{
+		final_node = final_node->next.get();
+		count += 1;
 	}
-	_size -= index2 - index1 + 1;
+
+	std::unique_ptr<Node> chain = std::move(source);
+	source = std::move(final_node->next);
+	if (source == nullptr)
+		other.tail = first.current;
+	other._size -= count;
+	other.forget_position();
+
+	final_node->next = std::move(link);
+	link = std::move(chain);
+	if (final_node->next == nullptr)
+		tail = final_node;
+	_size += count;
+	forget_position();
 }
 
 template<class T>
 inline void LinkedList<T>::clear()
 {
-	head.reset();
+	// Unlink the nodes one at a time so that destroying a long list does not recurse once per node.
+	while (head != nullptr)
+		head = std::move(head->next);
+	tail = nullptr;
 	_size = 0;
+	finger = nullptr;
 }
 
 template<class T>
@@ -431,6 +680,7 @@ inline std::optional<size_t> LinkedList<T>::find(T data) const
 template<class T>
 inline void LinkedList<T>::reverse()
 {
+	tail = head.get();
 	std::unique_ptr<Node> current = std::move(head);
 	std::unique_ptr<Node> previous = nullptr;
 	std::unique_ptr<Node> temp = nullptr;
@@ -442,6 +692,7 @@ inline void LinkedList<T>::reverse()
 		current = std::move(temp);
 	}
 	head = std::move(previous);
+	forget_position();
 }
 
 template<class T>
@@ -450,48 +701,174 @@ inline void LinkedList<T>::swap(LinkedList<T>& other)
 	std::unique_ptr<Node> temp_head = std::move(head);
 	head = std::move(other.head);
 	other.head = std::move(temp_head);
+	std::swap(tail, other.tail);
 	size_t temp_size = std::move(_size);
 	_size = std::move(other._size);
 	other._size = std::move(temp_size);
+	forget_position();
+	other.forget_position();
 }
 
 template<class T>
-inline void LinkedList<T>::map(T(*f)(T data))
+template<class Compare>
+inline void LinkedList<T>::sort(Compare less)
 {
-	if (head != nullptr)
-		head->map(f);
+	if (_size < 2)
+		return;
+	forget_position();
+	ALGORITHMS_TRACE_SCOPE("LinkedList::sort");
+	// Each pass merges pairs of neighboring sorted runs, at least halving the number of runs.
+	size_t merge_count = 0;
+	do
+	{
+		ALGORITHMS_TRACE_COUNT("LinkedList sort passes", 1);
+		std::unique_ptr<Node> rest = std::move(head);
+		std::unique_ptr<Node>* out = &head;
+		merge_count = 0;
+		while (rest != nullptr)
+		{
+			std::unique_ptr<Node> left = take_run(rest, less);
+			std::unique_ptr<Node> right = take_run(rest, less);
+			tail = merge_chains(std::move(left), std::move(right), out, less);
+			out = &tail->next;
+			merge_count += 1;
+		}
+	} while (merge_count > 1);
+}
+
+template<class T>
+template<class Compare>
+inline void LinkedList<T>::merge(LinkedList<T>&& other, Compare less)
+{
+	if (this == &other)
+		return;
+	tail = merge_chains(std::move(head), std::move(other.head), &head, less);
+	_size += other._size;
+	other.tail = nullptr;
+	other._size = 0;
+	forget_position();
+	other.forget_position();
+}
+
+template<class T>
+template<class BinaryPredicate>
+inline size_t LinkedList<T>::unique(BinaryPredicate equal)
+{
+	forget_position();
+	size_t removed = 0;
+	for (Node* node = head.get(); node != nullptr; node = node->next.get())
+	{
+		while (node->next != nullptr && equal(node->data, node->next->data))
+		{
+			node->next = std::move(node->next->next);
+			removed += 1;
+		}
+		if (node->next == nullptr)
+			tail = node;
+	}
+	_size -= removed;
+	return removed;
 }
 
 template<class T>
-inline LinkedList<T> LinkedList<T>::filter(bool(*f)(T data)) const
+template<class Function>
+inline void LinkedList<T>::map(Function f)
+{
+	for (Node* node = head.get(); node != nullptr; node = node->next.get())
+		node->data = f(node->data);
+}
+
+template<class T>
+template<class Predicate>
+inline LinkedList<T> LinkedList<T>::filter(Predicate f) const
 {
 	LinkedList<T> other;
-	std::unique_ptr<Node>* other_ptr = &other.head;
-	for (T& e : *this)
+	for (const T& e : *this)
 	{
 		if (f(e))
+			other.append(e);
+	}
+	return other;
+}
+
+template<class T>
+template<class BinaryOperation>
+inline T LinkedList<T>::reduce(BinaryOperation f) const
+{
+	if (head == nullptr)
+		return T{};
+	T result = head->data;
+	for (const Node* node = head->next.get(); node != nullptr; node = node->next.get())
+		result = f(result, node->data);
+	return result;
+}
+
+template<class T>
+template<class Function>
+inline void LinkedList<T>::parallel_map(Function f, ThreadPool& pool)
+{
+	for_each_chunk(parallel_chunk_count(pool), [&f](size_t, Node* node, size_t count)
 		{
-			*other_ptr = std::make_unique<Node>(e);
-			other_ptr = &(*other_ptr)->next;
-			other._size += 1;
-		}
+			for (; count > 0; count--, node = node->next.get())
+				node->data = f(node->data);
+		}, pool);
+}
+
+template<class T>
+template<class Predicate>
+inline LinkedList<T> LinkedList<T>::parallel_filter(Predicate f, ThreadPool& pool) const
+{
+	std::vector<LinkedList<T>> parts(parallel_chunk_count(pool));
+	for_each_chunk(parts.size(), [&](size_t chunk, const Node* node, size_t count)
+		{
+			for (; count > 0; count--, node = node->next.get())
+			{
+				if (f(node->data))
+					parts[chunk].append(node->data);
+			}
+		}, pool);
+
+	// Link the chunks' results together in their original order.
+	LinkedList<T> other;
+	for (LinkedList<T>& part : parts)
+	{
+		if (other.tail != nullptr)
+			other.splice_after(const_iterator(other.tail), part);
+		else
+			other.swap(part);
 	}
 	return other;
 }
 
 template<class T>
-inline T LinkedList<T>::reduce(T(*f)(T data1, T data2)) const
+template<class BinaryOperation>
+inline T LinkedList<T>::parallel_reduce(BinaryOperation f, ThreadPool& pool) const
 {
-	if (head != nullptr)
-		return head->reduce(f);
-	return T{};
+	if (head == nullptr)
+		return T{};
+	std::vector<std::optional<T>> results(parallel_chunk_count(pool));
+	const size_t chunk_count = for_each_chunk(results.size(), [&](size_t chunk, const Node* node, size_t count)
+		{
+			T result = node->data;
+			while (--count > 0)
+			{
+				node = node->next.get();
+				result = f(result, node->data);
+			}
+			results[chunk] = std::move(result);
+		}, pool);
+	T result = std::move(*results[0]);
+	for (size_t i = 1; i < chunk_count; i++)
+		result = f(result, *results[i]);
+	return result;
 }
 
 template<class T>
 inline std::vector<T> LinkedList<T>::vector() const
 {
 	std::vector<T> v;
-	for (T& e : *this)
+	v.reserve(_size);
+	for (const T& e : *this)
 		v.push_back(e);
 	return v;
 }
@@ -499,11 +876,16 @@ inline std::vector<T> LinkedList<T>::vector() const
 template<class T>
 inline bool LinkedList<T>::operator==(const LinkedList<T>& other) const
 {
-	if (other.head == nullptr && head == nullptr)
-		return true;
-	if (other.head == nullptr || head == nullptr)
+	if (_size != other._size)
 		return false;
-	return *other.head == *head;
+	const Node* node = head.get();
+	const Node* other_node = other.head.get();
+	for (; node != nullptr; node = node->next.get(), other_node = other_node->next.get())
+	{
+		if (!(node->data == other_node->data))
+			return false;
+	}
+	return true;
 }
 
 template<class T>
@@ -517,7 +899,7 @@ inline T& LinkedList<T>::operator[](size_t index)
 {
 	if (head == nullptr)
 		throw std::out_of_range("The list is empty.");
-	return (*head)[index];
+	return node_at(index)->data;
 }
 
 template <class T>
@@ -525,162 +907,206 @@ inline const T& LinkedList<T>::operator[](size_t index) const
 {
 	if (head == nullptr)
 		throw std::out_of_range("The list is empty.");
-	return (*head)[index];
+	return walk_to(index)->data;
 }
 
-/////////////////////////////
-// LinkedList<T>::iterator //
-/////////////////////////////
+template <class T>
+inline typename LinkedList<T>::Node* LinkedList<T>::walk_to(size_t index) const
+{
+	if (index >= _size)
+		throw std::out_of_range("Index out of bounds.");
+	Node* node = head.get();
+	size_t position = 0;
+	if (finger != nullptr && finger_index <= index)
+	{
+		node = finger;
+		position = finger_index;
+		ALGORITHMS_TRACE_COUNT("LinkedList finger hits", 1);
+	}
+	// The steps show how much of the time indexing spends walking the list.
+	ALGORITHMS_TRACE_COUNT("LinkedList steps", index - position);
+	for (; position < index; position++)
+		node = node->next.get();
+	return node;
+}
 
 template <class T>
-inline LinkedList<T>::iterator::iterator() noexcept
+inline typename LinkedList<T>::Node* LinkedList<T>::node_at(size_t index)
 {
-	current = nullptr;
+	Node* node = walk_to(index);
+	finger = node;
+	finger_index = index;
+	return node;
 }
 
 template <class T>
-inline LinkedList<T>::iterator::iterator(Node*& current) noexcept
+inline typename LinkedList<T>::Node* LinkedList<T>::node_before(size_t index)
 {
-	this->current = current;
+	if (index == 0)
+		return nullptr;
+	if (index > _size)
+		throw std::out_of_range("Index out of bounds.");
+	return node_at(index - 1);
 }
 
 template <class T>
-inline LinkedList<T>::iterator::iterator(const Node*& current) noexcept
+inline std::unique_ptr<typename LinkedList<T>::Node>& LinkedList<T>::link_after(Node* node) noexcept
 {
-	this->current = current;
+	return node != nullptr ? node->next : head;
 }
 
 template <class T>
-inline LinkedList<T>::iterator::iterator(std::unique_ptr<Node>& current) noexcept
+inline std::unique_ptr<typename LinkedList<T>::Node>& LinkedList<T>::link_after(const const_iterator& position)
 {
-	this->current = current.get();
+	if (position.current != nullptr)
+		return position.current->next;
+	if (position.owner == this)
+		return head;
+	if (position.owner != nullptr)
+		throw std::invalid_argument("The position is in a different list.");
+	throw std::out_of_range("There is no position after the end of the list.");
 }
 
 template <class T>
-inline LinkedList<T>::iterator::iterator(const std::unique_ptr<Node>& current) noexcept
+inline void LinkedList<T>::forget_position(size_t index) noexcept
 {
-	this->current = current.get();
+	if (finger != nullptr && finger_index >= index)
+		finger = nullptr;
 }
 
 template <class T>
-inline T& LinkedList<T>::iterator::operator*() noexcept
+template <class Function>
+inline size_t LinkedList<T>::for_each_chunk(size_t chunk_count, Function f, ThreadPool& pool) const
 {
-	return current->data;
+	if (chunk_count > _size)
+		chunk_count = _size;
+	if (chunk_count == 0)
+		return 0;
+
+	// One serial walk finds where each chunk starts; the chunks are then processed independently.
+	std::vector<Node*> starts(chunk_count);
+	std::vector<size_t> counts(chunk_count);
+	Node* node = head.get();
+	for (size_t i = 0; i < chunk_count; i++)
+	{
+		starts[i] = node;
+		counts[i] = _size / chunk_count + (i < _size % chunk_count ? 1 : 0);
+		if (i + 1 < chunk_count)
+			for (size_t j = 0; j < counts[i]; j++)
+				node = node->next.get();
+	}
+	pool.run(chunk_count, [&](size_t i) { f(i, starts[i], counts[i]); });
+	return chunk_count;
 }
 
 template <class T>
-inline const T& LinkedList<T>::iterator::operator*() const noexcept
+template <class Compare>
+inline std::unique_ptr<typename LinkedList<T>::Node> LinkedList<T>::take_run(std::unique_ptr<Node>& chain, Compare& less)
 {
-	return current->data;
+	std::unique_ptr<Node> run = std::move(chain);
+	if (run == nullptr)
+		return run;
+	Node* last = run.get();
+	while (last->next != nullptr && !less(last->next->data, last->data))
+		last = last->next.get();
+	chain = std::move(last->next);
+	return run;
 }
 
 template <class T>
-inline typename LinkedList<T>::iterator& LinkedList<T>::iterator::operator++() noexcept
+template <class Compare>
+inline typename LinkedList<T>::Node* LinkedList<T>::merge_chains(
+	std::unique_ptr<Node> left, std::unique_ptr<Node> right, std::unique_ptr<Node>* out, Compare& less)
 {
-	if (current != nullptr)
+	Node* last = nullptr;
+	while (left != nullptr && right != nullptr)
 	{
-		previous = current;
-		current = current->next.get();
+		// Taking from the left chain unless the right value is strictly less keeps the merge stable.
+		std::unique_ptr<Node>& taken = less(right->data, left->data) ? right : left;
+		*out = std::move(taken);
+		taken = std::move((*out)->next);
+		last = out->get();
+		out = &last->next;
 	}
-	return *this;
+	*out = std::move(left != nullptr ? left : right);
+	while (*out != nullptr)
+	{
+		last = out->get();
+		out = &last->next;
+	}
+	return last;
 }
 
 template <class T>
-inline typename LinkedList<T>::iterator LinkedList<T>::iterator::operator++(int) noexcept
+inline size_t LinkedList<T>::parallel_chunk_count(const ThreadPool& pool) const noexcept
 {
-	iterator temp = *this;
-	++* this;
-	return temp;
+	// A few chunks per thread evens out the work when some values take longer to process than others.
+	const size_t chunk_count = pool.concurrency() * 4;
+	return chunk_count < _size ? chunk_count : _size;
 }
 
+///////////////////////////////
+// LinkedList<T>'s iterators //
+///////////////////////////////
+
 template <class T>
-inline bool LinkedList<T>::iterator::operator!=(typename const iterator& other) const noexcept
+inline typename LinkedList<T>::iterator LinkedList<T>::before_begin() noexcept
 {
-	return current != other.current;
+	return iterator(nullptr, this);
 }
 
 template <class T>
-inline typename LinkedList<T>::iterator LinkedList<T>::begin() noexcept
+inline typename LinkedList<T>::const_iterator LinkedList<T>::before_begin() const noexcept
 {
-	return iterator(head);
+	return const_iterator(nullptr, this);
 }
 
 template <class T>
-inline const typename LinkedList<T>::iterator LinkedList<T>::begin() const noexcept
+inline typename LinkedList<T>::const_iterator LinkedList<T>::cbefore_begin() const noexcept
 {
-	return iterator(head);
+	return before_begin();
 }
 
 template <class T>
-inline typename LinkedList<T>::iterator LinkedList<T>::end() noexcept
+inline typename LinkedList<T>::iterator LinkedList<T>::begin() noexcept
 {
-	return iterator();
+	return iterator(head.get());
 }
 
 template <class T>
-inline const typename LinkedList<T>::iterator LinkedList<T>::end() const noexcept
+inline typename LinkedList<T>::const_iterator LinkedList<T>::begin() const noexcept
 {
-	return iterator();
+	return const_iterator(head.get());
 }
 
-/////////////////////////
-// LinkedList<T>::Node //
-/////////////////////////
-
-template<class T>
-inline LinkedList<T>::Node::Node(const Node& node)
+template <class T>
+inline typename LinkedList<T>::const_iterator LinkedList<T>::cbegin() const noexcept
 {
-	data = node.data;
-	if (node.next != nullptr)
-		next = std::make_unique<Node>(*node.next);
+	return begin();
 }
 
-template<class T>
-inline void LinkedList<T>::Node::append(T data)
+template <class T>
+inline typename LinkedList<T>::iterator LinkedList<T>::end() noexcept
 {
-	if (next != nullptr)
-		next->append(data);
-	else
-		next = std::make_unique<Node>(data);
+	return iterator();
 }
 
-template<class T>
-inline void LinkedList<T>::Node::insert(T data, size_t index)
+template <class T>
+inline typename LinkedList<T>::const_iterator LinkedList<T>::end() const noexcept
 {
-	if (index == 0)
-		throw std::logic_error("The index should never be 0 in this function.");
-	if (index == 1)
-	{
-		std::unique_ptr<Node> node = std::make_unique<Node>(data);
-		node->next = std::move(next);
-		next = std::move(node);
-		return;
-	}
-	if (next == nullptr)
-		throw std::out_of_range("The insertion index must be < the length of the list.");
-	next->insert(data, index - 1);
+	return const_iterator();
 }
 
-template<class T>
-inline void LinkedList<T>::Node::insert_multiple(std::initializer_list<T> data_list, size_t index)
+template <class T>
+inline typename LinkedList<T>::const_iterator LinkedList<T>::cend() const noexcept
 {
-	if (index == 0)
-		throw std::logic_error("The index should never be 0 in this function.");
-	if (index == 1)
-	{
-		for (auto it = std::rbegin(data_list); it != std::rend(data_list); it++)
-		{
-			std::unique_ptr<Node> temp = std::move(next);
-			next = std::make_unique<Node>(*it);
-			next->next = std::move(temp);
-		}
-		return;
-	}
-	else if (next == nullptr)
-		throw std::out_of_range("The insertion index must be < the length of the list.");
-	next->insert_multiple(data_list, index - 1);
+	return end();
 }
 
+/////////////////////////
+// LinkedList<T>::Node //
+/////////////////////////
+
 template<class T>
 inline void LinkedList<T>::Node::print(std::ostream& stream) const
 {
@@ -692,34 +1118,6 @@ inline void LinkedList<T>::Node::print(std::ostream& stream) const
 	}
 }
 
-template<class T>
-inline T LinkedList<T>::Node::remove(size_t index)
-{
-	if (next == nullptr)
-		throw std::out_of_range("Index out of bounds.");
-	if (index > 1)
-		return next->remove(index - 1);
-	T temp_data = next->data;
-	next = std::move(next->next);
-	return temp_data;
-}
-
-template<class T>
-inline size_t LinkedList<T>::Node::remove(size_t index1, size_t index2)
-{
-	if (next == nullptr)
-		throw std::out_of_range("Index out of bounds.");
-	if (index1 > 1)
-		return next->remove(index1 - 1, index2 - 1);
-	for (size_t i = 0; i <= index2 - index1; i++)
-	{
-		if (next == nullptr)
-			return i;
-		next = std::move(next->next);
-	}
-	return index2 - index1 + 1;
-}
-
 template<class T>
 inline std::optional<size_t> LinkedList<T>::Node::find(T data, size_t index) const
 {
@@ -729,49 +1127,3 @@ inline std::optional<size_t> LinkedList<T>::Node::find(T data, size_t index) con
 		return {};
 	return next->find(data, index + 1);
 }
-
-template<class T>
-inline void LinkedList<T>::Node::map(T(*f)(T data))
-{
-	data = f(data);
-	if (next != nullptr)
-		next->map(f);
-}
-
-template<class T>
-inline T LinkedList<T>::Node::reduce(T(*f)(T data1, T data2)) const
-{
-	if (next == nullptr)
-		return data;
-	return f(data, next->reduce(f));
-}
-
-template<class T>
-inline bool LinkedList<T>::Node::operator==(const LinkedList<T>::Node& other) const
-{
-	if (other.next == nullptr && next == nullptr)
-		return true;
-	if (other.data != data || other.next == nullptr || next == nullptr)
-		return false;
-	return *other.next == *next;
-}
-
-template <class T>
-inline T& LinkedList<T>::Node::operator[](size_t index)
-{
-	if (index == 0)
-		return data;
-	if (next == nullptr)
-		throw std::out_of_range("Index out of bounds.");
-	return (*next)[index - 1];
-}
-
-template <class T>
-inline const T& LinkedList<T>::Node::operator[](size_t index) const
-{
-	if (index == 0)
-		return data;
-	if (next == nullptr)
-		throw std::out_of_range("Index out of bounds.");
-	return (*next)[index - 1];
-}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only memory mapping of a whole file. The operating system loads the file's pages
+// the first time they are read and can share them between processes, so opening even a huge
+// file is nearly instant.
+class MappedFile
+{
+public:
+	// Maps the file. Throws std::runtime_error if it cannot be opened or mapped.
+	explicit MappedFile(const std::string& path);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	~MappedFile();
+
+	// Returns the file's first byte, which is aligned to at least a page boundary.
+	// An empty file has no data.
+	const char* data() const noexcept { return bytes; }
+	size_t size() const noexcept { return byte_count; }
+
+private:
+	const char* bytes = nullptr;
+	size_t byte_count = 0;
+
+	void unmap() noexcept;
+};
+
+////////////////
+// MappedFile //
+////////////////
+
+#ifdef _WIN32
+
+inline MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Unable to open " + path);
+	LARGE_INTEGER file_size{};
+	if (!GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Unable to get the size of " + path);
+	}
+	byte_count = size_t(file_size.QuadPart);
+	if (byte_count == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping)
+		throw std::runtime_error("Unable to map " + path);
+	bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);  // The view keeps the mapping open.
+	if (!bytes)
+		throw std::runtime_error("Unable to map " + path);
+}
+
+inline void MappedFile::unmap() noexcept
+{
+	if (bytes)
+		UnmapViewOfFile(bytes);
+}
+
+#else
+
+inline MappedFile::MappedFile(const std::string& path)
+{
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("Unable to open " + path);
+	struct stat status {};
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw std::runtime_error("Unable to get the size of " + path);
+	}
+	byte_count = size_t(status.st_size);
+	if (byte_count == 0)
+	{
+		close(file);
+		return;
+	}
+	void* address = mmap(nullptr, byte_count, PROT_READ, MAP_SHARED, file, 0);
+	close(file);  // The mapping keeps the file open.
+	if (address == MAP_FAILED)
+		throw std::runtime_error("Unable to map " + path);
+	bytes = static_cast<const char*>(address);
+}
+
+inline void MappedFile::unmap() noexcept
+{
+	if (bytes)
+		munmap(const_cast<char*>(bytes), byte_count);
+}
+
+#endif
+
+inline MappedFile::MappedFile(MappedFile&& other) noexcept
+	: bytes{ other.bytes }, byte_count{ other.byte_count }
+{
+	other.bytes = nullptr;
+	other.byte_count = 0;
+}
+
+inline MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+		bytes = other.bytes;
+		byte_count = other.byte_count;
+		other.bytes = nullptr;
+		other.byte_count = 0;
+	}
+	return *this;
+}
+
+inline MappedFile::~MappedFile()
+{
+	unmap();
+}
@@ -0,0 +1,560 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Min priority queues of vertexes with dense IDs, for use as the queue of a shortest path search.
+// Each has the same interface:
+//   explicit Queue(size_t vertex_count);
+//   bool empty() const;
+//   void push(Id vertex, Key key);      // Queues a vertex, or lowers its key if it is already queued.
+//   std::pair<Key, Id> pop();           // Removes and returns an entry with the smallest key.
+//   void clear();                       // Removes every entry, keeping the storage for reuse.
+// The lazy queues (LazyBinaryHeap, RadixHeap and DialBuckets) never lower a key in place; they
+// queue the vertex again instead, so pop can return stale entries whose keys are no longer
+// the vertex's best, and the caller must skip them. The indexed queues (IndexedDaryHeap and
+// PairingHeap) hold each vertex at most once and decrease its key in place.
+
+// A binary heap that queues a vertex again instead of decreasing its key.
+// A good default for any key type.
+template <class Key, class Id = std::uint32_t>
+class LazyBinaryHeap
+{
+public:
+	explicit LazyBinaryHeap(size_t vertex_count = 0);
+	bool empty() const noexcept;
+	void push(Id vertex, Key key);
+	std::pair<Key, Id> pop();
+	void clear() noexcept;
+
+	// Returns an entry with the smallest key without removing it.
+	const std::pair<Key, Id>& top() const;
+
+private:
+	using Entry = std::pair<Key, Id>;
+	std::vector<Entry> heap;
+};
+
+// A d-ary heap that tracks each vertex's position so that it can decrease keys in place.
+// The heap stays at most V entries long, and with 4 children per node its sift-downs are
+// shallower and touch fewer cache lines than a binary heap's.
+template <class Key, size_t Arity = 4, class Id = std::uint32_t>
+class IndexedDaryHeap
+{
+	static_assert(Arity >= 2, "A d-ary heap needs at least 2 children per node.");
+
+public:
+	explicit IndexedDaryHeap(size_t vertex_count);
+	bool empty() const noexcept;
+	void push(Id vertex, Key key);
+	std::pair<Key, Id> pop();
+	void clear() noexcept;
+
+private:
+	static constexpr Id npos = std::numeric_limits<Id>::max();
+	std::vector<std::pair<Key, Id>> heap;
+	std::vector<Id> positions;  // Each vertex's index in the heap, or npos if it is not queued.
+
+	void sift_up(size_t index, std::pair<Key, Id> entry);
+	void sift_down(size_t index, std::pair<Key, Id> entry);
+};
+
+// A pairing heap with one preallocated node per vertex, linked by vertex IDs.
+// Pushes and decrease-keys take O(1) time, which suits graphs with many improving relaxations.
+template <class Key, class Id = std::uint32_t>
+class PairingHeap
+{
+public:
+	explicit PairingHeap(size_t vertex_count);
+	bool empty() const noexcept;
+	void push(Id vertex, Key key);
+	std::pair<Key, Id> pop();
+	void clear() noexcept;
+
+private:
+	static constexpr Id npos = std::numeric_limits<Id>::max();
+
+	struct Node
+	{
+		Key key{};
+		Id child = npos;
+		Id sibling = npos;
+		Id previous = npos;  // The parent if this is a first child, or else the previous sibling.
+		bool queued = false;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<Id> pairs;  // Scratch space for pop.
+	Id root = npos;
+
+	// Combines two detached heaps and returns the root of the result.
+	Id meld(Id first, Id second) noexcept;
+
+	// Detaches a node and its subtree from its parent and siblings.
+	void cut(Id vertex) noexcept;
+};
+
+// A monotone radix heap for nonnegative integer keys. Keys must never be less than the last
+// popped key, which always holds in Dijkstra's algorithm. Each entry is moved between buckets
+// at most once per bit of the key, so it is fast when costs vary widely.
+template <class Key, class Id = std::uint32_t>
+class RadixHeap
+{
+	static_assert(std::is_integral<Key>::value, "A radix heap needs integer keys.");
+
+public:
+	explicit RadixHeap(size_t vertex_count = 0);
+	bool empty() const noexcept;
+
+	// Throws std::invalid_argument if the key is less than the last popped key.
+	void push(Id vertex, Key key);
+
+	std::pair<Key, Id> pop();
+	void clear() noexcept;
+
+private:
+	using Bits = std::make_unsigned_t<Key>;
+	static constexpr size_t bucket_count = std::numeric_limits<Bits>::digits + 1;
+
+	// Bucket 0 holds keys equal to last, and bucket i > 0 holds keys whose highest bit
+	// that differs from last is bit i - 1.
+	std::vector<std::pair<Key, Id>> buckets[bucket_count];
+	Key last = 0;
+	size_t count = 0;
+
+	size_t bucket_of(Key key) const noexcept;
+};
+
+// Dial's algorithm's circular array of buckets, one per key, for nonnegative integer keys that
+// are never less than the last popped key. Pops scan forward from the last popped key, so it is
+// fastest when edge costs are small integers. The array grows to span the widest key range queued.
+template <class Key, class Id = std::uint32_t>
+class DialBuckets
+{
+	static_assert(std::is_integral<Key>::value, "Dial's buckets need integer keys.");
+
+public:
+	explicit DialBuckets(size_t vertex_count = 0);
+	bool empty() const noexcept;
+
+	// Throws std::invalid_argument if the key is less than the last popped key.
+	void push(Id vertex, Key key);
+
+	std::pair<Key, Id> pop();
+	void clear() noexcept;
+
+private:
+	std::vector<std::vector<Id>> buckets;
+	Key current = 0;  // No queued key is less than this.
+	size_t count = 0;
+
+	void grow(size_t span);
+};
+
+////////////////////
+// LazyBinaryHeap //
+////////////////////
+
+template <class Key, class Id>
+inline LazyBinaryHeap<Key, Id>::LazyBinaryHeap(size_t vertex_count)
+{
+	heap.reserve(vertex_count);
+}
+
+template <class Key, class Id>
+inline bool LazyBinaryHeap<Key, Id>::empty() const noexcept
+{
+	return heap.empty();
+}
+
+template <class Key, class Id>
+inline void LazyBinaryHeap<Key, Id>::push(Id vertex, Key key)
+{
+	heap.push_back({ key, vertex });
+	std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+}
+
+template <class Key, class Id>
+inline std::pair<Key, Id> LazyBinaryHeap<Key, Id>::pop()
+{
+	std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+	const Entry top = heap.back();
+	heap.pop_back();
+	return top;
+}
+
+template <class Key, class Id>
+inline const std::pair<Key, Id>& LazyBinaryHeap<Key, Id>::top() const
+{
+	return heap.front();
+}
+
+template <class Key, class Id>
+inline void LazyBinaryHeap<Key, Id>::clear() noexcept
+{
+	heap.clear();
+}
+
+/////////////////////
+// IndexedDaryHeap //
+/////////////////////
+
+template <class Key, size_t Arity, class Id>
+inline IndexedDaryHeap<Key, Arity, Id>::IndexedDaryHeap(size_t vertex_count)
+	: positions(vertex_count, npos)
+{
+}
+
+template <class Key, size_t Arity, class Id>
+inline bool IndexedDaryHeap<Key, Arity, Id>::empty() const noexcept
+{
+	return heap.empty();
+}
+
+template <class Key, size_t Arity, class Id>
+inline void IndexedDaryHeap<Key, Arity, Id>::push(Id vertex, Key key)
+{
+	const Id position = positions[vertex];
+	if (position == npos)
+	{
+		heap.emplace_back();
+		sift_up(heap.size() - 1, { key, vertex });
+	}
+	else if (key < heap[position].first)
+		sift_up(position, { key, vertex });
+}
+
+template <class Key, size_t Arity, class Id>
+inline std::pair<Key, Id> IndexedDaryHeap<Key, Arity, Id>::pop()
+{
+	const std::pair<Key, Id> top = heap.front();
+	positions[top.second] = npos;
+	const std::pair<Key, Id> last = heap.back();
+	heap.pop_back();
+	if (heap.size())
+		sift_down(0, last);
+	return top;
+}
+
+template <class Key, size_t Arity, class Id>
+inline void IndexedDaryHeap<Key, Arity, Id>::clear() noexcept
+{
+	for (const std::pair<Key, Id>& entry : heap)
+		positions[entry.second] = npos;
+	heap.clear();
+}
+
+template <class Key, size_t Arity, class Id>
+inline void IndexedDaryHeap<Key, Arity, Id>::sift_up(size_t index, std::pair<Key, Id> entry)
+{
+	while (index > 0)
+	{
+		const size_t parent = (index - 1) / Arity;
+		if (!(entry.first < heap[parent].first))
+			break;
+		heap[index] = heap[parent];
+		positions[heap[index].second] = Id(index);
+		index = parent;
+	}
+	heap[index] = entry;
+	positions[entry.second] = Id(index);
+}
+
+template <class Key, size_t Arity, class Id>
+inline void IndexedDaryHeap<Key, Arity, Id>::sift_down(size_t index, std::pair<Key, Id> entry)
+{
+	const size_t size = heap.size();
+	while (true)
+	{
+		const size_t first_child = index * Arity + 1;
+		if (first_child >= size)
+			break;
+		const size_t last_child = std::min(first_child + Arity, size);
+		size_t smallest = first_child;
+		for (size_t child = first_child + 1; child < last_child; child++)
+			if (heap[child].first < heap[smallest].first)
+				smallest = child;
+		if (!(heap[smallest].first < entry.first))
+			break;
+		heap[index] = heap[smallest];
+		positions[heap[index].second] = Id(index);
+		index = smallest;
+	}
+	heap[index] = entry;
+	positions[entry.second] = Id(index);
+}
+
+/////////////////
+// PairingHeap //
+/////////////////
+
+template <class Key, class Id>
+inline PairingHeap<Key, Id>::PairingHeap(size_t vertex_count)
+	: nodes(vertex_count)
+{
+}
+
+template <class Key, class Id>
+inline bool PairingHeap<Key, Id>::empty() const noexcept
+{
+	return root == npos;
+}
+
+template <class Key, class Id>
+inline void PairingHeap<Key, Id>::push(Id vertex, Key key)
+{
+	Node& node = nodes[vertex];
+	if (node.queued)
+	{
+		if (!(key < node.key))
+			return;
+		node.key = key;
+		if (vertex == root)
+			return;
+		cut(vertex);
+	}
+	else
+	{
+		node = Node();
+		node.key = key;
+		node.queued = true;
+	}
+	root = root == npos ? vertex : meld(root, vertex);
+}
+
+template <class Key, class Id>
+inline std::pair<Key, Id> PairingHeap<Key, Id>::pop()
+{
+	const Id top = root;
+	Node& top_node = nodes[top];
+	top_node.queued = false;
+
+	// The standard two-pass pairing: meld the children in pairs from left to right,
+	// then meld the pairs into one heap from right to left.
+	pairs.clear();
+	for (Id child = top_node.child; child != npos;)
+	{
+		const Id first = child;
+		const Id second = nodes[first].sibling;
+		child = second == npos ? npos : nodes[second].sibling;
+		nodes[first].sibling = nodes[first].previous = npos;
+		if (second == npos)
+			pairs.push_back(first);
+		else
+		{
+			nodes[second].sibling = nodes[second].previous = npos;
+			pairs.push_back(meld(first, second));
+		}
+	}
+	root = npos;
+	for (auto it = pairs.rbegin(); it != pairs.rend(); ++it)
+		root = root == npos ? *it : meld(*it, root);
+	top_node.child = npos;
+	return { top_node.key, top };
+}
+
+template <class Key, class Id>
+inline void PairingHeap<Key, Id>::clear() noexcept
+{
+	// Mark every queued node as unqueued by walking the tree from the root.
+	pairs.clear();
+	if (root != npos)
+		pairs.push_back(root);
+	while (pairs.size())
+	{
+		const Id vertex = pairs.back();
+		pairs.pop_back();
+		for (Id child = nodes[vertex].child; child != npos; child = nodes[child].sibling)
+			pairs.push_back(child);
+		nodes[vertex].queued = false;
+	}
+	root = npos;
+}
+
+template <class Key, class Id>
+inline Id PairingHeap<Key, Id>::meld(Id first, Id second) noexcept
+{
+	if (nodes[second].key < nodes[first].key)
+		std::swap(first, second);
+	Node& parent = nodes[first];
+	Node& child = nodes[second];
+	child.sibling = parent.child;
+	if (parent.child != npos)
+		nodes[parent.child].previous = second;
+	child.previous = first;
+	parent.child = second;
+	return first;
+}
+
+template <class Key, class Id>
+inline void PairingHeap<Key, Id>::cut(Id vertex) noexcept
+{
+	Node& node = nodes[vertex];
+	Node& previous = nodes[node.previous];
+	if (previous.child == vertex)
+		previous.child = node.sibling;
+	else
+		previous.sibling = node.sibling;
+	if (node.sibling != npos)
+		nodes[node.sibling].previous = node.previous;
+	node.sibling = node.previous = npos;
+}
+
+///////////////
+// RadixHeap //
+///////////////
+
+template <class Key, class Id>
+inline RadixHeap<Key, Id>::RadixHeap(size_t)
+{
+}
+
+template <class Key, class Id>
+inline bool RadixHeap<Key, Id>::empty() const noexcept
+{
+	return count == 0;
+}
+
+template <class Key, class Id>
+inline void RadixHeap<Key, Id>::push(Id vertex, Key key)
+{
+	if (key < last)
+		throw std::invalid_argument("A radix heap's keys cannot be less than the last popped key.");
+	buckets[bucket_of(key)].push_back({ key, vertex });
+	count += 1;
+}
+
+template <class Key, class Id>
+inline std::pair<Key, Id> RadixHeap<Key, Id>::pop()
+{
+	if (buckets[0].empty())
+	{
+		// Move the first nonempty bucket's entries down, relative to its smallest key.
+		// They all share their bits above the bucket's bit, so each lands in a lower bucket.
+		size_t i = 1;
+		while (buckets[i].empty())
+			i++;
+		std::vector<std::pair<Key, Id>>& bucket = buckets[i];
+		last = bucket.front().first;
+		for (const std::pair<Key, Id>& entry : bucket)
+			if (entry.first < last)
+				last = entry.first;
+		for (const std::pair<Key, Id>& entry : bucket)
+			buckets[bucket_of(entry.first)].push_back(entry);
+		bucket.clear();
+	}
+	const std::pair<Key, Id> top = buckets[0].back();
+	buckets[0].pop_back();
+	count -= 1;
+	return top;
+}
+
+template <class Key, class Id>
+inline void RadixHeap<Key, Id>::clear() noexcept
+{
+	for (std::vector<std::pair<Key, Id>>& bucket : buckets)
+		bucket.clear();
+	last = 0;
+	count = 0;
+}
+
+template <class Key, class Id>
+inline size_t RadixHeap<Key, Id>::bucket_of(Key key) const noexcept
+{
+	const Bits difference = Bits(key) ^ Bits(last);
+	if (difference == 0)
+		return 0;
+	const unsigned long long bits = difference;
+#if defined(_MSC_VER)
+	unsigned long highest_bit;
+	_BitScanReverse64(&highest_bit, bits);
+	return size_t(highest_bit) + 1;
+#elif defined(__GNUC__)
+	return size_t(64 - __builtin_clzll(bits));
+#else
+	size_t width = 0;
+	for (unsigned long long b = bits; b != 0; b >>= 1)
+		width++;
+	return width;
+#endif
+}
+
+/////////////////
+// DialBuckets //
+/////////////////
+
+template <class Key, class Id>
+inline DialBuckets<Key, Id>::DialBuckets(size_t)
+	: buckets(16)
+{
+}
+
+template <class Key, class Id>
+inline bool DialBuckets<Key, Id>::empty() const noexcept
+{
+	return count == 0;
+}
+
+template <class Key, class Id>
+inline void DialBuckets<Key, Id>::push(Id vertex, Key key)
+{
+	if (key < current)
+		throw std::invalid_argument("Dial's buckets' keys cannot be less than the last popped key.");
+	const size_t span = size_t(key - current);
+	if (span >= buckets.size())
+		grow(span);
+	buckets[size_t(key) % buckets.size()].push_back(vertex);
+	count += 1;
+}
+
+template <class Key, class Id>
+inline std::pair<Key, Id> DialBuckets<Key, Id>::pop()
+{
+	// Every queued key is within buckets.size() of current, so the first
+	// nonempty bucket from current's holds only the smallest key.
+	size_t index = size_t(current) % buckets.size();
+	while (buckets[index].empty())
+	{
+		current += 1;
+		index = index + 1 == buckets.size() ? 0 : index + 1;
+	}
+	const Id vertex = buckets[index].back();
+	buckets[index].pop_back();
+	count -= 1;
+	return { current, vertex };
+}
+
+template <class Key, class Id>
+inline void DialBuckets<Key, Id>::clear() noexcept
+{
+	for (std::vector<Id>& bucket : buckets)
+		bucket.clear();
+	current = 0;
+	count = 0;
+}
+
+template <class Key, class Id>
+inline void DialBuckets<Key, Id>::grow(size_t span)
+{
+	size_t size = buckets.size();
+	while (size <= span)
+		size *= 2;
+	std::vector<std::vector<Id>> old_buckets(size);
+	old_buckets.swap(buckets);
+	// The old array held keys from current up to current + its size, one key per bucket.
+	for (size_t i = 0; i < old_buckets.size(); i++)
+	{
+		const size_t offset = (i + old_buckets.size() - size_t(current) % old_buckets.size()) % old_buckets.size();
+		const size_t key = size_t(current) + offset;
+		for (Id vertex : old_buckets[i])
+			buckets[key % size].push_back(vertex);
+	}
+}
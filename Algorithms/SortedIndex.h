@@ -0,0 +1,291 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "MappedFile.h"
+#include "parallel_sort.h"
+#include "ThreadPool.h"
+
+// A file of sorted keys, each with optional payload bytes, that is searched in place through a
+// memory mapping. Opening one takes about the same time for any size, nothing is copied into
+// the heap, and processes that open the same file share its pages in the operating system's cache.
+// The file starts with a header of 64-bit integers, followed by these sections, each padded to a
+// multiple of 8 bytes: the sorted keys; if there are payloads, the byte offset of each key's
+// payload and the end of the last one, and then the payloads; and a fence table of every
+// fence_stride-th key. A search first binary searches the small fence table, which stays in the
+// cache, and then one block of keys about a page long, so it reads about one page of the file.
+// Keys must be trivially copyable and ordered by <. Only the header and the sections' sizes are
+// checked when a file is opened, so the rest of it is trusted. The format is only meant to be
+// read on machines with the same byte order.
+template <class Key>
+class SortedIndex
+{
+public:
+	// The version of the format that this class writes and reads.
+	static constexpr std::uint64_t version = 1;
+
+	// How many keys each fence stands for: about a page of keys.
+	static constexpr size_t fence_stride = std::max<size_t>(1, 4096 / sizeof(Key));
+
+	// Maps an index file. Throws std::runtime_error if it cannot be mapped, or does not hold an
+	// index of this version with this key type.
+	explicit SortedIndex(const std::string& path);
+
+	// Sorts the keys on the pool's threads and writes them as an index file without payloads.
+	static void write(std::ostream& stream, std::vector<Key> keys, ThreadPool& pool = ThreadPool::shared());
+
+	// Sorts the keys with their payloads, which can be any bytes, and writes them as an index file.
+	// Keys that are equal keep the order of their payloads.
+	// Throws std::invalid_argument if there are not as many payloads as keys.
+	static void write(std::ostream& stream, const std::vector<Key>& keys, const std::vector<std::string>& payloads, ThreadPool& pool = ThreadPool::shared());
+
+	// Returns whether the file is an index file of any version or key type, judging by its start.
+	static bool is_index_file(const MappedFile& file) noexcept;
+
+	// Returns the number of keys.
+	size_t size() const noexcept { return key_count; }
+
+	// Returns the sorted keys, which are in the file's mapping.
+	const Key* keys() const noexcept { return sorted_keys; }
+
+	// Returns whether the keys have payloads.
+	bool has_payloads() const noexcept { return payload_offsets != nullptr; }
+
+	// Returns the position of the first key that is not less than the given key, or size() if none is.
+	size_t lower_bound(const Key& key) const noexcept;
+
+	// Returns the position of the first key that is greater than the given key, or size() if none is.
+	size_t upper_bound(const Key& key) const noexcept;
+
+	// Returns the position of the first key equal to the given key, or -1 if there is none.
+	std::int64_t find(const Key& key) const noexcept;
+
+	// Returns the positions of the first key that is not less than low and of the first key that
+	// is not less than high, so that the keys from low up to but not including high are between them.
+	std::pair<size_t, size_t> range(const Key& low, const Key& high) const noexcept;
+
+	// Returns the payload of the key at the position.
+	// Throws std::logic_error if the keys have no payloads, or std::out_of_range if the position is not valid.
+	std::string_view payload(size_t position) const;
+
+private:
+	MappedFile file;
+	const Key* sorted_keys = nullptr;
+	size_t key_count = 0;
+	const std::uint64_t* payload_offsets = nullptr;
+	const char* payload_bytes = nullptr;
+	const Key* fences = nullptr;
+	size_t fence_count = 0;
+
+	static constexpr std::uint64_t file_magic = 0x58444953;  // "SIDX"
+	static constexpr size_t header_size = 8;
+
+	// Returns the first position whose key is not less than (or if after_equal, greater than)
+	// the given key.
+	size_t bound(const Key& key, bool after_equal) const noexcept;
+
+	// Writes keys that are already sorted, and the payloads in the same order if there are any.
+	static void write_sorted(std::ostream& stream, const Key keys[], size_t count, const std::uint64_t offsets[], const char* bytes, size_t byte_count);
+
+	// Describes a type's size and kind, so that a file is not mapped with the wrong key type.
+	static constexpr std::uint64_t type_tag() noexcept
+	{
+		const std::uint64_t kind = std::is_floating_point_v<Key> ? 3 : std::is_signed_v<Key> ? 2 : std::is_integral_v<Key> ? 1 : 0;
+		return sizeof(Key) | kind << 32;
+	}
+
+	static constexpr std::uint64_t padded(std::uint64_t byte_count) noexcept
+	{
+		return (byte_count + 7) / 8 * 8;
+	}
+
+	static_assert(std::is_trivially_copyable_v<Key>, "SortedIndex requires a trivially copyable key type.");
+	static_assert(alignof(Key) <= 8, "SortedIndex requires keys aligned to at most 8 bytes.");
+};
+
+//////////////////////
+// SortedIndex<Key> //
+//////////////////////
+
+template <class Key>
+inline SortedIndex<Key>::SortedIndex(const std::string& path)
+	: file(path)
+{
+	std::uint64_t header[header_size];
+	if (!is_index_file(file) || file.size() < sizeof(header))
+		throw std::runtime_error(path + " does not hold a sorted index.");
+	std::memcpy(header, file.data(), sizeof(header));
+	if (header[1] != version)
+		throw std::runtime_error(path + " holds a sorted index of version " + std::to_string(header[1])
+			+ ", but this program reads version " + std::to_string(version) + ".");
+	if (header[2] != type_tag())
+		throw std::runtime_error(path + " holds a sorted index with a different key type.");
+	const std::uint64_t count = header[3];
+	const bool payloads = header[4] != 0;
+	const std::uint64_t byte_count = header[5];
+	const std::uint64_t stride = header[6];
+	const std::uint64_t fence_total = header[7];
+	if (count > file.size() / sizeof(Key) || byte_count > file.size() || stride == 0
+		|| fence_total != (count + stride - 1) / stride)
+		throw std::runtime_error(path + " does not hold a sorted index.");
+	if (stride != fence_stride)
+		throw std::runtime_error(path + " holds a sorted index with a different fence stride.");
+
+	const std::uint64_t keys_at = sizeof(header);
+	const std::uint64_t offsets_at = keys_at + padded(count * sizeof(Key));
+	const std::uint64_t bytes_at = offsets_at + (payloads ? (count + 1) * sizeof(std::uint64_t) : 0);
+	const std::uint64_t fences_at = bytes_at + (payloads ? padded(byte_count) : 0);
+	if (fences_at + padded(fence_total * sizeof(Key)) != file.size())
+		throw std::runtime_error(path + " does not hold a sorted index.");
+	const char* data = file.data();
+	sorted_keys = reinterpret_cast<const Key*>(data + keys_at);
+	key_count = size_t(count);
+	if (payloads)
+	{
+		payload_offsets = reinterpret_cast<const std::uint64_t*>(data + offsets_at);
+		payload_bytes = data + bytes_at;
+		if (payload_offsets[0] != 0 || payload_offsets[count] != byte_count)
+			throw std::runtime_error(path + " does not hold a sorted index.");
+	}
+	fences = reinterpret_cast<const Key*>(data + fences_at);
+	fence_count = size_t(fence_total);
+}
+
+template <class Key>
+inline void SortedIndex<Key>::write(std::ostream& stream, std::vector<Key> keys, ThreadPool& pool)
+{
+	parallel_sort(keys.data(), keys.size(), pool, [](Key* run, int run_size) { std::sort(run, run + run_size); }, std::greater<Key>());
+	write_sorted(stream, keys.data(), keys.size(), nullptr, nullptr, 0);
+}
+
+template <class Key>
+inline void SortedIndex<Key>::write(std::ostream& stream, const std::vector<Key>& keys, const std::vector<std::string>& payloads, ThreadPool& pool)
+{
+	if (payloads.size() != keys.size())
+		throw std::invalid_argument("There must be one payload per key.");
+	// Sort the keys with their original positions, which orders equal keys by position.
+	std::vector<std::pair<Key, size_t>> sorted(keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+		sorted[i] = { keys[i], i };
+	using Pair = std::pair<Key, size_t>;
+	parallel_sort(sorted.data(), sorted.size(), pool, [](Pair* run, int run_size) { std::sort(run, run + run_size); }, std::greater<Pair>());
+
+	std::vector<Key> sorted_keys(keys.size());
+	std::vector<std::uint64_t> offsets(keys.size() + 1, 0);
+	std::string bytes;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		sorted_keys[i] = sorted[i].first;
+		bytes += payloads[sorted[i].second];
+		offsets[i + 1] = bytes.size();
+	}
+	write_sorted(stream, sorted_keys.data(), sorted_keys.size(), offsets.data(), bytes.data(), bytes.size());
+}
+
+template <class Key>
+inline bool SortedIndex<Key>::is_index_file(const MappedFile& file) noexcept
+{
+	std::uint64_t magic;
+	if (file.size() < sizeof(magic))
+		return false;
+	std::memcpy(&magic, file.data(), sizeof(magic));
+	return magic == file_magic;
+}
+
+template <class Key>
+inline size_t SortedIndex<Key>::lower_bound(const Key& key) const noexcept
+{
+	return bound(key, false);
+}
+
+template <class Key>
+inline size_t SortedIndex<Key>::upper_bound(const Key& key) const noexcept
+{
+	return bound(key, true);
+}
+
+template <class Key>
+inline std::int64_t SortedIndex<Key>::find(const Key& key) const noexcept
+{
+	const size_t position = bound(key, false);
+	if (position == key_count || key < sorted_keys[position])
+		return -1;
+	return std::int64_t(position);
+}
+
+template <class Key>
+inline std::pair<size_t, size_t> SortedIndex<Key>::range(const Key& low, const Key& high) const noexcept
+{
+	const size_t first = bound(low, false);
+	if (!(low < high))
+		return { first, first };
+	// The end is usually near the start, so gallop forward from it before searching.
+	size_t last = first;
+	size_t step = 1;
+	while (last + step <= key_count && sorted_keys[last + step - 1] < high)
+	{
+		last += step;
+		step *= 2;
+	}
+	const size_t end = std::min(last + step, key_count);
+	return { first, size_t(std::lower_bound(sorted_keys + last, sorted_keys + end, high) - sorted_keys) };
+}
+
+template <class Key>
+inline std::string_view SortedIndex<Key>::payload(size_t position) const
+{
+	if (!has_payloads())
+		throw std::logic_error("The index has no payloads.");
+	if (position >= key_count)
+		throw std::out_of_range("The position is not in the index.");
+	return std::string_view(payload_bytes + payload_offsets[position], size_t(payload_offsets[position + 1] - payload_offsets[position]));
+}
+
+template <class Key>
+inline size_t SortedIndex<Key>::bound(const Key& key, bool after_equal) const noexcept
+{
+	// Every fence is the first key of its block. The answer is after the block of the last
+	// fence that is before it, and no later than the next fence.
+	auto is_before = [after_equal](const Key& item, const Key& value) { return after_equal ? !(value < item) : item < value; };
+	const size_t fence = size_t(std::partition_point(fences, fences + fence_count, [&](const Key& item) { return is_before(item, key); }) - fences);
+	if (fence == 0)
+		return 0;
+	const size_t first = (fence - 1) * fence_stride;
+	const size_t last = std::min(fence * fence_stride, key_count);
+	return size_t(std::partition_point(sorted_keys + first, sorted_keys + last, [&](const Key& item) { return is_before(item, key); }) - sorted_keys);
+}
+
+template <class Key>
+inline void SortedIndex<Key>::write_sorted(std::ostream& stream, const Key keys[], size_t count, const std::uint64_t offsets[], const char* bytes, size_t byte_count)
+{
+	const size_t fence_total = (count + fence_stride - 1) / fence_stride;
+	const std::uint64_t header[header_size] = { file_magic, version, type_tag(), count, offsets != nullptr, byte_count, fence_stride, fence_total };
+	stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	const char padding[8] = {};
+	auto write_padded = [&](const void* data, std::uint64_t size)
+	{
+		stream.write(static_cast<const char*>(data), std::streamsize(size));
+		stream.write(padding, std::streamsize(padded(size) - size));
+	};
+	write_padded(keys, count * sizeof(Key));
+	if (offsets != nullptr)
+	{
+		write_padded(offsets, (count + 1) * sizeof(std::uint64_t));
+		write_padded(bytes, byte_count);
+	}
+	std::vector<Key> fence_keys(fence_total);
+	for (size_t i = 0; i < fence_total; i++)
+		fence_keys[i] = keys[i * fence_stride];
+	write_padded(fence_keys.data(), fence_total * sizeof(Key));
+	if (!stream)
+		throw std::runtime_error("Unable to write the sorted index.");
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads for running fork-join style parallel loops.
+class ThreadPool
+{
+public:
+	// Starts thread_count worker threads. The calling thread of run also does work,
+	// so a pool with 0 threads runs everything serially.
+	explicit ThreadPool(size_t thread_count = default_thread_count());
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool();
+
+	// Calls f(i) for each i in [0, task_count) using the pool's threads and the
+	// calling thread, and returns once every call has finished.
+	// Rethrows the first exception thrown by f, after which remaining tasks are skipped.
+	// Calls from inside one of this pool's own tasks run serially instead of deadlocking.
+	template <class Function>
+	void run(size_t task_count, Function f);
+
+	// Returns the number of threads that can work on tasks at once, including the calling thread.
+	size_t concurrency() const noexcept;
+
+	// Returns a pool shared by the whole process, sized to the hardware.
+	static ThreadPool& shared();
+
+	// Returns one less than the number of hardware threads, since the calling thread also works.
+	static size_t default_thread_count() noexcept;
+
+private:
+	void work();
+	void execute();
+
+	std::vector<std::thread> threads;
+	std::mutex run_mutex;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	const std::function<void(size_t)>* job = nullptr;
+	size_t job_size = 0;
+	std::atomic<size_t> next_task{ 0 };
+	size_t busy_workers = 0;
+	size_t generation = 0;
+	bool stopping = false;
+	std::exception_ptr error;
+
+	static ThreadPool*& current_pool() noexcept;
+};
+
+inline ThreadPool::ThreadPool(size_t thread_count)
+{
+	threads.reserve(thread_count);
+	for (size_t i = 0; i < thread_count; i++)
+		threads.emplace_back([this] { work(); });
+}
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+template <class Function>
+inline void ThreadPool::run(size_t task_count, Function f)
+{
+	if (task_count == 0)
+		return;
+	if (threads.empty() || task_count == 1 || current_pool() == this)
+	{
+		for (size_t i = 0; i < task_count; i++)
+			f(i);
+		return;
+	}
+	std::lock_guard<std::mutex> run_lock(run_mutex);
+	const std::function<void(size_t)> task = [&f](size_t i) { f(i); };
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &task;
+		job_size = task_count;
+		next_task = 0;
+		busy_workers = threads.size();
+		error = nullptr;
+		generation += 1;
+	}
+	wake.notify_all();
+
+	ThreadPool* previous_pool = current_pool();
+	current_pool() = this;
+	execute();
+	current_pool() = previous_pool;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [this] { return busy_workers == 0; });
+	job = nullptr;
+	if (error)
+		std::rethrow_exception(error);
+}
+
+inline size_t ThreadPool::concurrency() const noexcept
+{
+	return threads.size() + 1;
+}
+
+inline ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+inline size_t ThreadPool::default_thread_count() noexcept
+{
+	const unsigned hardware_threads = std::thread::hardware_concurrency();
+	return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+inline void ThreadPool::work()
+{
+	current_pool() = this;
+	size_t seen_generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seen_generation; });
+			if (stopping)
+				return;
+			seen_generation = generation;
+		}
+		execute();
+		std::lock_guard<std::mutex> lock(mutex);
+		busy_workers -= 1;
+		if (busy_workers == 0)
+			done.notify_one();
+	}
+}
+
+inline void ThreadPool::execute()
+{
+	for (size_t i = next_task++; i < job_size; i = next_task++)
+	{
+		try
+		{
+			(*job)(i);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error)
+				error = std::current_exception();
+			next_task = job_size;
+		}
+	}
+}
+
+inline ThreadPool*& ThreadPool::current_pool() noexcept
+{
+	thread_local ThreadPool* pool = nullptr;
+	return pool;
+}
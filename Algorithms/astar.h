@@ -0,0 +1,215 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "dijkstra.h"
+#include "PriorityQueues.h"
+
+namespace Dijkstra
+{
+	// Finds the shortest path between two vertexes of a CSR graph given by their IDs with A* search,
+	// which expands the vertexes in order of their cost so far plus the heuristic's estimate of their
+	// remaining cost, so that it heads toward end instead of searching in every direction.
+	// heuristic(vertex, end) must never overestimate the cost from vertex to end, and must be
+	// consistent: for each edge from u to v, heuristic(u, end) <= its cost + heuristic(v, end).
+	// It may return unreachable_cost<Cost>() for vertexes that cannot reach end.
+	// A heuristic that always returns 0 makes this the same as dijkstra_ids.
+	// Returns the shortest path's vertex IDs and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Heuristic, class Name, class Cost>
+	Path<typename CsrGraph<Name, Cost>::VertexId, Cost> astar_ids(
+		const CsrGraph<Name, Cost>& graph,
+		typename CsrGraph<Name, Cost>::VertexId start,
+		typename CsrGraph<Name, Cost>::VertexId end,
+		const Heuristic& heuristic)
+	{
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+		if (start >= graph.vertex_count() || end >= graph.vertex_count())
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		const Cost unreached = unreachable_cost<Cost>();
+		std::vector<Cost> costs(graph.vertex_count(), unreached);
+		std::vector<Cost> estimates(graph.vertex_count(), unreached);  // Each reached vertex's heuristic.
+		std::vector<VertexId> previous(graph.vertex_count(), start);
+		LazyBinaryHeap<Cost> queue(graph.vertex_count());
+		costs[start] = 0;
+		estimates[start] = heuristic(start, end);
+		if (estimates[start] == unreached)
+			throw std::invalid_argument("No path found.");
+		queue.push(start, estimates[start]);
+		while (!queue.empty())
+		{
+			const auto [priority, vertex] = queue.pop();
+			const Cost cost = costs[vertex];
+			if (priority > cost + estimates[vertex])
+				continue;  // A cheaper entry for this vertex was already expanded.
+			if (vertex == end)
+				return Path<VertexId, Cost>(trace_path(previous, start, end), cost);
+			for (auto e = graph.first_edge(vertex); e < graph.last_edge(vertex); e++)
+			{
+				const VertexId neighbor = graph.target(e);
+				const Cost neighbor_cost = cost + graph.weight(e);
+				if (neighbor_cost >= costs[neighbor])
+					continue;
+				if (costs[neighbor] == unreached)
+				{
+					estimates[neighbor] = heuristic(neighbor, end);
+					if (estimates[neighbor] == unreached)
+						continue;  // The neighbor cannot reach end, so it is not worth queueing.
+				}
+				costs[neighbor] = neighbor_cost;
+				previous[neighbor] = vertex;
+				queue.push(neighbor, neighbor_cost + estimates[neighbor]);
+			}
+		}
+		throw std::invalid_argument("No path found.");
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph with A* search.
+	// See astar_ids for the heuristic's requirements.
+	// Returns the shortest path's vertex names and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Heuristic, class Name, class Cost>
+	Path<Name, Cost> astar(const CsrGraph<Name, Cost>& graph, const Name& start, const Name& end, const Heuristic& heuristic)
+	{
+		const auto [start_id, end_id] = find_ids(graph, start, end);
+		return to_names(graph, astar_ids(graph, start_id, end_id, heuristic));
+	}
+
+	// An A* heuristic of the straight line distance between vertexes with planar coordinates.
+	// cost_per_unit must be at most the smallest ratio of any edge's cost to its length, so that
+	// the estimate never exceeds the real cost. Integer estimates are rounded down.
+	template <class Cost>
+	class EuclideanHeuristic
+	{
+	public:
+		// Takes each vertex's (x, y) coordinates, indexed by vertex ID.
+		EuclideanHeuristic(std::vector<std::pair<double, double>> coordinates, double cost_per_unit = 1)
+			: coordinates{ std::move(coordinates) }, cost_per_unit{ cost_per_unit } {}
+
+		template <class VertexId>
+		Cost operator()(VertexId vertex, VertexId target) const
+		{
+			const auto [x1, y1] = coordinates[vertex];
+			const auto [x2, y2] = coordinates[target];
+			return Cost(std::hypot(x1 - x2, y1 - y2) * cost_per_unit);
+		}
+
+	private:
+		std::vector<std::pair<double, double>> coordinates;
+		double cost_per_unit;
+	};
+
+	// An A* heuristic of the great circle distance between vertexes with latitudes and longitudes,
+	// in meters by default. cost_per_meter must be at most the smallest ratio of any edge's cost to
+	// its length in meters, so that the estimate never exceeds the real cost. Integer estimates are
+	// rounded down.
+	template <class Cost>
+	class HaversineHeuristic
+	{
+	public:
+		// The mean radius of the Earth, in meters.
+		static constexpr double earth_radius = 6371008.8;
+
+		// Takes each vertex's (latitude, longitude) in degrees, indexed by vertex ID.
+		HaversineHeuristic(std::vector<std::pair<double, double>> coordinates, double cost_per_meter = 1)
+			: cost_per_meter{ cost_per_meter }
+		{
+			const double radians_per_degree = std::acos(-1.0) / 180;
+			for (const auto& [latitude, longitude] : coordinates)
+				radians.push_back({ latitude * radians_per_degree, longitude * radians_per_degree });
+		}
+
+		template <class VertexId>
+		Cost operator()(VertexId vertex, VertexId target) const
+		{
+			const auto [latitude1, longitude1] = radians[vertex];
+			const auto [latitude2, longitude2] = radians[target];
+			const double a = std::pow(std::sin((latitude2 - latitude1) / 2), 2)
+				+ std::cos(latitude1) * std::cos(latitude2) * std::pow(std::sin((longitude2 - longitude1) / 2), 2);
+			// Shrink the result slightly so that rounding errors cannot make it an overestimate.
+			const double meters = 2 * earth_radius * std::asin(std::min(1.0, std::sqrt(a))) * (1 - 1e-9);
+			return Cost(meters * cost_per_meter);
+		}
+
+	private:
+		std::vector<std::pair<double, double>> radians;
+		double cost_per_meter;
+	};
+
+	// The ALT (A*, landmarks, and the triangle inequality) heuristic. It precomputes the costs
+	// from and to a few landmark vertexes chosen far apart, and then bounds the cost from any vertex
+	// v to a target t from below with the triangle inequality: for each landmark L,
+	// cost(v, t) >= cost(L, t) - cost(L, v) and cost(v, t) >= cost(v, L) - cost(t, L).
+	// It works on any graph without coordinates, and uses 2 costs per vertex per landmark.
+	template <class Name, class Cost>
+	class LandmarkHeuristic
+	{
+	public:
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+
+		// Chooses up to landmark_count landmarks, each as far as possible from the ones
+		// already chosen, and computes their costs, taking landmark_count * 2 searches.
+		LandmarkHeuristic(const CsrGraph<Name, Cost>& graph, size_t landmark_count)
+		{
+			if (graph.vertex_count() == 0)
+				return;
+			const CsrGraph<Name, Cost> reverse = graph.reversed();
+			// The cost from the nearest landmark to each vertex.
+			std::vector<Cost> nearest(graph.vertex_count(), unreached);
+			VertexId landmark = 0;
+			for (size_t i = 0; i < landmark_count; i++)
+			{
+				landmarks.push_back(landmark);
+				from_landmarks.push_back(shortest_path_tree_ids(graph, landmark).costs);
+				to_landmarks.push_back(shortest_path_tree_ids(reverse, landmark).costs);
+				for (VertexId v = 0; v < graph.vertex_count(); v++)
+					nearest[v] = std::min(nearest[v], from_landmarks.back()[v]);
+				nearest[landmark] = 0;
+				const auto farthest = std::max_element(nearest.begin(), nearest.end());
+				if (*farthest == 0)
+					break;  // Every vertex is a landmark.
+				landmark = VertexId(farthest - nearest.begin());
+			}
+		}
+
+		const std::vector<VertexId>& landmark_ids() const noexcept { return landmarks; }
+
+		Cost operator()(VertexId vertex, VertexId target) const
+		{
+			Cost bound = 0;
+			for (size_t i = 0; i < landmarks.size(); i++)
+			{
+				const std::vector<Cost>& from = from_landmarks[i];
+				const std::vector<Cost>& to = to_landmarks[i];
+				// If a landmark reaches the vertex but not the target, the vertex cannot reach the
+				// target either, and likewise if the target reaches a landmark but the vertex does not.
+				if (from[vertex] != unreached)
+				{
+					if (from[target] == unreached)
+						return unreached;
+					if (from[target] > from[vertex])
+						bound = std::max(bound, Cost(from[target] - from[vertex]));
+				}
+				if (to[target] != unreached)
+				{
+					if (to[vertex] == unreached)
+						return unreached;
+					if (to[vertex] > to[target])
+						bound = std::max(bound, Cost(to[vertex] - to[target]));
+				}
+			}
+			return bound;
+		}
+
+	private:
+		static constexpr Cost unreached = unreachable_cost<Cost>();
+		std::vector<VertexId> landmarks;
+		std::vector<std::vector<Cost>> from_landmarks;
+		std::vector<std::vector<Cost>> to_landmarks;
+	};
+}
@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "command_line.h"
+#include "MappedFile.h"
+#include "number_text.h"
+#include "parallel_sort.h"
+#include "smart_sort.h"
+#include "SortedIndex.h"
+#include "sorting.h"
+#include "ThreadPool.h"
+#include "tracing.h"
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+static const char usage[] =
+	"usage: algorithms sort --input=<path> [--output=<path>] [--format=<type>] [--algo=<sort>] [--threads=<n>] [--text] [--trace=<path>]\n"
+	"       algorithms search --index=<path> --input=<path> [--output=<path>] [--format=<type>] [--algo=linear|binary] [--threads=<n>] [--text] [--trace=<path>]\n"
+	"       algorithms index --input=<path> --output=<path>.sidx [--format=<type>] [--threads=<n>] [--text] [--trace=<path>]\n"
+	"types: i32 i64 u32 u64 f32 f64\n"
+	"sorts: bubble selection insertion shell quick merge heap std smart\n"
+	"A path of - means the standard input or output. search reads an --index path ending in .sidx as a sorted index file.\n";
+
+// The extension that marks sorted index files, so that search never mistakes an array of
+// numbers for one because of its first bytes.
+static const std::string index_extension = ".sidx";
+
+static bool has_index_extension(const std::string& path)
+{
+	return path.size() >= index_extension.size() && path.compare(path.size() - index_extension.size(), index_extension.size(), index_extension) == 0;
+}
+
+// The options of a command. Bad options throw std::invalid_argument.
+struct Options
+{
+	std::string command;
+	std::string input;
+	std::string output;
+	std::string index;
+	std::string format = "u64";
+	std::string algo;
+	std::string trace;
+	size_t threads = 1;
+	bool text = false;
+};
+
+// The items of an input file. A binary file is used in place through a memory mapping, and
+// text or the standard input is read into memory.
+template <class T>
+struct InputItems
+{
+	std::optional<MappedFile> file;
+	std::vector<T> copy;
+	const T* items = nullptr;
+	size_t size = 0;
+};
+
+static Options parse_options(int argc, const char* const argv[])
+{
+	if (argc < 2)
+		throw std::invalid_argument("Missing command.");
+	Options options;
+	options.command = argv[1];
+	if (options.command != "sort" && options.command != "search" && options.command != "index")
+		throw std::invalid_argument("Unknown command: " + options.command);
+	options.algo = options.command == "sort" ? "quick" : "binary";
+	for (int i = 2; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		const size_t equals = arg.find('=');
+		const std::string name = arg.substr(0, equals);
+		const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+		if (name == "--text" && equals == std::string::npos)
+			options.text = true;
+		else if (equals == std::string::npos || value.empty())
+			throw std::invalid_argument("Unknown option or missing value: " + arg);
+		else if (name == "--input")
+			options.input = value;
+		else if (name == "--output")
+			options.output = value;
+		else if (name == "--index" && options.command == "search")
+			options.index = value;
+		else if (name == "--format")
+			options.format = value;
+		else if (name == "--algo" && options.command != "index")
+			options.algo = value;
+		else if (name == "--trace")
+			options.trace = value;
+		else if (name == "--threads")
+		{
+			const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), options.threads);
+			if (error != std::errc() || end != value.data() + value.size() || options.threads == 0)
+				throw std::invalid_argument("The thread count must be a positive integer.");
+		}
+		else
+			throw std::invalid_argument("Unknown option: " + arg);
+	}
+
+	static const char* const formats[] = { "i32", "i64", "u32", "u64", "f32", "f64" };
+	static const char* const sorts[] = { "bubble", "selection", "insertion", "shell", "quick", "merge", "heap", "std", "smart" };
+	static const char* const searches[] = { "linear", "binary" };
+	auto is_one_of = [](const std::string& value, const auto& names)
+	{
+		return std::any_of(std::begin(names), std::end(names), [&](const char* name) { return value == name; });
+	};
+	if (!is_one_of(options.format, formats))
+		throw std::invalid_argument("Unknown format: " + options.format);
+	if (options.command == "sort" ? !is_one_of(options.algo, sorts) : options.command == "search" && !is_one_of(options.algo, searches))
+		throw std::invalid_argument("Unknown algorithm: " + options.algo);
+	if (options.input.empty())
+		throw std::invalid_argument("Missing --input.");
+	if (options.command == "search" && options.index.empty())
+		throw std::invalid_argument("Missing --index.");
+	if (options.input == "-" && options.index == "-")
+		throw std::invalid_argument("Only one of --input and --index can be the standard input.");
+	if (options.command == "index" && (options.output.empty() || options.output == "-"))
+		throw std::invalid_argument("The index needs an --output file.");
+	if (options.command == "index" && !has_index_extension(options.output))
+		throw std::invalid_argument("The index's --output file name must end in " + index_extension + ".");
+	if (!options.trace.empty() && !Tracing::enabled)
+		throw std::invalid_argument("--trace needs a build with ALGORITHMS_TRACING defined.");
+	return options;
+}
+
+// Returns the most memory the process has had resident at once, in bytes, or 0 if it is unknown.
+static size_t peak_memory_use()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters))
+		return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss);
+#else
+	return size_t(usage.ru_maxrss) * 1024;  // Linux reports kilobytes.
+#endif
+#endif
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Reports one step's time and throughput.
+static void report_step(std::ostream& report, const char* step, double seconds, size_t item_count, size_t byte_count)
+{
+	char line[128];
+	const double rate = seconds > 0 ? 1 / seconds : 0;
+	std::snprintf(line, sizeof line, "%-7s %10.3f s %10.1f MB/s %10.2f M items/s\n",
+		step, seconds, byte_count * rate / 1e6, item_count * rate / 1e6);
+	report << line;
+}
+
+// Reads all of a standard stream.
+static std::string read_all(std::FILE* stream)
+{
+	std::string bytes;
+	char buffer[1 << 16];
+	size_t count;
+	while ((count = std::fread(buffer, 1, sizeof buffer, stream)) > 0)
+		bytes.append(buffer, count);
+	if (std::ferror(stream))
+		throw std::runtime_error("Unable to read the standard input.");
+	return bytes;
+}
+
+// Reads a file of items, or the standard input if the path is -. Text is parsed in parallel on
+// the pool's threads, and text from the standard input is parsed a block at a time as it comes.
+// Throws std::runtime_error if it cannot be read or is not in the format.
+template <class T>
+static InputItems<T> read_items(const std::string& path, bool text, ThreadPool& pool)
+{
+	InputItems<T> input;
+	if (text && path == "-")
+	{
+		try
+		{
+			input.copy = read_numbers<T>(stdin, pool);
+		}
+		catch (const NumberFormatError& error)
+		{
+			throw std::runtime_error(std::string("The standard input: ") + error.what());
+		}
+	}
+	else if (text)
+		input.copy = read_numbers<T>(path, pool);
+	else if (path == "-")
+	{
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+		const std::string bytes = read_all(stdin);
+		if (bytes.size() % sizeof(T) != 0)
+			throw std::runtime_error("The standard input does not hold a whole number of items of the format.");
+		input.copy.resize(bytes.size() / sizeof(T));
+		std::memcpy(input.copy.data(), bytes.data(), bytes.size());
+	}
+	else
+	{
+		input.file.emplace(path);
+		if (input.file->size() % sizeof(T) != 0)
+			throw std::runtime_error(path + " does not hold a whole number of items of the format.");
+		// Mappings are page-aligned, so the items can be read in place.
+		input.items = reinterpret_cast<const T*>(input.file->data());
+		input.size = input.file->size() / sizeof(T);
+		return input;
+	}
+	input.items = input.copy.data();
+	input.size = input.copy.size();
+	return input;
+}
+
+// Writes items to a file, or the standard output if the path is -. Text is formatted in
+// parallel on the pool's threads.
+// Throws std::runtime_error if it cannot be written.
+template <class T>
+static void write_items(const T* items, size_t size, const std::string& path, bool text, ThreadPool& pool)
+{
+	std::FILE* file = stdout;
+	if (path != "-")
+		file = std::fopen(path.c_str(), "wb");
+#ifdef _WIN32
+	else if (!text)
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	if (!file)
+		throw std::runtime_error("Unable to open " + path);
+
+	bool written = true;
+	if (!text)
+		written = std::fwrite(items, sizeof(T), size, file) == size;
+	else
+	{
+		try
+		{
+			write_numbers(file, items, size, pool);
+		}
+		catch (const std::runtime_error&)
+		{
+			written = false;
+		}
+	}
+	written = (file == stdout ? std::fflush(file) : std::fclose(file)) == 0 && written;
+	if (!written)
+		throw std::runtime_error("Unable to write " + path);
+}
+
+template <class T>
+static void sort_items(T items[], size_t size, const std::string& algo, ThreadPool& pool, std::ostream& report)
+{
+	if (algo == "smart")
+	{
+		for (const std::string& reason : smart_sort(items, size, pool).reasons)
+			report << "  " << reason << "\n";
+		return;
+	}
+	auto sort_with = [&](auto sort_run) { parallel_sort(items, size, pool, sort_run); };
+	if (algo == "bubble")
+		sort_with([](T* run, int run_size) { bubble_sort(run, run_size); });
+	else if (algo == "selection")
+		sort_with([](T* run, int run_size) { selection_sort(run, run_size); });
+	else if (algo == "insertion")
+		sort_with([](T* run, int run_size) { insertion_sort(run, run_size); });
+	else if (algo == "shell")
+		sort_with([](T* run, int run_size) { shell_sort(run, run_size); });
+	else if (algo == "quick")
+		sort_with([](T* run, int run_size) { quicksort(run, 0, run_size - 1); });
+	else if (algo == "merge")
+		sort_with([](T* run, int run_size) { merge_sort(run, 0, run_size - 1); });
+	else if (algo == "heap")
+		sort_with([](T* run, int run_size) { heap_sort(run, run_size); });
+	else
+		sort_with([](T* run, int run_size) { std::sort(run, run + run_size); });
+}
+
+template <class T>
+static void run_sort(const Options& options, ThreadPool& pool, std::ostream& report)
+{
+	auto start = std::chrono::steady_clock::now();
+	InputItems<T> input = read_items<T>(options.input, options.text, pool);
+	std::vector<T> items = input.file ? std::vector<T>(input.items, input.items + input.size) : std::move(input.copy);
+	input.file.reset();
+	report << "sort " << options.algo << " on " << pool.concurrency() << (pool.concurrency() == 1 ? " thread: " : " threads: ") << items.size() << " " << options.format << " items\n";
+	report_step(report, "read", seconds_since(start), items.size(), items.size() * sizeof(T));
+
+	start = std::chrono::steady_clock::now();
+	sort_items(items.data(), items.size(), options.algo, pool, report);
+	report_step(report, "sort", seconds_since(start), items.size(), items.size() * sizeof(T));
+
+	if (!options.output.empty())
+	{
+		start = std::chrono::steady_clock::now();
+		write_items(items.data(), items.size(), options.output, options.text, pool);
+		report_step(report, "write", seconds_since(start), items.size(), items.size() * sizeof(T));
+	}
+}
+
+template <class T>
+static void run_search(const Options& options, ThreadPool& pool, std::ostream& report)
+{
+	// A sorted index file, chosen by its extension, is searched in place with its fence table,
+	// and it is already sorted. Any other index is an array of items.
+	auto start = std::chrono::steady_clock::now();
+	std::optional<SortedIndex<T>> sorted_index;
+	InputItems<T> index;
+	if (has_index_extension(options.index))
+		sorted_index.emplace(options.index);
+	else
+		index = read_items<T>(options.index, options.text, pool);
+	const size_t index_size = sorted_index ? sorted_index->size() : index.size;
+	const InputItems<T> queries = read_items<T>(options.input, options.text, pool);
+	report << "search " << (sorted_index ? "index file" : options.algo) << " on " << pool.concurrency() << (pool.concurrency() == 1 ? " thread: " : " threads: ")
+		<< queries.size << " " << options.format << " items in an index of " << index_size << "\n";
+	report_step(report, "read", seconds_since(start), index_size + queries.size, (index_size + queries.size) * sizeof(T));
+	if (!sorted_index && index.size > size_t(INT_MAX))
+		throw std::runtime_error("The index has more than " + std::to_string(INT_MAX) + " items.");
+	if (!sorted_index && options.algo == "binary" && !std::is_sorted(index.items, index.items + index.size))
+		throw std::runtime_error("The index is not sorted.");
+
+	start = std::chrono::steady_clock::now();
+	std::vector<std::int64_t> positions(queries.size);
+	const size_t chunk_count = std::max<size_t>(1, std::min(pool.concurrency() * 4, queries.size / 1024));
+	const bool binary = options.algo == "binary";
+	pool.run(chunk_count, [&](size_t chunk)
+		{
+			const size_t last = queries.size * (chunk + 1) / chunk_count;
+			for (size_t i = queries.size * chunk / chunk_count; i < last; i++)
+				positions[i] = sorted_index ? sorted_index->find(queries.items[i])
+					: binary ? binary_search(index.items, int(index.size), queries.items[i])
+					: linear_search(index.items, int(index.size), queries.items[i]);
+		});
+	report_step(report, "search", seconds_since(start), queries.size, queries.size * sizeof(T));
+
+	if (!options.output.empty())
+	{
+		start = std::chrono::steady_clock::now();
+		write_items(positions.data(), positions.size(), options.output, options.text, pool);
+		report_step(report, "write", seconds_since(start), positions.size(), positions.size() * sizeof(std::int64_t));
+	}
+}
+
+template <class T>
+static void run_index(const Options& options, ThreadPool& pool, std::ostream& report)
+{
+	auto start = std::chrono::steady_clock::now();
+	InputItems<T> input = read_items<T>(options.input, options.text, pool);
+	std::vector<T> keys = input.file ? std::vector<T>(input.items, input.items + input.size) : std::move(input.copy);
+	input.file.reset();
+	report << "index on " << pool.concurrency() << (pool.concurrency() == 1 ? " thread: " : " threads: ") << keys.size() << " " << options.format << " items\n";
+	report_step(report, "read", seconds_since(start), keys.size(), keys.size() * sizeof(T));
+
+	start = std::chrono::steady_clock::now();
+	const size_t size = keys.size();
+	std::ofstream file(options.output, std::ios::binary);
+	if (!file)
+		throw std::runtime_error("Unable to open " + options.output);
+	SortedIndex<T>::write(file, std::move(keys), pool);
+	file.close();
+	if (!file)
+		throw std::runtime_error("Unable to write " + options.output);
+	report_step(report, "index", seconds_since(start), size, size * sizeof(T));
+}
+
+int run_command_line(int argc, const char* const argv[], std::ostream& report)
+{
+	Options options;
+	try
+	{
+		options = parse_options(argc, argv);
+	}
+	catch (const std::invalid_argument& error)
+	{
+		report << error.what() << "\n" << usage;
+		return 2;
+	}
+
+	try
+	{
+		ThreadPool pool(options.threads - 1);
+		Tracing::reset();
+		auto run = [&](auto item)
+		{
+			using T = decltype(item);
+			if (options.command == "sort")
+				run_sort<T>(options, pool, report);
+			else if (options.command == "search")
+				run_search<T>(options, pool, report);
+			else
+				run_index<T>(options, pool, report);
+		};
+		if (options.format == "i32")
+			run(std::int32_t());
+		else if (options.format == "i64")
+			run(std::int64_t());
+		else if (options.format == "u32")
+			run(std::uint32_t());
+		else if (options.format == "u64")
+			run(std::uint64_t());
+		else if (options.format == "f32")
+			run(float());
+		else
+			run(double());
+		char line[64];
+		std::snprintf(line, sizeof line, "peak memory %.1f MB\n", peak_memory_use() / 1e6);
+		report << line;
+		if (!options.trace.empty())
+		{
+			for (const Tracing::CounterTotal& counter : Tracing::counters())
+				report << counter.name << (counter.is_depth ? " (deepest) " : " ") << counter.value << "\n";
+			std::ofstream file(options.trace);
+			Tracing::write_chrome_trace(file);
+			file.close();
+			if (!file)
+				throw std::runtime_error("Unable to write " + options.trace);
+		}
+	}
+	catch (const std::exception& error)
+	{
+		report << error.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
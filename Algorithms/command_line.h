@@ -0,0 +1,27 @@
+#pragma once
+#include <iostream>
+
+// The batch mode of the driver, which sorts or searches files instead of showing the menus:
+//
+// algorithms sort --input=<path> [--output=<path>] [--format=<type>] [--algo=<sort>] [--threads=<n>] [--text] [--trace=<path>]
+// algorithms search --index=<path> --input=<path> [--output=<path>] [--format=<type>] [--algo=linear|binary] [--threads=<n>] [--text] [--trace=<path>]
+// algorithms index --input=<path> --output=<path>.sidx [--format=<type>] [--threads=<n>] [--text] [--trace=<path>]
+//
+// The files hold items of the format's type, which is one of i32, i64, u32, u64 (the default),
+// f32, or f64, either as a binary array in the machine's byte order or, with --text, as one
+// number per line. A path of - means the standard input or output. sort sorts the input with
+// bubble, selection, insertion, shell, quick (the default), merge, heap, or std (std::sort),
+// split into runs that are sorted and merged on the given number of threads, or with smart
+// (smart_sort in smart_sort.h), which reports the strategy it chose and why. search looks up
+// each item of the input in the index, which must be sorted, and outputs the position of each
+// as a 64-bit integer, or -1 if it is not in the index. index sorts the input once and writes it
+// to a sorted index file (see SortedIndex.h) whose name ends in .sidx. search maps an index
+// whose name ends in .sidx and searches it in place instead of reading and checking the whole
+// index each time, even with --text, and reads any other index as an array of items.
+// The time, throughput, and peak memory use of each step are reported to report. In a build
+// with ALGORITHMS_TRACING defined, --trace also reports the counters of tracing.h and writes
+// the trace to a file in the Chrome trace event format.
+
+// Runs the command in argv[1] with the options after it, and returns the exit code: 0 on
+// success, 1 if the command fails, and 2 if it is used incorrectly.
+int run_command_line(int argc, const char* const argv[], std::ostream& report = std::cerr);
@@ -0,0 +1,212 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "dijkstra.h"
+#include "ThreadPool.h"
+
+namespace Dijkstra
+{
+	// Finds the shortest paths from a vertex of a CSR graph, given by its ID, to every vertex
+	// with the delta-stepping algorithm, which relaxes many vertexes' edges in parallel.
+	// Vertexes are grouped into buckets of costs delta wide. The lowest bucket's vertexes relax
+	// their light edges (those costing at most delta) in parallel until the bucket stays empty,
+	// and then relax their heavy edges once. A delta of 0 picks the average edge cost.
+	// Smaller deltas do less redundant work and larger deltas give each step more parallelism.
+	// The costs are the same as dijkstra()'s. When there are several shortest paths to a vertex,
+	// the predecessor may differ from shortest_path_tree_ids()'s.
+	// Throws std::invalid_argument if the source is not in the graph or delta is negative.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	ShortestPathTree<typename CsrGraph<Name, Cost>::VertexId, Cost> delta_stepping_ids(
+		const CsrGraph<Name, Cost>& graph,
+		typename CsrGraph<Name, Cost>::VertexId source,
+		Cost delta = 0,
+		ThreadPool& pool = ThreadPool::shared())
+	{
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+		const VertexId n = graph.vertex_count();
+		if (source >= n)
+			throw std::invalid_argument("The source vertex must be in the graph.");
+		if (delta < 0)
+			throw std::invalid_argument("The bucket width cannot be negative.");
+		if (delta == 0)
+		{
+			long double total = 0;
+			for (Cost weight : graph.weights())
+				total += weight;
+			delta = graph.edge_count() ? Cost(total / graph.edge_count()) : Cost(1);
+			if (!(delta > 0))
+				delta = 1;
+		}
+		const Cost unreached = unreachable_cost<Cost>();
+		auto bucket_of = [&](Cost cost) { return size_t(cost / delta); };
+
+		// Splits [0, count) into chunks for the pool's threads and calls f(first, last, chunk).
+		auto for_each_chunk = [&](size_t count, size_t chunk_count, auto f)
+		{
+			pool.run(chunk_count, [&](size_t chunk)
+				{
+					f(count * chunk / chunk_count, count * (chunk + 1) / chunk_count, chunk);
+				});
+		};
+		auto chunk_count_for = [&](size_t count)
+		{
+			return std::max<size_t>(1, std::min(pool.concurrency() * 4, count / 256));
+		};
+
+		std::unique_ptr<std::atomic<Cost>[]> costs(new std::atomic<Cost>[n]);
+		for_each_chunk(n, chunk_count_for(n), [&](size_t first, size_t last, size_t)
+			{
+				for (size_t v = first; v < last; v++)
+					costs[v].store(unreached, std::memory_order_relaxed);
+			});
+		costs[source].store(0, std::memory_order_relaxed);
+
+		// Each chunk of a parallel step collects the vertexes whose costs it lowered, and then
+		// they are added to their buckets one chunk at a time.
+		std::map<size_t, std::vector<VertexId>> buckets;
+		buckets[0].push_back(source);
+		std::vector<std::vector<VertexId>> lowered(pool.concurrency() * 4);
+		std::vector<std::uint64_t> frontier_stamps(n, 0);  // The step that last added each vertex to a frontier.
+		std::uint64_t step = 0;
+
+		// Relaxes the light or heavy edges of the vertexes, in parallel.
+		auto relax = [&](const std::vector<VertexId>& vertexes, bool light)
+		{
+			const size_t chunk_count = chunk_count_for(vertexes.size());
+			for_each_chunk(vertexes.size(), chunk_count, [&](size_t first, size_t last, size_t chunk)
+				{
+					std::vector<VertexId>& out = lowered[chunk];
+					for (size_t i = first; i < last; i++)
+					{
+						const VertexId vertex = vertexes[i];
+						const Cost cost = costs[vertex].load(std::memory_order_relaxed);
+						for (auto e = graph.first_edge(vertex); e < graph.last_edge(vertex); e++)
+						{
+							const Cost weight = graph.weight(e);
+							if ((weight <= delta) != light)
+								continue;
+							const VertexId neighbor = graph.target(e);
+							const Cost neighbor_cost = cost + weight;
+							Cost old_cost = costs[neighbor].load(std::memory_order_relaxed);
+							while (neighbor_cost < old_cost)
+							{
+								if (costs[neighbor].compare_exchange_weak(old_cost, neighbor_cost, std::memory_order_relaxed))
+								{
+									out.push_back(neighbor);
+									break;
+								}
+							}
+						}
+					}
+				});
+			for (size_t chunk = 0; chunk < chunk_count; chunk++)
+			{
+				for (VertexId v : lowered[chunk])
+					buckets[bucket_of(costs[v].load(std::memory_order_relaxed))].push_back(v);
+				lowered[chunk].clear();
+			}
+		};
+
+		std::vector<VertexId> frontier;
+		std::vector<VertexId> settled;
+		while (!buckets.empty())
+		{
+			const size_t bucket = buckets.begin()->first;
+			settled.clear();
+			while (!buckets.empty() && buckets.begin()->first == bucket)
+			{
+				// Take the bucket's vertexes, skipping duplicates and vertexes whose costs have
+				// since dropped into a bucket that was already processed.
+				step += 1;
+				frontier.clear();
+				for (VertexId v : buckets.begin()->second)
+					if (frontier_stamps[v] != step && bucket_of(costs[v].load(std::memory_order_relaxed)) == bucket)
+					{
+						frontier_stamps[v] = step;
+						frontier.push_back(v);
+					}
+				buckets.erase(buckets.begin());
+				settled.insert(settled.end(), frontier.begin(), frontier.end());
+				relax(frontier, true);
+			}
+			std::sort(settled.begin(), settled.end());
+			settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+			relax(settled, false);
+		}
+
+		ShortestPathTree<VertexId, Cost> tree;
+		tree.source = source;
+		tree.costs.resize(n);
+		tree.previous.resize(n);
+		for_each_chunk(n, chunk_count_for(n), [&](size_t first, size_t last, size_t)
+			{
+				for (size_t v = first; v < last; v++)
+				{
+					tree.costs[v] = costs[v].load(std::memory_order_relaxed);
+					tree.previous[v] = VertexId(v);
+				}
+			});
+
+		// Every edge on a shortest path is tight: its cost is exactly the difference of its ends'
+		// costs. A parallel breadth-first search from the source over only the tight edges reaches
+		// every reachable vertex, and the edges it first reaches them by form a shortest path tree.
+		std::unique_ptr<std::atomic<bool>[]> found(new std::atomic<bool>[n]);
+		for_each_chunk(n, chunk_count_for(n), [&](size_t first, size_t last, size_t)
+			{
+				for (size_t v = first; v < last; v++)
+					found[v].store(v == source, std::memory_order_relaxed);
+			});
+		frontier.assign(1, source);
+		while (!frontier.empty())
+		{
+			const size_t chunk_count = chunk_count_for(frontier.size());
+			for_each_chunk(frontier.size(), chunk_count, [&](size_t first, size_t last, size_t chunk)
+				{
+					for (size_t i = first; i < last; i++)
+					{
+						const VertexId vertex = frontier[i];
+						for (auto e = graph.first_edge(vertex); e < graph.last_edge(vertex); e++)
+						{
+							const VertexId neighbor = graph.target(e);
+							if (tree.costs[vertex] + graph.weight(e) != tree.costs[neighbor] || found[neighbor].load(std::memory_order_relaxed))
+								continue;
+							if (!found[neighbor].exchange(true, std::memory_order_relaxed))
+							{
+								tree.previous[neighbor] = vertex;
+								lowered[chunk].push_back(neighbor);
+							}
+						}
+					}
+				});
+			frontier.clear();
+			for (size_t chunk = 0; chunk < chunk_count; chunk++)
+			{
+				frontier.insert(frontier.end(), lowered[chunk].begin(), lowered[chunk].end());
+				lowered[chunk].clear();
+			}
+		}
+		return tree;
+	}
+
+	// Finds the shortest paths from a vertex of a CSR graph to every vertex with the parallel
+	// delta-stepping algorithm. See delta_stepping_ids for details.
+	// The tree is indexed by vertex ID; use graph.id and graph.name to convert.
+	// Throws std::invalid_argument if the source is not in the graph or delta is negative.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	ShortestPathTree<typename CsrGraph<Name, Cost>::VertexId, Cost> delta_stepping(
+		const CsrGraph<Name, Cost>& graph, const Name& source, Cost delta = 0, ThreadPool& pool = ThreadPool::shared())
+	{
+		const auto source_id = graph.id(source);
+		if (!source_id)
+			throw std::invalid_argument("The source vertex must be in the graph.");
+		return delta_stepping_ids(graph, *source_id, delta, pool);
+	}
+}
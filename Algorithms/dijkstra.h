@@ -1,9 +1,24 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <optional>
 #include <queue>
-#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "MappedFile.h"
+#include "PriorityQueues.h"
+#include "ThreadPool.h"
+#include "tracing.h"
 
 namespace Dijkstra
 {
@@ -12,18 +27,16 @@ namespace Dijkstra
 	struct Node
 	{
 		Name name{};  // The node's identifier.
-		Cost cost{};  // The minimum cost/weight/distance to reach this node from the start node.
-		std::vector<Name> path;  // The names of the shortest path's nodes up to and NOT including this node.
+		Cost cost{};  // The cost/weight/distance of the edge to this node.
 		Node() {}
 		Node(Name name, Cost cost) : name{ name }, cost{ cost } {}
-		Node(Name name, Cost cost, std::vector<Name> path) : name{ name }, cost{ cost }, path{ path } {}
 	};
 
 	// A comparator that determines whether one node has a greater cost than another.
 	template <class Name, class Cost>
 	struct IsGreater
 	{
-		bool operator()(Node<Name, Cost> left, Node<Name, Cost> right)
+		bool operator()(const Node<Name, Cost>& left, const Node<Name, Cost>& right) const
 		{
 			return left.cost > right.cost;
 		}
@@ -46,37 +59,809 @@ namespace Dijkstra
 		Path(std::vector<Name> path, Cost cost) : path{ path }, cost{ cost } {}
 	};
 
+	// Returns the cost reported for vertexes that cannot be reached: infinity for floating point
+	// costs, or else the largest possible cost.
+	template <class Cost>
+	constexpr Cost unreachable_cost() noexcept
+	{
+		if constexpr (std::numeric_limits<Cost>::has_infinity)
+			return std::numeric_limits<Cost>::infinity();
+		else
+			return std::numeric_limits<Cost>::max();
+	}
+
 	// Finds the shortest path between two vertexes in a graph.
 	// Returns the shortest path's vertex names and total cost.
 	// Throws std::invalid_argument if there is no valid path.
 	// Each edge must have a nonnegative cost.
 	template <class Name, class Cost>
-	Path<Name, Cost> dijkstra(GraphMap<Name, Cost> graph, Name start, Name end)
+	Path<Name, Cost> dijkstra(const GraphMap<Name, Cost>& graph, const Name& start, const Name& end)
 	{
-		MinHeap<Name, Cost> min_heap{};
-		min_heap.push(Node<Name, Cost>(start, 0));
-		std::set<Name> visited_nodes;
+		// The search's progress at each vertex it has reached. The heap and the predecessor links
+		// point into this map, whose elements never move, so names are neither copied nor looked up again.
+		struct Visit;
+		using Vertex = std::pair<const Name, Visit>;
+		struct Visit
+		{
+			Cost cost{};
+			Vertex* previous = nullptr;
+			bool done = false;
+		};
+		std::map<Name, Visit> visits;
+		using Entry = std::pair<Cost, Vertex*>;
+		auto is_greater = [](const Entry& left, const Entry& right) { return left.first > right.first; };
+		std::priority_queue<Entry, std::vector<Entry>, decltype(is_greater)> min_heap(is_greater);
+		ALGORITHMS_TRACE_SCOPE("dijkstra");
+		min_heap.push({ Cost{}, &*visits.try_emplace(start).first });
+		ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
 		while (min_heap.size())
 		{
-			Node<Name, Cost> closest_node = min_heap.top();
+			const auto [cost, vertex] = min_heap.top();
 			min_heap.pop();
-			visited_nodes.insert(closest_node.name);
-			if (closest_node.name == end)
+			ALGORITHMS_TRACE_COUNT("dijkstra pops", 1);
+			Visit& visit = vertex->second;
+			if (visit.done || cost > visit.cost)
+				continue;  // This is a stale entry for a vertex that was already expanded.
+			visit.done = true;
+			if (vertex->first == end)
 			{
-				Path<Name, Cost> result(closest_node.path, closest_node.cost);
-				result.path.push_back(closest_node.name);
-				return result;
+				std::vector<Name> path;
+				for (const Vertex* v = vertex; v != nullptr; v = v->second.previous)
+					path.push_back(v->first);
+				std::reverse(path.begin(), path.end());
+				return Path<Name, Cost>(path, cost);
 			}
-			for (Node<Name, Cost>& neighbor : graph[closest_node.name])
+			auto neighbors = graph.find(vertex->first);
+			if (neighbors == graph.end())
+				continue;
+			ALGORITHMS_TRACE_COUNT("dijkstra relaxations", neighbors->second.size());
+			for (const Node<Name, Cost>& neighbor : neighbors->second)
 			{
-				if (visited_nodes.count(neighbor.name) != 0)
-					continue;
-				neighbor.cost += closest_node.cost;
-				neighbor.path = closest_node.path;
-				neighbor.path.push_back(closest_node.name);
-				min_heap.push(neighbor);
+				const Cost neighbor_cost = cost + neighbor.cost;
+				auto [it, inserted] = visits.try_emplace(neighbor.name, Visit{ neighbor_cost, vertex });
+				Visit& neighbor_visit = it->second;
+				if (!inserted)
+				{
+					if (neighbor_visit.done || neighbor_cost >= neighbor_visit.cost)
+						continue;
+					neighbor_visit.cost = neighbor_cost;
+					neighbor_visit.previous = vertex;
+				}
+				min_heap.push({ neighbor_cost, &*it });
+				ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
 			}
 		}
 		throw std::invalid_argument("No path found.");
 	}
+
+	// A read-only view of a contiguous array owned by something else.
+	template <class T>
+	class ArrayView
+	{
+	public:
+		ArrayView() {}
+		ArrayView(const T* data, size_t size) : first{ data }, count{ size } {}
+
+		const T* data() const noexcept { return first; }
+		size_t size() const noexcept { return count; }
+		bool empty() const noexcept { return count == 0; }
+		const T* begin() const noexcept { return first; }
+		const T* end() const noexcept { return first + count; }
+		const T& operator[](size_t index) const noexcept { return first[index]; }
+		const T& front() const noexcept { return first[0]; }
+		const T& back() const noexcept { return first[count - 1]; }
+
+	private:
+		const T* first = nullptr;
+		size_t count = 0;
+	};
+
+	// A graph stored in compressed sparse row (CSR) form. The vertexes have dense IDs from 0 to
+	// vertex_count() - 1, numbered in ascending order of their names, and the edges leaving
+	// vertex v are the edges from first_edge(v) up to but not including last_edge(v).
+	// Each edge's target and weight are kept in their own contiguous array.
+	// A graph never changes once built, so copies share its arrays, and a graph can also be
+	// a zero-copy view of a memory-mapped file written by write.
+	template <class Name, class Cost>
+	class CsrGraph
+	{
+	public:
+		using VertexId = std::uint32_t;
+		using EdgeIndex = std::uint64_t;
+
+		// An edge between two vertexes given by their IDs, for building a graph.
+		struct Edge
+		{
+			VertexId source{};
+			VertexId target{};
+			Cost weight{};
+		};
+
+		CsrGraph()
+		{
+			adopt({}, { 0 }, {}, {});
+		}
+
+		// Converts a graph map. Vertexes that only appear as neighbors are included too.
+		explicit CsrGraph(const GraphMap<Name, Cost>& graph)
+		{
+			std::vector<Name> names;
+			for (const auto& [name, neighbors] : graph)
+			{
+				names.push_back(name);
+				for (const Node<Name, Cost>& neighbor : neighbors)
+					names.push_back(neighbor.name);
+			}
+			std::sort(names.begin(), names.end());
+			names.erase(std::unique(names.begin(), names.end()), names.end());
+			check_vertex_count(names.size());
+			auto id_of = [&](const Name& name) { return VertexId(std::lower_bound(names.begin(), names.end(), name) - names.begin()); };
+
+			// The map is sorted by name, so its vertexes' edges can be written in ID order directly.
+			std::vector<EdgeIndex> offsets(names.size() + 1, 0);
+			std::vector<VertexId> targets;
+			std::vector<Cost> weights;
+			for (const auto& [name, neighbors] : graph)
+			{
+				offsets[id_of(name) + size_t(1)] = neighbors.size();
+				for (const Node<Name, Cost>& neighbor : neighbors)
+				{
+					targets.push_back(id_of(neighbor.name));
+					weights.push_back(neighbor.cost);
+				}
+			}
+			for (size_t v = 0; v < names.size(); v++)
+				offsets[v + 1] += offsets[v];
+			adopt(std::move(names), std::move(offsets), std::move(targets), std::move(weights));
+		}
+
+		// Builds a graph from vertex names and edges between their IDs, where each name's ID is its index.
+		// The names must be sorted in ascending order with no duplicates so that they can be looked up.
+		// Throws std::invalid_argument if they are not, or if an edge refers to a vertex that does not exist.
+		CsrGraph(std::vector<Name> names, const std::vector<Edge>& edges)
+		{
+			check_vertex_count(names.size());
+			if (std::adjacent_find(names.begin(), names.end(), std::greater_equal<Name>()) != names.end())
+				throw std::invalid_argument("The vertex names must be sorted and unique.");
+
+			// Counting sort the edges by their source vertex, keeping the order of each vertex's edges.
+			std::vector<EdgeIndex> offsets(names.size() + 1, 0);
+			for (const Edge& edge : edges)
+			{
+				if (edge.source >= names.size() || edge.target >= names.size())
+					throw std::invalid_argument("An edge refers to a vertex that is not in the graph.");
+				offsets[edge.source + size_t(1)] += 1;
+			}
+			for (size_t v = 0; v < names.size(); v++)
+				offsets[v + 1] += offsets[v];
+			std::vector<EdgeIndex> next_edge(offsets.begin(), offsets.end() - 1);
+			std::vector<VertexId> targets(edges.size());
+			std::vector<Cost> weights(edges.size());
+			for (const Edge& edge : edges)
+			{
+				const EdgeIndex e = next_edge[edge.source]++;
+				targets[e] = edge.target;
+				weights[e] = edge.weight;
+			}
+			adopt(std::move(names), std::move(offsets), std::move(targets), std::move(weights));
+		}
+
+		// Copies share the arrays, so copying is as cheap as moving.
+		CsrGraph(const CsrGraph&) = default;
+		CsrGraph& operator=(const CsrGraph&) = default;
+
+		VertexId vertex_count() const noexcept { return VertexId(vertex_names.size()); }
+		EdgeIndex edge_count() const noexcept { return edge_targets.size(); }
+
+		// Returns the ID of the vertex with the given name, or nothing if there is no such vertex.
+		// Takes O(log V) time.
+		std::optional<VertexId> id(const Name& name) const
+		{
+			auto it = std::lower_bound(vertex_names.begin(), vertex_names.end(), name);
+			if (it == vertex_names.end() || *it != name)
+				return {};
+			return VertexId(it - vertex_names.begin());
+		}
+
+		const Name& name(VertexId vertex) const { return vertex_names[vertex]; }
+		EdgeIndex first_edge(VertexId vertex) const noexcept { return edge_offsets[vertex]; }
+		EdgeIndex last_edge(VertexId vertex) const noexcept { return edge_offsets[vertex + size_t(1)]; }
+		VertexId target(EdgeIndex edge) const noexcept { return edge_targets[edge]; }
+		Cost weight(EdgeIndex edge) const noexcept { return edge_weights[edge]; }
+
+		ArrayView<Name> names() const noexcept { return vertex_names; }
+		ArrayView<EdgeIndex> offsets() const noexcept { return edge_offsets; }
+		ArrayView<VertexId> targets() const noexcept { return edge_targets; }
+		ArrayView<Cost> weights() const noexcept { return edge_weights; }
+
+		// Returns a copy of the graph with every edge's direction reversed, for searching backward.
+		CsrGraph reversed() const
+		{
+			std::vector<EdgeIndex> offsets(edge_offsets.size(), 0);
+			for (VertexId target : edge_targets)
+				offsets[target + size_t(1)] += 1;
+			for (size_t v = 0; v < vertex_names.size(); v++)
+				offsets[v + 1] += offsets[v];
+			std::vector<EdgeIndex> next_edge(offsets.begin(), offsets.end() - 1);
+			std::vector<VertexId> targets(edge_targets.size());
+			std::vector<Cost> weights(edge_weights.size());
+			for (VertexId source = 0; source < vertex_count(); source++)
+				for (EdgeIndex e = first_edge(source); e < last_edge(source); e++)
+				{
+					const EdgeIndex reversed_edge = next_edge[edge_targets[e]]++;
+					targets[reversed_edge] = source;
+					weights[reversed_edge] = edge_weights[e];
+				}
+			CsrGraph result;
+			result.adopt(std::vector<Name>(vertex_names.begin(), vertex_names.end()), std::move(offsets), std::move(targets), std::move(weights));
+			return result;
+		}
+
+		// Writes the graph in a binary format that map can use in place: a header, then the vertex
+		// names, edge offsets, targets, and weights, each padded to a multiple of 8 bytes.
+		// Requires trivially copyable Name and Cost types. The format is only meant to be read
+		// on machines with the same byte order.
+		void write(std::ostream& stream) const
+		{
+			static_assert(std::is_trivially_copyable_v<Name> && std::is_trivially_copyable_v<Cost>,
+				"write requires trivially copyable name and cost types.");
+			const std::uint64_t header[] = { file_magic, type_tag<Name>(), type_tag<Cost>(), vertex_names.size(), edge_targets.size() };
+			stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+			write_array(stream, vertex_names);
+			write_array(stream, edge_offsets);
+			write_array(stream, edge_targets);
+			write_array(stream, edge_weights);
+		}
+
+		// Memory-maps a file written by write and returns a graph that reads its arrays straight
+		// from the mapping, so it is ready in about the time it takes to open the file, and the
+		// operating system loads each page the first time a search touches it.
+		// Only the header and the offsets' ends are checked, so the rest of the file is trusted.
+		// Throws std::runtime_error if the file cannot be mapped or does not hold a graph with
+		// these name and cost types.
+		static CsrGraph map(const std::string& path)
+		{
+			static_assert(std::is_trivially_copyable_v<Name> && std::is_trivially_copyable_v<Cost>,
+				"map requires trivially copyable name and cost types.");
+			static_assert(alignof(Name) <= 8 && alignof(Cost) <= 8, "map requires names and costs aligned to at most 8 bytes.");
+			auto file = std::make_shared<const MappedFile>(path);
+			std::uint64_t header[5];
+			if (file->size() < sizeof(header))
+				throw std::runtime_error(path + " does not hold a graph.");
+			std::memcpy(header, file->data(), sizeof(header));
+			if (header[0] != file_magic || header[3] > std::numeric_limits<VertexId>::max())
+				throw std::runtime_error(path + " does not hold a graph.");
+			if (header[1] != type_tag<Name>() || header[2] != type_tag<Cost>())
+				throw std::runtime_error(path + " holds a graph with different name or cost types.");
+			const std::uint64_t vertexes = header[3];
+			const std::uint64_t edges = header[4];
+			const std::uint64_t names_at = sizeof(header);
+			const std::uint64_t offsets_at = names_at + padded_size<Name>(vertexes);
+			const std::uint64_t targets_at = offsets_at + padded_size<EdgeIndex>(vertexes + 1);
+			const std::uint64_t weights_at = targets_at + padded_size<VertexId>(edges);
+			if (edges > file->size() || weights_at + padded_size<Cost>(edges) != file->size())
+				throw std::runtime_error(path + " does not hold a graph.");
+			CsrGraph graph;
+			const char* data = file->data();
+			graph.vertex_names = ArrayView<Name>(reinterpret_cast<const Name*>(data + names_at), vertexes);
+			graph.edge_offsets = ArrayView<EdgeIndex>(reinterpret_cast<const EdgeIndex*>(data + offsets_at), vertexes + 1);
+			graph.edge_targets = ArrayView<VertexId>(reinterpret_cast<const VertexId*>(data + targets_at), edges);
+			graph.edge_weights = ArrayView<Cost>(reinterpret_cast<const Cost*>(data + weights_at), edges);
+			if (graph.edge_offsets.front() != 0 || graph.edge_offsets.back() != edges)
+				throw std::runtime_error(path + " does not hold a graph.");
+			graph.storage = std::move(file);
+			return graph;
+		}
+
+	private:
+		// The arrays of a graph built in memory.
+		struct Arrays
+		{
+			std::vector<Name> names;
+			std::vector<EdgeIndex> offsets;
+			std::vector<VertexId> targets;
+			std::vector<Cost> weights;
+		};
+
+		static constexpr std::uint64_t file_magic = 0x31525343;  // "CSR1"
+		std::shared_ptr<const void> storage;  // Owns the viewed arrays: either Arrays or a MappedFile.
+		ArrayView<Name> vertex_names;
+		ArrayView<EdgeIndex> edge_offsets;
+		ArrayView<VertexId> edge_targets;
+		ArrayView<Cost> edge_weights;
+
+		void adopt(std::vector<Name> names, std::vector<EdgeIndex> offsets, std::vector<VertexId> targets, std::vector<Cost> weights)
+		{
+			auto arrays = std::make_shared<const Arrays>(Arrays{ std::move(names), std::move(offsets), std::move(targets), std::move(weights) });
+			vertex_names = ArrayView<Name>(arrays->names.data(), arrays->names.size());
+			edge_offsets = ArrayView<EdgeIndex>(arrays->offsets.data(), arrays->offsets.size());
+			edge_targets = ArrayView<VertexId>(arrays->targets.data(), arrays->targets.size());
+			edge_weights = ArrayView<Cost>(arrays->weights.data(), arrays->weights.size());
+			storage = std::move(arrays);
+		}
+
+		static void check_vertex_count(size_t count)
+		{
+			if (count > std::numeric_limits<VertexId>::max())
+				throw std::length_error("The graph has too many vertexes for 32-bit IDs.");
+		}
+
+		// Describes a type's size and kind, so that a file is not mapped with the wrong types.
+		template <class T>
+		static constexpr std::uint64_t type_tag() noexcept
+		{
+			const std::uint64_t kind = std::is_floating_point_v<T> ? 3 : std::is_signed_v<T> ? 2 : std::is_integral_v<T> ? 1 : 0;
+			return sizeof(T) | kind << 32;
+		}
+
+		template <class T>
+		static constexpr std::uint64_t padded_size(std::uint64_t count) noexcept
+		{
+			return (count * sizeof(T) + 7) / 8 * 8;
+		}
+
+		template <class T>
+		static void write_array(std::ostream& stream, ArrayView<T> array)
+		{
+			const char padding[8] = {};
+			const std::uint64_t size = array.size() * sizeof(T);
+			stream.write(reinterpret_cast<const char*>(array.data()), std::streamsize(size));
+			stream.write(padding, std::streamsize(padded_size<T>(array.size()) - size));
+		}
+	};
+
+	// Returns the vertexes of the path from start to end, following each vertex's link in
+	// previous back to the vertex it was reached from.
+	template <class VertexId>
+	std::vector<VertexId> trace_path(const std::vector<VertexId>& previous, VertexId start, VertexId end)
+	{
+		std::vector<VertexId> path{ end };
+		for (VertexId v = end; v != start; v = previous[v])
+			path.push_back(previous[v]);
+		std::reverse(path.begin(), path.end());
+		return path;
+	}
+
+	// Converts a path of vertex IDs into a path of vertex names.
+	template <class Name, class Cost>
+	Path<Name, Cost> to_names(const CsrGraph<Name, Cost>& graph, const Path<typename CsrGraph<Name, Cost>::VertexId, Cost>& id_path)
+	{
+		std::vector<Name> path;
+		path.reserve(id_path.path.size());
+		for (auto vertex : id_path.path)
+			path.push_back(graph.name(vertex));
+		return Path<Name, Cost>(path, id_path.cost);
+	}
+
+	// Returns the IDs of two vertexes of a CSR graph.
+	// Throws std::invalid_argument if either is not in the graph.
+	template <class Name, class Cost>
+	std::pair<typename CsrGraph<Name, Cost>::VertexId, typename CsrGraph<Name, Cost>::VertexId> find_ids(
+		const CsrGraph<Name, Cost>& graph, const Name& start, const Name& end)
+	{
+		const auto start_id = graph.id(start);
+		const auto end_id = graph.id(end);
+		if (!start_id || !end_id)
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		return { *start_id, *end_id };
+	}
+
+	// Reusable arrays for running many searches on one CSR graph, using the given queue type from
+	// PriorityQueues.h. Resetting them between searches takes O(1) time: each vertex's entries are
+	// stamped with the search that wrote them, and entries from older searches read as unreached.
+	// Once the queue has grown to its working size, searches allocate no memory.
+	// Each thread needs its own workspace.
+	template <class Name, class Cost, class Queue = LazyBinaryHeap<Cost>>
+	class DijkstraWorkspace
+	{
+	public:
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+
+		// The graph must outlive the workspace.
+		explicit DijkstraWorkspace(const CsrGraph<Name, Cost>& graph)
+			: graph{ &graph }, costs(graph.vertex_count()), previous(graph.vertex_count()),
+			  stamps(graph.vertex_count(), 0), queue(graph.vertex_count()) {}
+
+		// Searches from start until end is settled.
+		// Returns the cost of the shortest path, or unreachable_cost<Cost>() if there is none.
+		// Throws std::invalid_argument if start is not in the graph.
+		// Each edge must have a nonnegative cost.
+		Cost query(VertexId start, VertexId end)
+		{
+			Cost result = unreachable_cost<Cost>();
+			search(start, [&](VertexId vertex, Cost cost)
+				{
+					if (vertex != end)
+						return true;
+					result = cost;
+					return false;
+				});
+			return result;
+		}
+
+		// Searches from start, calling settled(vertex, cost) for each vertex in order of increasing
+		// cost until it returns false or every reachable vertex is settled.
+		// Throws std::invalid_argument if start is not in the graph.
+		// Each edge must have a nonnegative cost.
+		template <class Visitor>
+		void search(VertexId start, Visitor&& settled)
+		{
+			if (start >= graph->vertex_count())
+				throw std::invalid_argument("The start vertex must be in the graph.");
+			queue.clear();
+			generation += 1;
+			if (generation == 0)
+			{
+				// The stamps wrapped around, so old stamps could match new searches.
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+			ALGORITHMS_TRACE_SCOPE("ShortestPathSearch::search");
+			search_start = start;
+			reach(start, 0, start);
+			queue.push(start, 0);
+			ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
+			while (!queue.empty())
+			{
+				const auto [cost, vertex] = queue.pop();
+				ALGORITHMS_TRACE_COUNT("dijkstra pops", 1);
+				if (cost > costs[vertex])
+					continue;  // A cheaper entry for this vertex was already expanded.
+				if (!settled(vertex, cost))
+					return;
+				ALGORITHMS_TRACE_COUNT("dijkstra relaxations", graph->last_edge(vertex) - graph->first_edge(vertex));
+				for (auto e = graph->first_edge(vertex); e < graph->last_edge(vertex); e++)
+				{
+					const VertexId neighbor = graph->target(e);
+					const Cost neighbor_cost = cost + graph->weight(e);
+					if (neighbor_cost < this->cost(neighbor))
+					{
+						reach(neighbor, neighbor_cost, vertex);
+						queue.push(neighbor, neighbor_cost);
+						ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
+					}
+				}
+			}
+		}
+
+		// Returns a vertex's cost in the last search: final if the vertex was settled, an upper
+		// bound if it was only reached, or unreachable_cost<Cost>() if it was not reached.
+		Cost cost(VertexId vertex) const noexcept
+		{
+			return stamps[vertex] == generation ? costs[vertex] : unreachable_cost<Cost>();
+		}
+
+		// Replaces the contents of path with the last search's path to a settled vertex, reusing
+		// the vector's storage. Throws std::invalid_argument if the vertex was not reached.
+		void path_to(VertexId vertex, std::vector<VertexId>& path) const
+		{
+			if (vertex >= graph->vertex_count() || stamps[vertex] != generation)
+				throw std::invalid_argument("No path found.");
+			path.clear();
+			path.push_back(vertex);
+			for (VertexId v = vertex; v != search_start; v = previous[v])
+				path.push_back(previous[v]);
+			std::reverse(path.begin(), path.end());
+		}
+
+	private:
+		const CsrGraph<Name, Cost>* graph;
+		std::vector<Cost> costs;
+		std::vector<VertexId> previous;
+		std::vector<std::uint32_t> stamps;  // The search that last wrote each vertex's entries.
+		std::uint32_t generation = 0;
+		VertexId search_start = 0;
+		Queue queue;
+
+		void reach(VertexId vertex, Cost cost, VertexId from) noexcept
+		{
+			costs[vertex] = cost;
+			previous[vertex] = from;
+			stamps[vertex] = generation;
+		}
+	};
+
+	// Finds the shortest path between two vertexes of a CSR graph given by their IDs, using the
+	// given queue type from PriorityQueues.h, such as IndexedDaryHeap<Cost> or RadixHeap<Cost>.
+	// Returns the shortest path's vertex IDs and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Queue, class Name, class Cost>
+	Path<typename CsrGraph<Name, Cost>::VertexId, Cost> dijkstra_ids(
+		const CsrGraph<Name, Cost>& graph,
+		typename CsrGraph<Name, Cost>::VertexId start,
+		typename CsrGraph<Name, Cost>::VertexId end)
+	{
+		if (start >= graph.vertex_count() || end >= graph.vertex_count())
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		DijkstraWorkspace<Name, Cost, Queue> workspace(graph);
+		const Cost cost = workspace.query(start, end);
+		if (cost == unreachable_cost<Cost>())
+			throw std::invalid_argument("No path found.");
+		std::vector<typename CsrGraph<Name, Cost>::VertexId> path;
+		workspace.path_to(end, path);
+		return Path<typename CsrGraph<Name, Cost>::VertexId, Cost>(path, cost);
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph given by their IDs.
+	// Returns the shortest path's vertex IDs and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	Path<typename CsrGraph<Name, Cost>::VertexId, Cost> dijkstra_ids(
+		const CsrGraph<Name, Cost>& graph,
+		typename CsrGraph<Name, Cost>::VertexId start,
+		typename CsrGraph<Name, Cost>::VertexId end)
+	{
+		return dijkstra_ids<LazyBinaryHeap<Cost>>(graph, start, end);
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph, using the given queue type.
+	// Returns the shortest path's vertex names and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Queue, class Name, class Cost>
+	Path<Name, Cost> dijkstra(const CsrGraph<Name, Cost>& graph, const Name& start, const Name& end)
+	{
+		const auto [start_id, end_id] = find_ids(graph, start, end);
+		return to_names(graph, dijkstra_ids<Queue>(graph, start_id, end_id));
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph.
+	// Returns the shortest path's vertex names and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	Path<Name, Cost> dijkstra(const CsrGraph<Name, Cost>& graph, const Name& start, const Name& end)
+	{
+		return dijkstra<LazyBinaryHeap<Cost>>(graph, start, end);
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph given by their IDs by searching
+	// forward from start and backward from end at the same time, which usually explores far fewer
+	// vertexes than a one-way search. reverse must be graph.reversed().
+	// Returns the shortest path's vertex IDs and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	Path<typename CsrGraph<Name, Cost>::VertexId, Cost> bidirectional_dijkstra_ids(
+		const CsrGraph<Name, Cost>& graph,
+		const CsrGraph<Name, Cost>& reverse,
+		typename CsrGraph<Name, Cost>::VertexId start,
+		typename CsrGraph<Name, Cost>::VertexId end)
+	{
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+		if (start >= graph.vertex_count() || end >= graph.vertex_count())
+			throw std::invalid_argument("The start and end vertexes must be in the graph.");
+		if (reverse.vertex_count() != graph.vertex_count() || reverse.edge_count() != graph.edge_count())
+			throw std::invalid_argument("The reverse graph does not match the graph.");
+		if (start == end)
+			return Path<VertexId, Cost>({ start }, 0);
+
+		// Index 0 is the forward search from start and index 1 is the backward search from end.
+		// The backward search's links point to the next vertex on the way to end.
+		const Cost unreached = std::numeric_limits<Cost>::max();
+		const CsrGraph<Name, Cost>* graphs[2] = { &graph, &reverse };
+		std::vector<Cost> costs[2] = { std::vector<Cost>(graph.vertex_count(), unreached), std::vector<Cost>(graph.vertex_count(), unreached) };
+		std::vector<VertexId> links[2] = { std::vector<VertexId>(graph.vertex_count(), start), std::vector<VertexId>(graph.vertex_count(), end) };
+		ALGORITHMS_TRACE_SCOPE("bidirectional_dijkstra");
+		LazyBinaryHeap<Cost> queues[2];
+		costs[0][start] = 0;
+		costs[1][end] = 0;
+		queues[0].push(start, 0);
+		queues[1].push(end, 0);
+		ALGORITHMS_TRACE_COUNT("dijkstra pushes", 2);
+		Cost best = unreached;
+		VertexId meeting = start;
+
+		// Once the two searches' next costs add up to at least the best path found so far,
+		// no path through an unexpanded vertex can be cheaper.
+		while (!queues[0].empty() && !queues[1].empty() && queues[0].top().first + queues[1].top().first < best)
+		{
+			const int side = queues[0].top().first <= queues[1].top().first ? 0 : 1;
+			const auto [cost, vertex] = queues[side].pop();
+			ALGORITHMS_TRACE_COUNT("dijkstra pops", 1);
+			if (cost > costs[side][vertex])
+				continue;  // A cheaper entry for this vertex was already expanded.
+			const CsrGraph<Name, Cost>& g = *graphs[side];
+			ALGORITHMS_TRACE_COUNT("dijkstra relaxations", g.last_edge(vertex) - g.first_edge(vertex));
+			for (auto e = g.first_edge(vertex); e < g.last_edge(vertex); e++)
+			{
+				const VertexId neighbor = g.target(e);
+				const Cost neighbor_cost = cost + g.weight(e);
+				if (neighbor_cost >= costs[side][neighbor])
+					continue;
+				costs[side][neighbor] = neighbor_cost;
+				links[side][neighbor] = vertex;
+				queues[side].push(neighbor, neighbor_cost);
+				ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
+				const Cost other_cost = costs[1 - side][neighbor];
+				if (other_cost != unreached && neighbor_cost + other_cost < best)
+				{
+					best = neighbor_cost + other_cost;
+					meeting = neighbor;
+				}
+			}
+		}
+		if (best == unreached)
+			throw std::invalid_argument("No path found.");
+		std::vector<VertexId> path = trace_path(links[0], start, meeting);
+		for (VertexId v = meeting; v != end; v = links[1][v])
+			path.push_back(links[1][v]);
+		return Path<VertexId, Cost>(path, best);
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph by searching from both ends.
+	// reverse must be graph.reversed(), which callers making many queries should build once.
+	// Returns the shortest path's vertex names and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	Path<Name, Cost> bidirectional_dijkstra(const CsrGraph<Name, Cost>& graph, const CsrGraph<Name, Cost>& reverse, const Name& start, const Name& end)
+	{
+		const auto [start_id, end_id] = find_ids(graph, start, end);
+		return to_names(graph, bidirectional_dijkstra_ids(graph, reverse, start_id, end_id));
+	}
+
+	// Finds the shortest path between two vertexes of a CSR graph by searching from both ends.
+	// Returns the shortest path's vertex names and total cost.
+	// Throws std::invalid_argument if there is no valid path.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	Path<Name, Cost> bidirectional_dijkstra(const CsrGraph<Name, Cost>& graph, const Name& start, const Name& end)
+	{
+		return bidirectional_dijkstra(graph, graph.reversed(), start, end);
+	}
+
+	// The shortest paths from one vertex to every vertex of a graph.
+	template <class VertexId, class Cost>
+	struct ShortestPathTree
+	{
+		VertexId source{};
+		// The cost of the shortest path to each vertex, or unreachable_cost<Cost>() if there is none.
+		std::vector<Cost> costs;
+		// The vertex before each vertex on its shortest path. The source and unreachable vertexes
+		// link to themselves.
+		std::vector<VertexId> previous;
+
+		bool reachable(VertexId vertex) const { return costs[vertex] != unreachable_cost<Cost>(); }
+
+		// Returns the shortest path to a vertex.
+		// Throws std::invalid_argument if the vertex cannot be reached.
+		Path<VertexId, Cost> path_to(VertexId vertex) const
+		{
+			if (!reachable(vertex))
+				throw std::invalid_argument("No path found.");
+			return Path<VertexId, Cost>(trace_path(previous, source, vertex), costs[vertex]);
+		}
+	};
+
+	// Finds the shortest paths from a vertex of a CSR graph, given by its ID, to every vertex.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	ShortestPathTree<typename CsrGraph<Name, Cost>::VertexId, Cost> shortest_path_tree_ids(
+		const CsrGraph<Name, Cost>& graph, typename CsrGraph<Name, Cost>::VertexId source)
+	{
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+		if (source >= graph.vertex_count())
+			throw std::invalid_argument("The source vertex must be in the graph.");
+		ShortestPathTree<VertexId, Cost> tree;
+		tree.source = source;
+		tree.costs.assign(graph.vertex_count(), unreachable_cost<Cost>());
+		tree.previous.resize(graph.vertex_count());
+		for (VertexId v = 0; v < graph.vertex_count(); v++)
+			tree.previous[v] = v;
+		ALGORITHMS_TRACE_SCOPE("shortest_path_tree");
+		LazyBinaryHeap<Cost> queue(graph.vertex_count());
+		tree.costs[source] = 0;
+		queue.push(source, 0);
+		ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
+		while (!queue.empty())
+		{
+			const auto [cost, vertex] = queue.pop();
+			ALGORITHMS_TRACE_COUNT("dijkstra pops", 1);
+			if (cost > tree.costs[vertex])
+				continue;
+			ALGORITHMS_TRACE_COUNT("dijkstra relaxations", graph.last_edge(vertex) - graph.first_edge(vertex));
+			for (auto e = graph.first_edge(vertex); e < graph.last_edge(vertex); e++)
+			{
+				const VertexId neighbor = graph.target(e);
+				const Cost neighbor_cost = cost + graph.weight(e);
+				if (neighbor_cost < tree.costs[neighbor])
+				{
+					tree.costs[neighbor] = neighbor_cost;
+					tree.previous[neighbor] = vertex;
+					queue.push(neighbor, neighbor_cost);
+					ALGORITHMS_TRACE_COUNT("dijkstra pushes", 1);
+				}
+			}
+		}
+		return tree;
+	}
+
+	// Finds the shortest paths from a vertex of a CSR graph to every vertex.
+	// The tree is indexed by vertex ID; use graph.id and graph.name to convert.
+	// Throws std::invalid_argument if the source is not in the graph.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	ShortestPathTree<typename CsrGraph<Name, Cost>::VertexId, Cost> shortest_path_tree(const CsrGraph<Name, Cost>& graph, const Name& source)
+	{
+		const auto source_id = graph.id(source);
+		if (!source_id)
+			throw std::invalid_argument("The source vertex must be in the graph.");
+		return shortest_path_tree_ids(graph, *source_id);
+	}
+
+	// Finds the costs of the shortest paths from each source to each target of a CSR graph, given
+	// by their IDs. Row i of the result holds the costs from sources[i] to each of the targets, with
+	// unreachable_cost<Cost>() for targets that cannot be reached.
+	// Runs one search per source, spread across the pool's threads. Each search stops once it has
+	// settled every target, and each thread reuses one workspace for all of its searches.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	std::vector<std::vector<Cost>> distance_matrix_ids(
+		const CsrGraph<Name, Cost>& graph,
+		const std::vector<typename CsrGraph<Name, Cost>::VertexId>& sources,
+		const std::vector<typename CsrGraph<Name, Cost>::VertexId>& targets,
+		ThreadPool& pool = ThreadPool::shared())
+	{
+		using VertexId = typename CsrGraph<Name, Cost>::VertexId;
+		for (const std::vector<VertexId>* vertexes : { &sources, &targets })
+			for (VertexId v : *vertexes)
+				if (v >= graph.vertex_count())
+					throw std::invalid_argument("The sources and targets must be in the graph.");
+		std::vector<char> is_target(graph.vertex_count(), false);
+		size_t target_count = 0;
+		for (VertexId t : targets)
+			if (!is_target[t])
+			{
+				is_target[t] = true;
+				target_count += 1;
+			}
+
+		std::vector<std::vector<Cost>> matrix(sources.size(), std::vector<Cost>(targets.size()));
+		std::atomic<size_t> next_source{ 0 };
+		pool.run(std::min(pool.concurrency(), sources.size()), [&](size_t)
+			{
+				DijkstraWorkspace<Name, Cost> workspace(graph);
+				for (size_t i = next_source++; i < sources.size(); i = next_source++)
+				{
+					size_t targets_left = target_count;
+					workspace.search(sources[i], [&](VertexId vertex, Cost)
+						{
+							if (is_target[vertex])
+								targets_left -= 1;
+							return targets_left > 0;
+						});
+					for (size_t j = 0; j < targets.size(); j++)
+						matrix[i][j] = workspace.cost(targets[j]);
+				}
+			});
+		return matrix;
+	}
+
+	// Finds the costs of the shortest paths from each source to each target of a CSR graph.
+	// Row i of the result holds the costs from sources[i] to each of the targets, with
+	// unreachable_cost<Cost>() for targets that cannot be reached.
+	// Throws std::invalid_argument if a source or target is not in the graph.
+	// Each edge must have a nonnegative cost.
+	template <class Name, class Cost>
+	std::vector<std::vector<Cost>> distance_matrix(
+		const CsrGraph<Name, Cost>& graph,
+		const std::vector<Name>& sources,
+		const std::vector<Name>& targets,
+		ThreadPool& pool = ThreadPool::shared())
+	{
+		std::vector<typename CsrGraph<Name, Cost>::VertexId> ids[2];
+		const std::vector<Name>* names[2] = { &sources, &targets };
+		for (int i = 0; i < 2; i++)
+			for (const Name& name : *names[i])
+			{
+				const auto id = graph.id(name);
+				if (!id)
+					throw std::invalid_argument("The sources and targets must be in the graph.");
+				ids[i].push_back(*id);
+			}
+		return distance_matrix_ids(graph, ids[0], ids[1], pool);
+	}
 }
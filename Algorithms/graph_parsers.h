@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "dijkstra.h"
+#include "MappedFile.h"
+#include "number_text.h"
+#include "ThreadPool.h"
+
+namespace Dijkstra
+{
+	// The graph parsers split their text into lines with the for_each_line in number_text.h.
+	using ::for_each_line;
+
+	// Skips spaces, tabs, and carriage returns, and then parses a number with parse_number.
+	// Returns whether there was a number.
+	template <class T>
+	bool parse_field(const char*& first, const char* last, T& value)
+	{
+		const char* const next = parse_number(first, last, value);
+		if (!next)
+			return false;
+		first = next;
+		return true;
+	}
+
+	// Returns whether the rest of the line is blank.
+	inline bool is_blank(const char* first, const char* last)
+	{
+		return std::all_of(first, last, [](char c) { return c == ' ' || c == '\t' || c == '\r'; });
+	}
+
+	// Reads a graph from a file in the DIMACS shortest path format: a "p sp <vertexes> <edges>"
+	// problem line and an "a <source> <target> <cost>" line for each edge, where the vertexes are
+	// numbered from 1, along with any "c" comment lines. The vertexes' names are their numbers.
+	// The file is memory-mapped and its lines are parsed in parallel on the pool's threads.
+	// Throws std::runtime_error if the file cannot be read or a line is not in this format.
+	template <class Cost>
+	CsrGraph<std::uint32_t, Cost> read_dimacs(const std::string& path, ThreadPool& pool = ThreadPool::shared())
+	{
+		using Graph = CsrGraph<std::uint32_t, Cost>;
+		const MappedFile file(path);
+		const size_t chunk_count = text_chunk_count(file.size(), pool);
+		std::vector<std::vector<typename Graph::Edge>> chunk_edges(chunk_count);
+		std::vector<std::uint64_t> chunk_vertex_counts(chunk_count, 0);  // Each chunk's problem line's vertex count.
+		for_each_line(file.data(), file.size(), chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+			{
+				const char* const line = first;
+				auto fail = [&]
+				{
+					throw std::runtime_error("Line at byte " + std::to_string(line - file.data()) + " of " + path + " is not in the DIMACS format.");
+				};
+				while (first < last && (*first == ' ' || *first == '\t'))
+					first++;
+				if (first == last || *first == 'c' || *first == '\r')
+					return;
+				const char type = *first++;
+				if (type == 'a')
+				{
+					std::uint32_t source = 0;
+					std::uint32_t target = 0;
+					Cost cost{};
+					if (!parse_field(first, last, source) || !parse_field(first, last, target) || !parse_field(first, last, cost)
+						|| !is_blank(first, last) || source == 0 || target == 0 || cost < 0)
+						fail();
+					chunk_edges[chunk].push_back({ source - 1, target - 1, cost });
+				}
+				else if (type == 'p')
+				{
+					while (first < last && (*first == ' ' || *first == '\t'))
+						first++;
+					while (first < last && *first != ' ' && *first != '\t')
+						first++;  // Skip the problem type, which is usually "sp".
+					std::uint64_t vertex_count = 0;
+					std::uint64_t edge_count = 0;
+					if (!parse_field(first, last, vertex_count) || !parse_field(first, last, edge_count) || !is_blank(first, last)
+						|| vertex_count > std::numeric_limits<typename Graph::VertexId>::max())
+						fail();
+					chunk_vertex_counts[chunk] = vertex_count;
+					chunk_edges[chunk].reserve(size_t(edge_count / chunk_count));
+				}
+				else
+					fail();
+			});
+
+		const std::uint64_t vertex_count = *std::max_element(chunk_vertex_counts.begin(), chunk_vertex_counts.end());
+		std::vector<typename Graph::Edge> edges = std::move(chunk_edges[0]);
+		for (size_t chunk = 1; chunk < chunk_count; chunk++)
+			edges.insert(edges.end(), chunk_edges[chunk].begin(), chunk_edges[chunk].end());
+		for (const auto& edge : edges)
+			if (edge.source >= vertex_count || edge.target >= vertex_count)
+				throw std::runtime_error(path + " has an edge to a vertex past its problem line's vertex count.");
+		std::vector<std::uint32_t> names(static_cast<size_t>(vertex_count));
+		for (size_t v = 0; v < names.size(); v++)
+			names[v] = std::uint32_t(v + 1);
+		return Graph(std::move(names), edges);
+	}
+
+	// Reads a graph from a text file with a "<source> <target> <cost>" line for each edge, where
+	// the vertexes' names are integers. An edge without a cost costs 1. Blank lines and lines
+	// starting with # or % are skipped.
+	// The file is memory-mapped and its lines are parsed in parallel on the pool's threads.
+	// Throws std::runtime_error if the file cannot be read or a line is not in this format.
+	template <class Name, class Cost>
+	CsrGraph<Name, Cost> read_edge_list(const std::string& path, ThreadPool& pool = ThreadPool::shared())
+	{
+		static_assert(std::is_integral_v<Name>, "read_edge_list requires integer vertex names.");
+		using Graph = CsrGraph<Name, Cost>;
+		const MappedFile file(path);
+		const size_t chunk_count = text_chunk_count(file.size(), pool);
+		std::vector<std::vector<std::tuple<Name, Name, Cost>>> chunk_lines(chunk_count);
+		for_each_line(file.data(), file.size(), chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+			{
+				const char* const line = first;
+				while (first < last && (*first == ' ' || *first == '\t'))
+					first++;
+				if (first == last || *first == '#' || *first == '%' || *first == '\r')
+					return;
+				Name source{};
+				Name target{};
+				Cost cost = 1;
+				if (!parse_field(first, last, source) || !parse_field(first, last, target)
+					|| (!is_blank(first, last) && (!parse_field(first, last, cost) || !is_blank(first, last))) || cost < 0)
+					throw std::runtime_error("Line at byte " + std::to_string(line - file.data()) + " of " + path + " is not an edge.");
+				chunk_lines[chunk].emplace_back(source, target, cost);
+			});
+
+		// Collect each chunk's sorted names in parallel, then merge them.
+		std::vector<std::vector<Name>> chunk_names(chunk_count);
+		pool.run(chunk_count, [&](size_t chunk)
+			{
+				std::vector<Name>& names = chunk_names[chunk];
+				for (const auto& [source, target, cost] : chunk_lines[chunk])
+				{
+					names.push_back(source);
+					names.push_back(target);
+				}
+				std::sort(names.begin(), names.end());
+				names.erase(std::unique(names.begin(), names.end()), names.end());
+			});
+		std::vector<Name> names;
+		for (std::vector<Name>& more_names : chunk_names)
+		{
+			std::vector<Name> merged;
+			merged.reserve(names.size() + more_names.size());
+			std::set_union(names.begin(), names.end(), more_names.begin(), more_names.end(), std::back_inserter(merged));
+			names.swap(merged);
+			std::vector<Name>().swap(more_names);
+		}
+		if (names.size() > std::numeric_limits<typename Graph::VertexId>::max())
+			throw std::runtime_error(path + " has too many vertexes for 32-bit IDs.");
+
+		std::vector<size_t> chunk_starts(chunk_count + 1, 0);
+		for (size_t chunk = 0; chunk < chunk_count; chunk++)
+			chunk_starts[chunk + 1] = chunk_starts[chunk] + chunk_lines[chunk].size();
+		std::vector<typename Graph::Edge> edges(chunk_starts.back());
+		pool.run(chunk_count, [&](size_t chunk)
+			{
+				auto id_of = [&](const Name& name)
+				{
+					return typename Graph::VertexId(std::lower_bound(names.begin(), names.end(), name) - names.begin());
+				};
+				size_t e = chunk_starts[chunk];
+				for (const auto& [source, target, cost] : chunk_lines[chunk])
+					edges[e++] = { id_of(source), id_of(target), cost };
+				std::vector<std::tuple<Name, Name, Cost>>().swap(chunk_lines[chunk]);
+			});
+		return Graph(std::move(names), edges);
+	}
+}
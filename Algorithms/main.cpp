@@ -1,13 +1,19 @@
+#include <cstdlib>
 #include <string>
 #include <iostream>
+#include "command_line.h"
 #include "LinkedList.h"
-#include "sorting.h"
+#include "sorting_menu.h"
 using namespace std;
 
 void manual_linked_list_test();
 
-int main()
+// With arguments, runs a batch command (see command_line.h), and otherwise shows the menus.
+int main(int argc, char* argv[])
 {
+	if (argc > 1)
+		return run_command_line(argc, argv);
+
 	string choice = "";
 	while (choice != "3")
 	{
@@ -25,7 +31,9 @@ int main()
 			manual_linked_list_test();
 	}
 	cout << endl;
+#ifdef _WIN32
 	system("pause");
+#endif
 	return 0;
 }
 
@@ -0,0 +1,358 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "MappedFile.h"
+#include "number_text.h"
+#include "ThreadPool.h"
+
+// Searches of matrixes whose rows and columns are each sorted, stored row by row in one buffer
+// of rows * cols items, like the Java 2D search but for big matrixes in memory or in files.
+
+// A row and column of a matrix, each counted from 0.
+struct MatrixPosition
+{
+	size_t row = 0;
+	size_t col = 0;
+};
+
+inline bool operator==(MatrixPosition a, MatrixPosition b)
+{
+	return a.row == b.row && a.col == b.col;
+}
+
+inline bool operator!=(MatrixPosition a, MatrixPosition b)
+{
+	return !(a == b);
+}
+
+// Returns whether each row and each column of the matrix is sorted by is_greater.
+template <class T, class is_greater = std::greater<T>>
+bool is_sorted_matrix(const T matrix[], size_t rows, size_t cols, is_greater greater = is_greater())
+{
+	for (size_t row = 0; row < rows; row++)
+	{
+		const T* items = matrix + row * cols;
+		for (size_t col = 0; col < cols; col++)
+		{
+			if ((col > 0 && greater(items[col - 1], items[col])) || (row > 0 && greater(items[col - cols], items[col])))
+				return false;
+		}
+	}
+	return true;
+}
+
+// Returns the position of an item equal to value in the matrix, or std::nullopt if there is none.
+// The search starts at the top right corner and moves left past items greater than the value
+// and down past smaller ones, so it takes at most rows + cols steps.
+template <class T, class is_greater = std::greater<T>>
+std::optional<MatrixPosition> staircase_search(const T matrix[], size_t rows, size_t cols, const T& value, is_greater greater = is_greater())
+{
+	if (rows == 0 || cols == 0 || greater(matrix[0], value) || greater(value, matrix[rows * cols - 1]))
+		return std::nullopt;
+	size_t row = 0;
+	size_t col = cols - 1;
+	const T* row_items = matrix;
+	while (true)
+	{
+		const T& item = row_items[col];
+		if (greater(item, value))
+		{
+			if (col == 0)
+				return std::nullopt;
+			col--;
+		}
+		else if (greater(value, item))
+		{
+			if (++row == rows)
+				return std::nullopt;
+			row_items += cols;
+		}
+		else
+			return MatrixPosition{ row, col };
+	}
+}
+
+// Returns a comparison that is true when greater(right, left) is, for the standard algorithms.
+template <class is_greater>
+auto greater_to_less(is_greater& greater)
+{
+	return [&greater](const auto& left, const auto& right) { return greater(right, left); };
+}
+
+// Searches the part of the matrix from first_row to last_row and first_col to last_col, not
+// including the last ones, for divide_and_conquer_search.
+template <class T, class is_greater>
+std::optional<MatrixPosition> search_submatrix(const T matrix[], size_t cols, size_t first_row, size_t last_row,
+	size_t first_col, size_t last_col, const T& value, is_greater& greater)
+{
+	while (first_row < last_row && first_col < last_col)
+	{
+		if (last_row - first_row <= last_col - first_col)
+		{
+			// Binary search the middle row. Where the value would go, the items to the left are
+			// smaller and so are all the items above them, and the items to the right are greater
+			// and so are all the items below them. That leaves the top right and bottom left parts.
+			const size_t row = first_row + (last_row - first_row) / 2;
+			const T* items = matrix + row * cols;
+			const size_t col = size_t(std::lower_bound(items + first_col, items + last_col, value, greater_to_less(greater)) - items);
+			if (col < last_col && !greater(items[col], value))
+				return MatrixPosition{ row, col };
+			if (auto found = search_submatrix(matrix, cols, first_row, row, col, last_col, value, greater))
+				return found;
+			first_row = row + 1;
+			last_col = col;
+		}
+		else
+		{
+			// Binary search the middle column in the same way, for parts taller than they are wide.
+			const size_t col = first_col + (last_col - first_col) / 2;
+			size_t low = first_row;
+			size_t high = last_row;
+			while (low < high)
+			{
+				const size_t mid = low + (high - low) / 2;
+				if (greater(value, matrix[mid * cols + col]))
+					low = mid + 1;
+				else
+					high = mid;
+			}
+			if (low < last_row && !greater(matrix[low * cols + col], value))
+				return MatrixPosition{ low, col };
+			if (auto found = search_submatrix(matrix, cols, first_row, low, col + 1, last_col, value, greater))
+				return found;
+			first_row = low;
+			last_col = col;
+		}
+	}
+	return std::nullopt;
+}
+
+// Returns the position of an item equal to value in the matrix, or std::nullopt if there is none.
+// This binary searches the middle row of the shorter side and then searches the two corners
+// where the value could still be, which takes O(rows log(cols / rows)) time when rows <= cols,
+// and so beats the staircase search when one side is much longer than the other.
+template <class T, class is_greater = std::greater<T>>
+std::optional<MatrixPosition> divide_and_conquer_search(const T matrix[], size_t rows, size_t cols, const T& value, is_greater greater = is_greater())
+{
+	if (rows == 0 || cols == 0 || greater(matrix[0], value) || greater(value, matrix[rows * cols - 1]))
+		return std::nullopt;
+	return search_submatrix(matrix, cols, 0, rows, 0, cols, value, greater);
+}
+
+// One value being searched for by divide_and_conquer_search_batch, with the columns it can
+// still be in for the rows being searched.
+struct MatrixQuery
+{
+	size_t index;  // The index of the value.
+	size_t first_col;
+	size_t last_col;
+};
+
+// Searches the rows from first_row to last_row, not including last_row, for each of the queries,
+// whose values are sorted and different, for divide_and_conquer_search_batch.
+template <class T, class is_greater>
+void search_submatrix_batch(const T matrix[], size_t cols, size_t first_row, size_t last_row, std::vector<MatrixQuery> queries,
+	const T values[], std::optional<MatrixPosition> results[], is_greater& greater)
+{
+	while (first_row < last_row && !queries.empty())
+	{
+		// Find each value's place in the middle row. The places of sorted values are in order,
+		// and so are the queries' column ranges, so each search starts from the last place found
+		// and gallops forward, which reads the row from left to right about once.
+		const size_t row = first_row + (last_row - first_row) / 2;
+		const T* items = matrix + row * cols;
+		std::vector<MatrixQuery> above;
+		size_t below = 0;
+		size_t previous = 0;
+		for (const MatrixQuery& query : queries)
+		{
+			if (results[query.index])
+				continue;  // It was found above.
+			const T& value = values[query.index];
+			size_t low = std::max(query.first_col, previous);
+			size_t step = 1;
+			while (low + step < query.last_col && greater(value, items[low + step - 1]))
+			{
+				low += step;
+				step *= 2;
+			}
+			const size_t high = std::min(low + step, query.last_col);
+			const size_t col = size_t(std::lower_bound(items + low, items + high, value, greater_to_less(greater)) - items);
+			previous = col;
+			if (col < query.last_col && !greater(items[col], value))
+			{
+				results[query.index] = MatrixPosition{ row, col };
+				continue;
+			}
+			// The value can still be above and to the right, or below and to the left.
+			if (col < query.last_col && row > first_row)
+				above.push_back({ query.index, col, query.last_col });
+			if (col > query.first_col)
+				queries[below++] = { query.index, query.first_col, col };
+		}
+		queries.resize(below);
+		search_submatrix_batch(matrix, cols, first_row, row, std::move(above), values, results, greater);
+		first_row = row + 1;
+	}
+}
+
+// Searches the matrix for each of count values, and sets results[i] to the position of an item
+// equal to values[i], or std::nullopt if there is none.
+// This is divide_and_conquer_search for many values at once. The values are sorted, and equal
+// ones are searched once, so that each row read is searched for a run of values in order from
+// left to right instead of with separate binary searches. Runs of the sorted values are
+// searched in parallel on the pool's threads.
+template <class T, class is_greater = std::greater<T>>
+void divide_and_conquer_search_batch(const T matrix[], size_t rows, size_t cols, const T values[], size_t count,
+	std::optional<MatrixPosition> results[], ThreadPool& pool = ThreadPool::shared(), is_greater greater = is_greater())
+{
+	std::vector<size_t> order(count);
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return greater(values[b], values[a]); });
+	const size_t chunk_count = std::min(count, pool.concurrency() * 4);
+	pool.run(chunk_count, [&](size_t chunk)
+		{
+			const size_t first = count * chunk / chunk_count;
+			const size_t last = count * (chunk + 1) / chunk_count;
+			std::vector<MatrixQuery> queries;
+			for (size_t k = first; k < last; k++)
+			{
+				const size_t i = order[k];
+				results[i] = std::nullopt;
+				if (k > first && !greater(values[i], values[order[k - 1]]))
+					continue;
+				if (rows > 0 && cols > 0 && !greater(matrix[0], values[i]) && !greater(values[i], matrix[rows * cols - 1]))
+					queries.push_back({ i, 0, cols });
+			}
+			search_submatrix_batch(matrix, cols, 0, rows, std::move(queries), values, results, greater);
+
+			// Copy each result to the equal values after it.
+			for (size_t k = first + 1; k < last; k++)
+				if (!greater(values[order[k]], values[order[k - 1]]))
+					results[order[k]] = results[order[k - 1]];
+		});
+}
+
+// The first 8 bytes of a binary matrix file: "MAT1".
+constexpr std::uint64_t matrix_file_magic = 0x3154414d;
+
+// Describes a type's size and kind, so that a file is not read with the wrong type.
+template <class T>
+constexpr std::uint64_t matrix_type_tag() noexcept
+{
+	const std::uint64_t kind = std::is_floating_point_v<T> ? 3 : std::is_signed_v<T> ? 2 : std::is_integral_v<T> ? 1 : 0;
+	return sizeof(T) | kind << 32;
+}
+
+// Writes the matrix in a binary format that load_matrix reads in place: a header of the magic
+// number, item type, row count, and column count as 64-bit integers, and then the items row by row.
+// Requires a trivially copyable T. The format is only meant to be read on machines with the same
+// byte order.
+template <class T>
+void write_matrix(std::ostream& stream, const T matrix[], size_t rows, size_t cols)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "write_matrix requires a trivially copyable item type.");
+	const std::uint64_t header[] = { matrix_file_magic, matrix_type_tag<T>(), rows, cols };
+	stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(matrix), std::streamsize(rows * cols * sizeof(T)));
+}
+
+// A matrix read by load_matrix, whose items are either in a file's memory mapping or parsed
+// from text into memory.
+template <class T>
+struct LoadedMatrix
+{
+	size_t rows = 0;
+	size_t cols = 0;
+	const T* items = nullptr;  // rows * cols items, row by row.
+	std::optional<MappedFile> file;
+	std::vector<T> parsed;
+};
+
+// Reads a matrix from a binary file written by write_matrix, which is memory-mapped and read in
+// place, or from a text file whose first line is the row and column counts and whose next lines
+// are the rows, with the items separated by spaces. Text is parsed in parallel on the pool's threads.
+// The items are not checked for being sorted.
+// Throws std::runtime_error if the file cannot be read or does not hold a matrix of T.
+template <class T>
+LoadedMatrix<T> load_matrix(const std::string& path, ThreadPool& pool = ThreadPool::shared())
+{
+	static_assert(std::is_trivially_copyable_v<T>, "load_matrix requires a trivially copyable item type.");
+	LoadedMatrix<T> matrix;
+	MappedFile file(path);
+	const char* const text = file.data();
+	const size_t size = file.size();
+	std::uint64_t header[4];
+	if (size >= sizeof(header) && (std::memcpy(header, text, sizeof(header)), header[0] == matrix_file_magic))
+	{
+		if (header[1] != matrix_type_tag<T>())
+			throw std::runtime_error(path + " holds a matrix with a different item type.");
+		if (header[2] != 0 && header[3] > (size - sizeof(header)) / sizeof(T) / header[2])
+			throw std::runtime_error(path + " ends before the matrix does.");
+		matrix.rows = size_t(header[2]);
+		matrix.cols = size_t(header[3]);
+		matrix.file.emplace(std::move(file));
+		matrix.items = reinterpret_cast<const T*>(matrix.file->data() + sizeof(header));
+		return matrix;
+	}
+
+	const char* const end = text + size;
+	const char* next = parse_number(text, end, matrix.rows);
+	next = next ? parse_number(next, end, matrix.cols) : nullptr;
+	const char* body = next ? static_cast<const char*>(std::memchr(next, '\n', size_t(end - next))) : nullptr;
+	if (body == nullptr || (matrix.cols != 0 && matrix.rows > SIZE_MAX / sizeof(T) / matrix.cols))
+		throw std::runtime_error(path + " does not start with a matrix's row and column counts.");
+	body += 1;
+	matrix.parsed.resize(matrix.rows * matrix.cols);
+
+	// Count each chunk's lines to find which row each starts with, and then parse each chunk's rows.
+	const size_t body_size = size_t(end - body);
+	const size_t chunk_count = text_chunk_count(body_size, pool);
+	std::vector<size_t> first_rows(chunk_count + 1, 0);
+	for_each_text_chunk(body, body_size, chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+		{
+			first_rows[chunk + 1] = size_t(std::count(first, last, '\n'));
+		});
+	std::partial_sum(first_rows.begin(), first_rows.end(), first_rows.begin());
+	size_t row_count = first_rows.back() + (body_size > 0 && end[-1] != '\n');
+	std::vector<std::string> errors(chunk_count);
+	for_each_text_chunk(body, body_size, chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+		{
+			for (size_t row = first_rows[chunk]; first < last && errors[chunk].empty(); row++)
+			{
+				const void* newline = std::memchr(first, '\n', size_t(last - first));
+				const char* line_end = newline ? static_cast<const char*>(newline) : last;
+				size_t col = 0;
+				T item;
+				for (const char* item_end; col <= matrix.cols && (item_end = parse_number(first, line_end, item)) != nullptr; col++)
+				{
+					if (row < matrix.rows && col < matrix.cols)
+						matrix.parsed[row * matrix.cols + col] = item;
+					first = item_end;
+				}
+				while (first < line_end && (*first == ' ' || *first == '\t' || *first == '\r'))
+					first++;
+				if (row >= matrix.rows && (col != 0 || first != line_end))
+					errors[chunk] = "there are more than " + std::to_string(matrix.rows) + " rows";
+				else if (row < matrix.rows && (col != matrix.cols || first != line_end))
+					errors[chunk] = "row " + std::to_string(row + 1) + " does not have " + std::to_string(matrix.cols) + " numbers";
+				first = line_end + 1;
+			}
+		});
+	for (const std::string& error : errors)
+		if (!error.empty())
+			throw std::runtime_error(path + ": " + error + ".");
+	if (row_count < matrix.rows)
+		throw std::runtime_error(path + " has " + std::to_string(row_count) + " of the matrix's " + std::to_string(matrix.rows) + " rows.");
+	matrix.items = matrix.parsed.data();
+	return matrix;
+}
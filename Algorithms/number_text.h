@@ -0,0 +1,359 @@
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+// Fast conversions between arrays of numbers and text with one number per line, for reading
+// and writing large files. Big texts are split into chunks at line breaks that are parsed or
+// formatted in parallel on a thread pool. Integers are parsed eight digits at a time with
+// 64-bit arithmetic.
+
+// Whether numbers of type T are read and written as text by these functions. Characters and
+// bools are not numbers here, since streams print them differently.
+template <class T>
+constexpr bool is_text_number = std::is_floating_point_v<T>
+	|| (std::is_integral_v<T> && sizeof(T) > 1 && !std::is_same_v<T, bool> && !std::is_same_v<T, wchar_t>
+		&& !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>);
+
+// The most characters format_number writes for one number of type T.
+template <class T>
+constexpr size_t max_number_length = std::is_floating_point_v<T> ? 32 : std::numeric_limits<T>::digits10 + 3;
+
+// Thrown when a line of text is not a number.
+class NumberFormatError : public std::runtime_error
+{
+public:
+	explicit NumberFormatError(size_t byte)
+		: std::runtime_error("The line at byte " + std::to_string(byte) + " is not a number."), byte{ byte } {}
+
+	// The position of the start of the line in the text.
+	size_t byte;
+};
+
+// Splits text into chunk_count pieces at line breaks and calls parse(first, last, chunk) for
+// each piece on the pool's threads. Each piece is whole lines, and chunk is its number.
+template <class Parse>
+void for_each_text_chunk(const char* text, size_t size, size_t chunk_count, ThreadPool& pool, Parse parse)
+{
+	const char* const end = text + size;
+	// Returns the start of the first line that starts at or after offset.
+	auto line_start = [&](size_t offset)
+	{
+		if (offset == 0 || offset >= size)
+			return offset == 0 ? text : end;
+		const void* newline = std::memchr(text + offset - 1, '\n', size - offset + 1);
+		return newline ? static_cast<const char*>(newline) + 1 : end;
+	};
+	pool.run(chunk_count, [&](size_t chunk)
+		{
+			parse(line_start(size * chunk / chunk_count), line_start(size * (chunk + 1) / chunk_count), chunk);
+		});
+}
+
+// Splits text into chunk_count pieces at line breaks and calls parse(first, last, chunk) for
+// each line, without its line break, on the pool's threads. chunk is the number of the piece
+// the line is in, so that each piece can collect its results separately and in order.
+template <class Parse>
+void for_each_line(const char* text, size_t size, size_t chunk_count, ThreadPool& pool, Parse parse)
+{
+	for_each_text_chunk(text, size, chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+		{
+			while (first < last)
+			{
+				const void* newline = std::memchr(first, '\n', size_t(last - first));
+				const char* line_end = newline ? static_cast<const char*>(newline) : last;
+				parse(first, line_end, chunk);
+				first = line_end + 1;
+			}
+		});
+}
+
+// Returns how many chunks to split size bytes of text into: about four per thread, but none
+// smaller than 64 KiB.
+inline size_t text_chunk_count(size_t size, const ThreadPool& pool)
+{
+	return std::max<size_t>(1, std::min(pool.concurrency() * 4, size >> 16));
+}
+
+// Loads eight characters into an integer with the first one in its lowest byte.
+inline std::uint64_t load_eight_characters(const char* text)
+{
+	std::uint64_t chunk = 0;
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	std::memcpy(&chunk, text, 8);
+#else
+	for (int i = 7; i >= 0; i--)
+		chunk = (chunk << 8) | static_cast<unsigned char>(text[i]);
+#endif
+	return chunk;
+}
+
+// Returns the index of the lowest nonzero byte of a nonzero integer.
+inline int lowest_nonzero_byte(std::uint64_t bytes)
+{
+#if defined(_MSC_VER)
+	unsigned long bit = 0;
+	_BitScanForward64(&bit, bytes);
+	return int(bit / 8);
+#elif defined(__GNUC__)
+	return __builtin_ctzll(bytes) / 8;
+#else
+	int byte = 0;
+	while ((bytes & 0xFF) == 0)
+	{
+		bytes >>= 8;
+		byte++;
+	}
+	return byte;
+#endif
+}
+
+// Returns the value of eight digits loaded by load_eight_characters, less '0' from each byte.
+// This combines pairs of digits, then pairs of pairs, then the two halves with 64-bit arithmetic.
+inline std::uint32_t eight_digits_value(std::uint64_t digits)
+{
+	digits = ((digits & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+	digits = ((digits & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+	return std::uint32_t(((digits & 0x0000FFFF0000FFFF) * 42949672960001) >> 32);
+}
+
+// Parses the number at the start of the text like std::from_chars, after skipping any spaces,
+// tabs, and carriage returns. Returns the end of the number, or nullptr if there is no number
+// or it is out of range for T.
+template <class T>
+const char* parse_number(const char* first, const char* last, T& value)
+{
+	static_assert(is_text_number<T>, "parse_number requires a number type.");
+	while (first < last && (*first == ' ' || *first == '\t' || *first == '\r'))
+		first++;
+	if constexpr (std::is_integral_v<T>)
+	{
+		// Parse up to eight digits at a time. Each chunk of eight characters is checked for
+		// digits all at once: a digit is 0x30 to 0x39, so its high half is 3 both before and
+		// after adding 6. The digits before the first character that is not one are shifted
+		// to the top of the chunk, as if the number had leading zeros.
+		static constexpr std::uint64_t powers_of_ten[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+		const bool negative = std::is_signed_v<T> && first < last && *first == '-';
+		const char* const digits = first + negative;
+		const char* next = digits;
+		std::uint64_t magnitude = 0;
+		while (last - next >= 8 && next - digits < 16)
+		{
+			const std::uint64_t chunk = load_eight_characters(next);
+			const std::uint64_t non_digits = ((chunk & 0xF0F0F0F0F0F0F0F0) ^ 0x3030303030303030)
+				| (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) ^ 0x3030303030303030);
+			if (non_digits == 0)
+			{
+				magnitude = magnitude * 100000000 + eight_digits_value(chunk - 0x3030303030303030);
+				next += 8;
+				continue;
+			}
+			const int digit_count = lowest_nonzero_byte(non_digits);
+			if (digit_count > 0)
+			{
+				magnitude = magnitude * powers_of_ten[digit_count]
+					+ eight_digits_value((chunk - 0x3030303030303030) << (8 * (8 - digit_count)));
+				next += digit_count;
+			}
+			break;
+		}
+		while (next < last && *next >= '0' && *next <= '9' && next - digits < 20)
+			magnitude = magnitude * 10 + std::uint64_t(*next++ - '0');
+		// Leave long numbers, which might overflow, to std::from_chars.
+		if (next > digits && next - digits < 20 && !(next < last && *next >= '0' && *next <= '9'))
+		{
+			using Unsigned = std::make_unsigned_t<T>;
+			const std::uint64_t limit = std::uint64_t(std::numeric_limits<T>::max()) + negative;
+			if (magnitude > limit)
+				return nullptr;
+			value = negative ? T(Unsigned(0) - Unsigned(magnitude)) : T(magnitude);
+			return next;
+		}
+	}
+	const auto [next, error] = std::from_chars(first, last, value);
+	return error == std::errc() ? next : nullptr;
+}
+
+// Writes the number's shortest text that parses back to it, and returns the end of the text.
+// There must be room for max_number_length<T> characters.
+template <class T>
+char* format_number(char* first, T value)
+{
+	static_assert(is_text_number<T>, "format_number requires a number type.");
+	return std::to_chars(first, first + max_number_length<T>, value).ptr;
+}
+
+// Parses text with one number per line and appends the numbers to items, parsing chunks of the
+// text in parallel on the pool's threads. Blank lines are skipped, and spaces, tabs, and
+// carriage returns around the numbers are ignored.
+// Throws NumberFormatError if a line is not a number that fits in T.
+template <class T>
+void parse_numbers(const char* text, size_t size, std::vector<T>& items, ThreadPool& pool = ThreadPool::shared())
+{
+	// Parses the lines from first to last, which is the end of a line, into numbers, and returns
+	// how many there were. Each number is parsed where it starts, without looking for the end of
+	// its line first.
+	auto parse_lines = [text](const char* first, const char* last, T* numbers)
+	{
+		auto skip_spaces = [last](const char* next)
+		{
+			while (next < last && (*next == ' ' || *next == '\t' || *next == '\r'))
+				next++;
+			return next;
+		};
+		T* number = numbers;
+		while (first < last)
+		{
+			const char* next = parse_number(first, last, *number);
+			if (next && next < last && *next == '\n')
+			{
+				number++;
+				first = next + 1;
+				continue;
+			}
+			next = skip_spaces(next ? next : first);
+			if (next < last && *next != '\n')
+				throw NumberFormatError(size_t(first - text));
+			if (next != skip_spaces(first))
+				number++;  // The line is not blank.
+			first = next < last ? next + 1 : last;
+		}
+		return size_t(number - numbers);
+	};
+
+	// Count each chunk's lines, which is much faster than parsing them, to find where their
+	// numbers go. Then parse each chunk's lines in place, and close the gaps that blank lines left.
+	const size_t chunk_count = text_chunk_count(size, pool);
+	std::vector<size_t> starts(chunk_count + 1, items.size());
+	for_each_text_chunk(text, size, chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+		{
+			starts[chunk + 1] = size_t(std::count(first, last, '\n')) + 1;
+		});
+	for (size_t chunk = 0; chunk < chunk_count; chunk++)
+		starts[chunk + 1] += starts[chunk];
+	items.resize(starts.back());
+	std::vector<size_t> counts(chunk_count);
+	for_each_text_chunk(text, size, chunk_count, pool, [&](const char* first, const char* last, size_t chunk)
+		{
+			counts[chunk] = parse_lines(first, last, items.data() + starts[chunk]);
+		});
+	size_t end = starts[0];
+	for (size_t chunk = 0; chunk < chunk_count; chunk++)
+	{
+		if (end != starts[chunk])
+			std::copy(items.begin() + starts[chunk], items.begin() + starts[chunk] + counts[chunk], items.begin() + end);
+		end += counts[chunk];
+	}
+	items.resize(end);
+}
+
+// Reads text with one number per line from the stream, block_size bytes at a time, and parses
+// each block in parallel as the next one is needed, so the whole text is never in memory.
+// Throws NumberFormatError if a line is not a number, with its byte counted from where the
+// stream was, or std::runtime_error if the stream cannot be read.
+template <class T>
+std::vector<T> read_numbers(std::FILE* stream, ThreadPool& pool = ThreadPool::shared(), size_t block_size = size_t(1) << 24)
+{
+	std::vector<T> items;
+	std::vector<char> block(std::max<size_t>(block_size, 1));
+	size_t carried = 0;  // The length of the unfinished line at the start of the block.
+	size_t block_start = 0;  // The position of the block in the stream.
+	bool at_end = false;
+	while (!at_end)
+	{
+		const size_t filled = carried + std::fread(block.data() + carried, 1, block.size() - carried, stream);
+		if (std::ferror(stream))
+			throw std::runtime_error("Unable to read the numbers.");
+		at_end = filled < block.size();
+
+		// Parse the whole lines, and carry the unfinished last line over to the next block.
+		size_t parse_size = filled;
+		if (!at_end)
+		{
+			while (parse_size > 0 && block[parse_size - 1] != '\n')
+				parse_size--;
+			if (parse_size == 0)
+			{
+				// The line is longer than the block.
+				carried = filled;
+				block.resize(block.size() * 2);
+				continue;
+			}
+		}
+		try
+		{
+			parse_numbers(block.data(), parse_size, items, pool);
+		}
+		catch (const NumberFormatError& error)
+		{
+			throw NumberFormatError(block_start + error.byte);
+		}
+		carried = filled - parse_size;
+		std::memmove(block.data(), block.data() + parse_size, carried);
+		block_start += parse_size;
+	}
+	return items;
+}
+
+// Reads a file with one number per line by memory-mapping it and parsing it in parallel.
+// Throws std::runtime_error if the file cannot be read or a line is not a number.
+template <class T>
+std::vector<T> read_numbers(const std::string& path, ThreadPool& pool = ThreadPool::shared())
+{
+	const MappedFile file(path);
+	std::vector<T> items;
+	try
+	{
+		parse_numbers(file.data(), file.size(), items, pool);
+	}
+	catch (const NumberFormatError& error)
+	{
+		throw std::runtime_error(path + ": " + error.what());
+	}
+	return items;
+}
+
+// Writes the numbers to the stream, each followed by the separator. Blocks of numbers are
+// formatted in parallel on the pool's threads and then written in order.
+// Throws std::runtime_error if the stream cannot be written.
+template <class T>
+void write_numbers(std::FILE* stream, const T items[], size_t size, ThreadPool& pool = ThreadPool::shared(), char separator = '\n')
+{
+	const size_t block_items = size_t(1) << 14;
+	const size_t blocks_per_round = pool.concurrency() * 2;
+	std::vector<std::vector<char>> texts(blocks_per_round, std::vector<char>(block_items * (max_number_length<T> + 1)));
+	std::vector<size_t> lengths(blocks_per_round);
+	for (size_t round_start = 0; round_start < size; round_start += block_items * blocks_per_round)
+	{
+		const size_t block_count = std::min(blocks_per_round, (size - round_start + block_items - 1) / block_items);
+		pool.run(block_count, [&](size_t block)
+			{
+				const size_t first = round_start + block * block_items;
+				const size_t last = std::min(size, first + block_items);
+				char* const text = texts[block].data();
+				char* end = text;
+				for (size_t i = first; i < last; i++)
+				{
+					end = format_number(end, items[i]);
+					*end++ = separator;
+				}
+				lengths[block] = size_t(end - text);
+			});
+		for (size_t block = 0; block < block_count; block++)
+			if (std::fwrite(texts[block].data(), 1, lengths[block], stream) != lengths[block])
+				throw std::runtime_error("Unable to write the numbers.");
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "ThreadPool.h"
+#include "tracing.h"
+
+// Merges the sorted runs of the items, which begin at each of starts but the last, which is the
+// items' size, by merging pairs of adjacent runs in parallel until one run is left. The merges are
+// stable and use a buffer as large as the items.
+template <class T, class is_greater = std::greater<T>>
+void merge_runs(T items[], std::vector<size_t> starts, ThreadPool& pool, is_greater greater = is_greater())
+{
+	if (starts.size() <= 2)
+		return;
+	const size_t size = starts.back();
+
+	// Each pass merges pairs of runs from one array into the other, so the passes alternate
+	// between the items and a buffer.
+	std::vector<T> buffer(size);
+	T* from = items;
+	T* to = buffer.data();
+	auto is_less = [&greater](const T& left, const T& right) { return greater(right, left); };
+	while (starts.size() > 2)
+	{
+		const size_t pair_count = (starts.size() - 1) / 2;
+		const bool odd_run = (starts.size() - 1) % 2 == 1;
+		pool.run(pair_count + odd_run, [&](size_t pair)
+			{
+				ALGORITHMS_TRACE_SCOPE("merge_runs merge");
+				const size_t first = starts[pair * 2];
+				if (pair == pair_count)
+				{
+					std::copy(from + first, from + starts[pair * 2 + 1], to + first);
+					return;
+				}
+				const size_t mid = starts[pair * 2 + 1];
+				const size_t last = starts[pair * 2 + 2];
+				std::merge(from + first, from + mid, from + mid, from + last, to + first, is_less);
+			});
+		std::vector<size_t> merged_starts;
+		for (size_t i = 0; i < starts.size(); i += 2)
+			merged_starts.push_back(starts[i]);
+		if (merged_starts.back() != size)
+			merged_starts.push_back(size);
+		starts.swap(merged_starts);
+		std::swap(from, to);
+	}
+	if (from != items)
+		std::copy(from, from + size, items);
+}
+
+// Sorts the items by splitting them into runs of nearly equal size, sorting the runs in parallel
+// with sort_run(first_item, run_size), and then merging them with merge_runs. There is at least
+// one run per thread in the pool, and every run has at most INT_MAX items so that any of the
+// int-sized sorts in sorting.h can sort it, for example:
+// parallel_sort(items, size, pool, [](int* run, int run_size) { heap_sort(run, run_size); });
+// The merges put the items in ascending order of is_greater, which must be the order that
+// sort_run sorts in.
+template <class T, class SortRun, class is_greater = std::greater<T>>
+void parallel_sort(T items[], size_t size, ThreadPool& pool, SortRun sort_run, is_greater greater = is_greater())
+{
+	if (size < 2)
+		return;
+	ALGORITHMS_TRACE_SCOPE("parallel_sort");
+	const size_t run_count = std::min(size, std::max(pool.concurrency(), (size - 1) / INT_MAX + 1));
+	std::vector<size_t> starts(run_count + 1);
+	for (size_t run = 0; run <= run_count; run++)
+		starts[run] = size * run / run_count;
+	pool.run(run_count, [&](size_t run)
+		{
+			ALGORITHMS_TRACE_SCOPE("parallel_sort run");
+			sort_run(items + starts[run], int(starts[run + 1] - starts[run]));
+		});
+	merge_runs(items, std::move(starts), pool, greater);
+}
@@ -0,0 +1,402 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "parallel_sort.h"
+#include "sorting.h"
+#include "ThreadPool.h"
+#include "tracing.h"
+
+// smart_sort samples the items to estimate how sorted they already are, how many of them repeat,
+// and how many bytes of their keys vary, and then sorts them with whichever strategy a cost model
+// expects to finish first:
+//
+// insertion       insertion_sort, for the smallest arrays.
+// radix           a least significant digit radix sort, for integers and floating point numbers
+//                 in ascending order. It skips the bytes that are the same in every key.
+// adaptive_merge  a natural merge sort, which finds the runs that are already in order, reverses
+//                 the descending ones, and merges them. It is fastest for nearly sorted items.
+// introsort       std::sort, which is an introsort.
+// parallel        parallel_sort with std::sort on each run.
+//
+// The cost model's coefficients can be tuned, and bench/smart_sort_bench.cpp fits them to the
+// machine that runs it. The decision and the estimates behind it are returned for inspection.
+
+enum class SortStrategy { insertion, radix, adaptive_merge, introsort, parallel };
+constexpr size_t sort_strategy_count = 5;
+
+// Returns the strategy's name, as written above.
+inline const char* sort_strategy_name(SortStrategy strategy) noexcept
+{
+	static const char* const names[] = { "insertion", "radix", "adaptive_merge", "introsort", "parallel" };
+	return names[size_t(strategy)];
+}
+
+// What sampling the items showed.
+struct SortProfile
+{
+	size_t size = 0;
+	size_t key_bytes = 0;           // The size of each item.
+	const char* key_kind = "other";  // integer, floating point, or other.
+	bool radix_sortable = false;    // Whether the keys are numbers compared by std::greater.
+	size_t radix_passes = 0;        // The number of bytes that vary among the sampled keys.
+	double estimated_runs = 1;      // How many ascending or descending runs the items are in.
+	double inversion_ratio = 0;     // Of the sampled pairs, how many are out of order: 0 if sorted, 1/2 if random, 1 if reversed.
+	double duplicate_ratio = 0;     // How many of the items repeat an earlier one, estimated from repeats in the sample.
+};
+
+// The cost model. Each cost is in nanoseconds per item, and a strategy's estimate is its cost per
+// item times the number of items. The defaults were fitted by bench/smart_sort_bench.cpp to 4
+// million 64-bit items on one thread, so parallel_efficiency is a guess.
+struct SortCostModel
+{
+	size_t insertion_max_size = 32;      // Sizes up to this use insertion sort without sampling.
+	size_t parallel_min_size = 1 << 17;  // Smaller sizes are not sorted in parallel.
+	size_t sample_size = 1024;           // Items sampled for each estimate.
+	double radix_fixed = 8.0;            // Counting the bytes and copying the items back.
+	double radix_per_pass = 3.5;         // Each pass over a byte that varies.
+	double introsort_per_level = 3.9;    // Each of the log2(size) levels of std::sort.
+	double presorted_discount = 0.8;     // How much cheaper comparisons are in sorted or reversed items.
+	double duplicate_discount = 0.2;     // How much faster std::sort is when every item repeats.
+	double merge_fixed = 0.5;            // Finding the runs.
+	double merge_short_runs = 16;        // Extending short runs with insertion sort, per item in them.
+	double merge_per_level = 5.0;        // Each of the log2(runs) levels of merging.
+	double parallel_efficiency = 0.8;    // The fraction of the threads' speedup that parallel runs reach.
+	double parallel_fixed_ns = 30000;    // Waking the threads, in nanoseconds per sort.
+};
+
+// A strategy that smart_sort chose, with what led to it.
+struct SortDecision
+{
+	SortStrategy strategy = SortStrategy::introsort;
+	SortProfile profile;
+	// Each strategy's estimated time in nanoseconds, or infinity if it cannot sort the items.
+	std::array<double, sort_strategy_count> estimated_ns{};
+	// Lines that explain the profile, the estimates, and the choice.
+	std::vector<std::string> reasons;
+};
+
+// Samples the items and returns the strategy that the cost model expects to sort them fastest on
+// the given number of threads, without sorting them.
+template <class T, class is_greater = std::greater<T>>
+SortDecision choose_sort(const T items[], size_t size, size_t threads = ThreadPool::shared().concurrency(),
+	const SortCostModel& model = SortCostModel(), is_greater greater = is_greater());
+
+// Sorts the items with the given strategy, in ascending order of is_greater. Insertion sort takes
+// quadratic time, so it is only for small arrays. Throws std::invalid_argument if the strategy is
+// radix and the items are not numbers compared by std::greater.
+template <class T, class is_greater = std::greater<T>>
+void sort_by_strategy(SortStrategy strategy, T items[], size_t size, ThreadPool& pool = ThreadPool::shared(), is_greater greater = is_greater());
+
+// Sorts the items with the strategy that choose_sort picks for the pool, and returns the decision.
+template <class T, class is_greater = std::greater<T>>
+SortDecision smart_sort(T items[], size_t size, ThreadPool& pool = ThreadPool::shared(),
+	const SortCostModel& model = SortCostModel(), is_greater greater = is_greater());
+
+// Sorts numbers in ascending order with a stable least significant digit radix sort.
+template <class T>
+void radix_sort(T items[], size_t size);
+
+// Sorts the items with a stable natural merge sort that merges the runs already in the items,
+// after extending the shorter ones to at least min_run items with insertion sort.
+template <class T, class is_greater = std::greater<T>>
+void adaptive_merge_sort(T items[], size_t size, is_greater greater = is_greater(), size_t min_run = 32);
+
+// Whether radix_sort can sort items of the type in the order of the comparator.
+template <class T, class is_greater>
+constexpr bool is_radix_sortable = std::is_same_v<is_greater, std::greater<T>> && std::is_arithmetic_v<T>
+	&& !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+// The unsigned integer whose order is a number's order, for radix_sort.
+template <class T>
+auto radix_key(T item) noexcept
+{
+	using Key = std::conditional_t<sizeof(T) == 1, std::uint8_t, std::conditional_t<sizeof(T) == 2, std::uint16_t,
+		std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+	Key key;
+	std::memcpy(&key, &item, sizeof(T));
+	constexpr Key sign = Key(1) << (sizeof(T) * 8 - 1);
+	if constexpr (std::is_floating_point_v<T>)
+		return key & sign ? Key(~key) : Key(key | sign);
+	else if constexpr (std::is_signed_v<T>)
+		return Key(key ^ sign);
+	else
+		return key;
+}
+
+template <class T>
+void radix_sort(T items[], size_t size)
+{
+	if (size < 2)
+		return;
+	ALGORITHMS_TRACE_SCOPE("radix_sort");
+	// Count every byte of every key in one pass, and then skip the bytes that are the same in
+	// every key, since a pass over one of them would not move anything.
+	std::vector<std::array<size_t, 256>> counts(sizeof(T));
+	for (size_t i = 0; i < size; i++)
+	{
+		const auto key = radix_key(items[i]);
+		for (size_t byte = 0; byte < sizeof(T); byte++)
+			counts[byte][(key >> (byte * 8)) & 0xff] += 1;
+	}
+	std::vector<T> buffer;
+	T* from = items;
+	T* to = nullptr;
+	for (size_t byte = 0; byte < sizeof(T); byte++)
+	{
+		std::array<size_t, 256>& offsets = counts[byte];
+		if (std::find(offsets.begin(), offsets.end(), size) != offsets.end())
+			continue;
+		if (to == nullptr)
+		{
+			buffer.resize(size);
+			to = buffer.data();
+		}
+		ALGORITHMS_TRACE_COUNT("radix_sort passes", 1);
+		size_t offset = 0;
+		for (size_t& count : offsets)
+		{
+			const size_t next = offset + count;
+			count = offset;
+			offset = next;
+		}
+		for (size_t i = 0; i < size; i++)
+			to[offsets[(radix_key(from[i]) >> (byte * 8)) & 0xff]++] = from[i];
+		std::swap(from, to);
+	}
+	if (from != items)
+		std::copy(from, from + size, items);
+}
+
+template <class T, class is_greater>
+void adaptive_merge_sort(T items[], size_t size, is_greater greater, size_t min_run)
+{
+	if (size < 2)
+		return;
+	ALGORITHMS_TRACE_SCOPE("adaptive_merge_sort");
+	// Only strictly descending runs are reversed, so that equal items keep their order.
+	std::vector<size_t> starts = { 0 };
+	for (size_t first = 0; first < size; )
+	{
+		size_t last = first + 1;
+		if (last < size && greater(items[first], items[last]))
+		{
+			while (last + 1 < size && greater(items[last], items[last + 1]))
+				last++;
+			std::reverse(items + first, items + last + 1);
+		}
+		else
+		{
+			while (last + 1 < size && !greater(items[last], items[last + 1]))
+				last++;
+		}
+		last++;
+		if (last - first < min_run && last < size)
+		{
+			last = std::min(size, first + min_run);
+			insertion_sort(items + first, int(last - first), greater);
+		}
+		starts.push_back(last);
+		first = last;
+	}
+	ALGORITHMS_TRACE_COUNT("adaptive_merge_sort runs", starts.size() - 1);
+	ThreadPool serial(0);
+	merge_runs(items, std::move(starts), serial, greater);
+}
+
+template <class T, class is_greater>
+SortDecision choose_sort(const T items[], size_t size, size_t threads, const SortCostModel& model, is_greater greater)
+{
+	SortDecision decision;
+	SortProfile& profile = decision.profile;
+	char line[200];
+	profile.size = size;
+	profile.key_bytes = sizeof(T);
+	profile.key_kind = std::is_integral_v<T> ? "integer" : std::is_floating_point_v<T> ? "floating point" : "other";
+	profile.radix_sortable = is_radix_sortable<T, is_greater>;
+	decision.estimated_ns.fill(std::numeric_limits<double>::infinity());
+	if (size <= std::max<size_t>(model.insertion_max_size, 2))
+	{
+		decision.strategy = SortStrategy::insertion;
+		decision.estimated_ns[size_t(SortStrategy::insertion)] = 0;
+		std::snprintf(line, sizeof line, "%zu items is at most %zu, so insertion sort without sampling", size, model.insertion_max_size);
+		decision.reasons.push_back(line);
+		return decision;
+	}
+
+	// Count the run boundaries in blocks of neighboring items spread over the array.
+	const size_t block_count = 16;
+	const size_t block_size = std::max<size_t>(2, std::min(size / block_count, model.sample_size / block_count));
+	size_t pairs = 0;
+	size_t boundaries = 0;
+	for (size_t block = 0; block < block_count; block++)
+	{
+		const size_t first = (size - block_size) * block / (block_count - 1);
+		int direction = 0;  // 1 in an ascending run, -1 in a descending one, and 0 at a run's start.
+		for (size_t i = first + 1; i < first + block_size; i++, pairs++)
+		{
+			const bool descends = greater(items[i - 1], items[i]);
+			if (direction == 0)
+				direction = descends ? -1 : 1;
+			else if (descends == (direction == 1))
+			{
+				boundaries += 1;
+				direction = 0;
+			}
+		}
+	}
+	profile.estimated_runs = 1 + double(size - 1) * double(boundaries) / double(pairs);
+
+	// Compare random pairs, and look for repeats among the items at distinct random positions.
+	std::uint64_t state = 0x9e3779b97f4a7c15 ^ size;
+	auto random_index = [&]
+	{
+		state += 0x9e3779b97f4a7c15;
+		std::uint64_t z = state;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+		return size_t((z ^ (z >> 31)) % size);
+	};
+	const size_t pair_count = std::min(model.sample_size, size);
+	size_t inversions = 0;
+	std::vector<size_t> positions(pair_count);
+	for (size_t i = 0; i < pair_count; i++)
+	{
+		size_t left = random_index();
+		size_t right = random_index();
+		if (left > right)
+			std::swap(left, right);
+		inversions += greater(items[left], items[right]);
+		positions[i] = random_index();
+	}
+	profile.inversion_ratio = double(inversions) / double(pair_count);
+	std::sort(positions.begin(), positions.end());
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+	const size_t sample_size = positions.size();
+	std::vector<T> sample(sample_size);
+	for (size_t i = 0; i < sample_size; i++)
+		sample[i] = items[positions[i]];
+	// Of m items drawn from d equally common values, about m * (m - 1) / (2 * d) pairs are equal,
+	// so the number of equal neighbors in the sorted sample estimates how many values there are.
+	std::sort(sample.begin(), sample.end(), [&greater](const T& left, const T& right) { return greater(right, left); });
+	size_t equal_pairs = 0;
+	for (size_t i = 1; i < sample_size; i++)
+		equal_pairs += !greater(sample[i], sample[i - 1]);
+	const double values = equal_pairs == 0 ? double(size) : double(sample_size) * double(sample_size - 1) / (2.0 * double(equal_pairs));
+	profile.duplicate_ratio = 1 - std::min(1.0, values / double(size));
+	if constexpr (is_radix_sortable<T, is_greater>)
+	{
+		decltype(radix_key(T())) varying = 0;
+		for (const T& item : sample)
+			varying |= radix_key(item) ^ radix_key(sample[0]);
+		while (varying != 0)
+		{
+			profile.radix_passes += 1;
+			varying = decltype(varying)(std::uint64_t(varying) >> 8);
+		}
+	}
+	std::snprintf(line, sizeof line, "%zu %s items of %zu bytes", size, profile.key_kind, profile.key_bytes);
+	decision.reasons.push_back(line);
+	std::snprintf(line, sizeof line, "%zu run boundaries in %zu neighboring pairs, so about %.0f runs", boundaries, pairs, profile.estimated_runs);
+	decision.reasons.push_back(line);
+	std::snprintf(line, sizeof line, "%.1f%% of %zu sampled pairs are inverted, and %zu equal neighbors in a sorted sample suggest %.1f%% of the items repeat",
+		100 * profile.inversion_ratio, pair_count, equal_pairs, 100 * profile.duplicate_ratio);
+	decision.reasons.push_back(line);
+
+	// Estimate each strategy's time.
+	const double n = double(size);
+	const double presorted = std::abs(2 * profile.inversion_ratio - 1);
+	auto introsort_ns = [&](double count)
+	{
+		return count * model.introsort_per_level * std::log2(std::max(count, 2.0))
+			* (1 - model.presorted_discount * presorted) * (1 - model.duplicate_discount * profile.duplicate_ratio);
+	};
+	double& radix = decision.estimated_ns[size_t(SortStrategy::radix)];
+	double& merge = decision.estimated_ns[size_t(SortStrategy::adaptive_merge)];
+	double& introsort = decision.estimated_ns[size_t(SortStrategy::introsort)];
+	double& parallel = decision.estimated_ns[size_t(SortStrategy::parallel)];
+	if (profile.radix_sortable)
+		radix = n * (model.radix_fixed + model.radix_per_pass * double(profile.radix_passes));
+	// Each run boundary leaves at most 32 items to insertion sort, and those runs are merged.
+	const double short_runs = std::min(1.0, (profile.estimated_runs - 1) * 32 / n);
+	const double runs = std::clamp(profile.estimated_runs, 1.0, std::max(1.0, n / 32));
+	merge = n * (model.merge_fixed + model.merge_short_runs * short_runs
+		+ model.merge_per_level * std::ceil(std::log2(runs)) * (1 - model.presorted_discount * presorted));
+	introsort = introsort_ns(n);
+	if (threads > 1 && size >= model.parallel_min_size)
+		parallel = introsort_ns(n / double(threads)) / model.parallel_efficiency
+			+ n * model.merge_per_level * std::ceil(std::log2(double(threads))) + model.parallel_fixed_ns;
+
+	decision.strategy = SortStrategy::introsort;
+	for (size_t strategy = 0; strategy < sort_strategy_count; strategy++)
+	{
+		if (decision.estimated_ns[strategy] == std::numeric_limits<double>::infinity())
+			std::snprintf(line, sizeof line, "%s: not applicable", sort_strategy_name(SortStrategy(strategy)));
+		else
+			std::snprintf(line, sizeof line, "%s: estimated %.3f ms", sort_strategy_name(SortStrategy(strategy)), decision.estimated_ns[strategy] / 1e6);
+		decision.reasons.push_back(line);
+		if (decision.estimated_ns[strategy] < decision.estimated_ns[size_t(decision.strategy)])
+			decision.strategy = SortStrategy(strategy);
+	}
+	std::snprintf(line, sizeof line, "chose %s, whose estimate is the lowest", sort_strategy_name(decision.strategy));
+	decision.reasons.push_back(line);
+	return decision;
+}
+
+template <class T, class is_greater>
+void sort_by_strategy(SortStrategy strategy, T items[], size_t size, ThreadPool& pool, is_greater greater)
+{
+	auto is_less = [&greater](const T& left, const T& right) { return greater(right, left); };
+	switch (strategy)
+	{
+	case SortStrategy::insertion:
+		insertion_sort(items, int(size), greater);
+		break;
+	case SortStrategy::radix:
+		if constexpr (is_radix_sortable<T, is_greater>)
+			radix_sort(items, size);
+		else
+			throw std::invalid_argument("Radix sort can only sort numbers in ascending order.");
+		break;
+	case SortStrategy::adaptive_merge:
+		adaptive_merge_sort(items, size, greater);
+		break;
+	case SortStrategy::introsort:
+		std::sort(items, items + size, is_less);
+		break;
+	case SortStrategy::parallel:
+		parallel_sort(items, size, pool, [&is_less](T* run, int run_size) { std::sort(run, run + run_size, is_less); }, greater);
+		break;
+	}
+}
+
+template <class T, class is_greater>
+SortDecision smart_sort(T items[], size_t size, ThreadPool& pool, const SortCostModel& model, is_greater greater)
+{
+	ALGORITHMS_TRACE_SCOPE("smart_sort");
+	SortDecision decision = choose_sort(items, size, pool.concurrency(), model, greater);
+	sort_by_strategy(decision.strategy, items, size, pool, greater);
+	return decision;
+}
+
+// Declares or defines the explicit instantiations of the strategy choice and the sorts for one
+// item type with the default comparator, like SORTING_INSTANTIATIONS in sorting.h.
+#define SMART_SORT_INSTANTIATIONS(prefix, T) \
+	prefix SortDecision choose_sort<T, std::greater<T>>(const T[], size_t, size_t, const SortCostModel&, std::greater<T>); \
+	prefix void sort_by_strategy<T, std::greater<T>>(SortStrategy, T[], size_t, ThreadPool&, std::greater<T>); \
+	prefix SortDecision smart_sort<T, std::greater<T>>(T[], size_t, ThreadPool&, const SortCostModel&, std::greater<T>);
+
+SMART_SORT_INSTANTIATIONS(extern template, int)
+SMART_SORT_INSTANTIATIONS(extern template, std::int64_t)
+SMART_SORT_INSTANTIATIONS(extern template, float)
+SMART_SORT_INSTANTIATIONS(extern template, double)
+SMART_SORT_INSTANTIATIONS(extern template, std::string)
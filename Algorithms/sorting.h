@@ -1,23 +1,306 @@
 #pragma once
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <string>
+#include "tracing.h"
 
-void manual_sorting_test();
-template <class T> void print(T[], int);
-template <class T> inline void swap_(T&, T&);
-void randomize(int[], int, int);
-template <class T, class is_greater> void prompt_and_sort_array(T[], int);
-int print_sort_menu();
-template <class T, class is_greater, class are_equal> int search_array(T[], int, T);
-int print_search_menu();
-
-template <class T, class is_greater> void bubble_sort(T[], int);
-template <class T, class is_greater> void selection_sort(T[], int);
-template <class T, class is_greater> void insertion_sort(T[], int);
-template <class T, class is_greater> void shell_sort(T[], int);
-template <class T, class is_greater> void quicksort(T[], int, int);
-template <class T, class is_greater> int partition(T[], int, int);
-template <class T, class is_greater> void merge_sort(T[], int, int);
-template <class T, class is_greater> void merge(T[], int, int, int);
-template <class T, class is_greater> void heap_sort(T[], int);
-
-template <class T, class are_equal> int linear_search(T[], int, T);
-template <class T, class is_greater, class are_equal> int binary_search(T[], int, T);
+// The sorts and searches take their comparators by instance, so lambdas and comparators with
+// state work and can be inlined. Each comparator type defaults to std::greater or
+// std::equal_to, and a default-constructed instance is used if none is passed.
+// The sorts put items in ascending order of is_greater.
+
+template <class T>
+inline void swap_(T& a, T& b)
+{
+	T temp = a;
+	a = b;
+	b = temp;
+}
+
+// Fills the array with random numbers from 1 to max.
+inline void randomize(int numbers[], int size, int max)
+{
+	srand((unsigned)time(0));
+	for (int i = 0; i < size; i++)
+		numbers[i] = 1 + rand() % max;
+}
+
+template <class T, class is_greater = std::greater<T>>
+void bubble_sort(T items[], int size, is_greater greater = is_greater())
+{
+	bool swapped = true;
+	while (swapped)
+	{
+		swapped = false;
+		for (int i = 0; i < size - 1; i++)
+		{
+			if (greater(items[i], items[i + 1]))
+			{
+				swap_(items[i], items[i + 1]);
+				swapped = true;
+			}
+		}
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+void selection_sort(T items[], int size, is_greater greater = is_greater())
+{
+	for (int i = 0; i < size - 1; i++)
+	{
+		int low = i;
+		for (int j = i + 1; j < size; j++)
+		{
+			if (greater(items[low], items[j]))
+				low = j;
+		}
+		swap_(items[low], items[i]);
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+void insertion_sort(T items[], int size, is_greater greater = is_greater())
+{
+	for (int i = 1; i < size; i++)
+	{
+		T key = items[i];
+		int j = i - 1;
+		for (; j >= 0 && greater(items[j], key); j--)
+			items[j + 1] = items[j];
+		items[j + 1] = key;
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+void shell_sort(T items[], int size, is_greater greater = is_greater())
+{
+	for (int gap = size / 2; gap > 0; gap /= 2)
+	{
+		for (int i = gap; i < size; i++)
+		{
+			T temp = items[i];
+			int j = i;
+			for (; j >= gap && greater(items[j - gap], temp); j -= gap)
+				items[j] = items[j - gap];
+			items[j] = temp;
+		}
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+int partition(T items[], int first, int last, is_greater greater = is_greater())
+{
+	int mid = first + (last - first) / 2;
+	T pivot_value = items[mid];
+	while (first <= last)
+	{
+		while (greater(pivot_value, items[first]))
+			first++;
+		while (greater(items[last], pivot_value))
+			last--;
+		if (first <= last)
+		{
+			swap_(items[first], items[last]);
+			first++;
+			last--;
+		}
+	}
+	return first;
+}
+
+// Sorts the items from index first through index last.
+template <class T, class is_greater = std::greater<T>>
+void quicksort(T items[], int first, int last, is_greater greater = is_greater())
+{
+	if (first < last)
+	{
+		ALGORITHMS_TRACE_DEPTH("quicksort depth");
+		ALGORITHMS_TRACE_COUNT("quicksort partitions", 1);
+		int pivot = ::partition(items, first, last, greater);
+		::quicksort(items, first, pivot - 1, greater);
+		::quicksort(items, pivot, last, greater);
+	}
+}
+
+// Merges the sorted items from index left through mid with the sorted items after mid through right.
+template <class T, class is_greater = std::greater<T>>
+void merge(T items[], int left, int mid, int right, is_greater greater = is_greater())
+{
+	const int left_size = mid - left + 1;
+	const int right_size = right - mid;
+	T* temp_left = new T[left_size];
+	T* temp_right = new T[right_size];
+
+	// copy the data to the temp arrays
+	for (int i = 0; i < left_size; i++)
+		temp_left[i] = items[left + i];
+	for (int j = 0; j < right_size; j++)
+		temp_right[j] = items[mid + 1 + j];
+
+	// merge the temp arrays back into the items array
+	int L = 0,
+		R = 0,
+		i = left;
+	while (L < left_size && R < right_size)
+	{
+		if (!greater(temp_left[L], temp_right[R]))
+		{
+			items[i] = temp_left[L];
+			L++;
+		}
+		else
+		{
+			items[i] = temp_right[R];
+			R++;
+		}
+
+		i++;
+	}
+
+	// copy the remaining elements of temp_left[], if there are any
+	while (L < left_size)
+	{
+		items[i] = temp_left[L];
+		L++;
+		i++;
+	}
+
+	// copy the remaining elements of temp_right[], if there are any
+	while (R < right_size)
+	{
+		items[i] = temp_right[R];
+		R++;
+		i++;
+	}
+
+	delete[] temp_left;
+	delete[] temp_right;
+}
+
+// Sorts the items from index left through index right.
+template <class T, class is_greater = std::greater<T>>
+void merge_sort(T items[], int left, int right, is_greater greater = is_greater())
+{
+	if (left < right)
+	{
+		// Each level of the recursion is one pass over the items.
+		ALGORITHMS_TRACE_DEPTH("merge_sort passes");
+		ALGORITHMS_TRACE_COUNT("merge_sort merged items", right - left + 1);
+		int mid = left + (right - left) / 2;
+		::merge_sort(items, left, mid, greater);
+		::merge_sort(items, mid + 1, right, greater);
+		::merge(items, left, mid, right, greater);
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+void heap_sort(T items[], int size, is_greater greater = is_greater())
+{
+	if (size < 2)
+		return;
+
+	// turn the array into a max heap
+	for (int i = 0; i < size; i++)
+	{
+		int j = i;
+		while (greater(items[j], items[(j - 1) / 2]))
+		{
+			swap_(items[j], items[(j - 1) / 2]);
+			j = (j - 1) / 2;
+		}
+	}
+
+	// Sort the array by putting the greatest number at the end, then
+	// the second greatest number in the second to last spot, etc.
+	int last = size - 1;
+	swap_(items[0], items[last]);
+	last--;
+	while (last > 0)
+	{
+		// rebuild the heap within the remaining elements
+		int parent = 0,
+			left_child = 1,
+			right_child = 2;
+		bool heaping = true;
+		while (heaping)
+		{
+			// find the greater of the two children
+			int max;
+			if (right_child > last || greater(items[left_child], items[right_child]))
+				max = left_child;
+			else
+				max = right_child;
+			if (greater(items[max], items[parent]))
+			{
+				swap_(items[max], items[parent]);
+
+				// Prepare to check whether further swapping is needed to
+				// finish rebuilding the heap.
+				parent = max;
+				left_child = parent * 2 + 1;
+				right_child = parent * 2 + 2;
+				if (left_child >= last)
+					heaping = false;
+			}
+			else
+				heaping = false;
+		}
+		swap_(items[0], items[last]);
+		last--;
+	}
+}
+
+// Returns the index of the first item equal to value, or -1 if there is none.
+template <class T, class are_equal = std::equal_to<T>>
+int linear_search(const T items[], int size, T value, are_equal equal = are_equal())
+{
+	for (int i = 0; i < size; i++)
+	{
+		if (equal(items[i], value))
+			return i;
+	}
+	return -1;
+}
+
+// Returns the index of an item equal to value in items sorted by is_greater, or -1 if there is none.
+template <class T, class is_greater = std::greater<T>, class are_equal = std::equal_to<T>>
+int binary_search(const T items[], int size, T value, is_greater greater = is_greater(), are_equal equal = are_equal())
+{
+	int first = 0;
+	int last = size - 1;
+	while (first <= last)
+	{
+		int mid = first + (last - first) / 2;
+		if (greater(items[mid], value))
+			last = mid - 1;
+		else if (equal(items[mid], value))
+			return mid;
+		else
+			first = mid + 1;
+	}
+	return -1;
+}
+
+// Declares or defines the explicit instantiations of every sort and search for one item type
+// with the default comparators. sorting.cpp defines them once, and this header declares them
+// extern so that other files link to those instead of compiling their own.
+#define SORTING_INSTANTIATIONS(prefix, T) \
+	prefix void bubble_sort<T, std::greater<T>>(T[], int, std::greater<T>); \
+	prefix void selection_sort<T, std::greater<T>>(T[], int, std::greater<T>); \
+	prefix void insertion_sort<T, std::greater<T>>(T[], int, std::greater<T>); \
+	prefix void shell_sort<T, std::greater<T>>(T[], int, std::greater<T>); \
+	prefix int partition<T, std::greater<T>>(T[], int, int, std::greater<T>); \
+	prefix void quicksort<T, std::greater<T>>(T[], int, int, std::greater<T>); \
+	prefix void merge<T, std::greater<T>>(T[], int, int, int, std::greater<T>); \
+	prefix void merge_sort<T, std::greater<T>>(T[], int, int, std::greater<T>); \
+	prefix void heap_sort<T, std::greater<T>>(T[], int, std::greater<T>); \
+	prefix int linear_search<T, std::equal_to<T>>(const T[], int, T, std::equal_to<T>); \
+	prefix int binary_search<T, std::greater<T>, std::equal_to<T>>(const T[], int, T, std::greater<T>, std::equal_to<T>);
+
+SORTING_INSTANTIATIONS(extern template, int)
+SORTING_INSTANTIATIONS(extern template, std::int64_t)
+SORTING_INSTANTIATIONS(extern template, float)
+SORTING_INSTANTIATIONS(extern template, double)
+SORTING_INSTANTIATIONS(extern template, std::string)
@@ -0,0 +1,58 @@
+#include <iostream>
+#include "sorting_menu.h"
+using namespace std;
+
+void manual_sorting_test()
+{
+	const int size = 10;
+	int numbers[size];
+	const int max_value = 100;
+	randomize(numbers, size, max_value);
+
+	cout << "\n Unsorted array: ";
+	print(numbers, size);
+
+	prompt_and_sort_array(numbers, size);
+
+	cout << "\n Sorted array: ";
+	print(numbers, size);
+
+	cout << "\n What value are you looking for? ";
+	int value;
+	cin >> value;
+
+	int result = search_array(numbers, size, value);
+
+	if (result == -1)
+		cout << "\n Error: number not found.";
+	else
+		cout << "\n The value is in element " << result;
+}
+
+int print_sort_menu()
+{
+	int choice;
+	cout << "\n Which sorting algorithm do you want to use?"
+		"\n 1. Bubble sort"
+		"\n 2. Selection sort"
+		"\n 3. Insertion sort"
+		"\n 4. Shell sort"
+		"\n 5. Quicksort"
+		"\n 6. Merge sort"
+		"\n 7. Heap sort"
+		"\n 8. Smart sort (chooses a sort by sampling the array)"
+		"\n> ";
+	cin >> choice;
+	return choice;
+}
+
+int print_search_menu()
+{
+	int choice;
+	cout << "\n Which searching algorithm do you want to use?"
+		"\n 1. Linear search"
+		"\n 2. Binary search"
+		"\n> ";
+	cin >> choice;
+	return choice;
+}
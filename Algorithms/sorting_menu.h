@@ -0,0 +1,86 @@
+#pragma once
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include "number_text.h"
+#include "smart_sort.h"
+#include "sorting.h"
+
+// The interactive menus of the sorting and searching demo.
+
+void manual_sorting_test();
+int print_sort_menu();
+int print_search_menu();
+
+// Prints the items, each after a space. Numbers are formatted into one buffer that is printed at
+// once, which is much faster than printing them one at a time.
+template <class T>
+void print(T items[], int size)
+{
+	if constexpr (is_text_number<T>)
+	{
+		std::string text(size_t(std::max(size, 0)) * (max_number_length<T> + 1), ' ');
+		char* end = text.data();
+		for (int i = 0; i < size; i++)
+		{
+			*end++ = ' ';
+			end = format_number(end, items[i]);
+		}
+		std::cout.write(text.data(), end - text.data());
+	}
+	else
+	{
+		for (int i = 0; i < size; i++)
+			std::cout << " " << items[i];
+	}
+}
+
+template <class T, class is_greater = std::greater<T>>
+void prompt_and_sort_array(T items[], int size, is_greater greater = is_greater())
+{
+	switch (print_sort_menu())
+	{
+	case 1:
+		bubble_sort(items, size, greater);
+		break;
+	case 2:
+		selection_sort(items, size, greater);
+		break;
+	case 3:
+		insertion_sort(items, size, greater);
+		break;
+	case 4:
+		shell_sort(items, size, greater);
+		break;
+	case 5:
+		quicksort(items, 0, size - 1, greater);
+		break;
+	case 6:
+		merge_sort(items, 0, size - 1, greater);
+		break;
+	case 7:
+		heap_sort(items, size, greater);
+		break;
+	case 8:
+		std::cout << "\n Smart sort:";
+		for (const std::string& reason : smart_sort(items, size_t(std::max(size, 0)), ThreadPool::shared(), SortCostModel(), greater).reasons)
+			std::cout << "\n  " << reason;
+		break;
+	default:
+		std::cout << "\n Error: invalid sorting algorithm choice.";
+	}
+}
+
+template <class T, class is_greater = std::greater<T>, class are_equal = std::equal_to<T>>
+int search_array(T items[], int size, T value, is_greater greater = is_greater(), are_equal equal = are_equal())
+{
+	switch (print_search_menu())
+	{
+	case 1:
+		return linear_search(items, size, value, equal);
+	case 2:
+		return binary_search(items, size, value, greater, equal);
+	default:
+		return -1;
+	}
+}
@@ -0,0 +1,316 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(ALGORITHMS_TRACING) && defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(ALGORITHMS_TRACING) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+// Instrumentation for finding where the algorithms spend their time. It is only compiled in if
+// ALGORITHMS_TRACING is defined, which the CMake option of the same name does for every target.
+// Otherwise the macros expand to nothing and the functions report no events or counters.
+//
+// ALGORITHMS_TRACE_SCOPE(name) times the rest of the enclosing block.
+// ALGORITHMS_TRACE_COUNT(name, amount) adds to a counter.
+// ALGORITHMS_TRACE_DEPTH(name) counts the rest of the enclosing block as one level deeper in a
+// recursion, and the counter keeps the deepest level reached.
+//
+// Names must be string literals. Each thread records into its own buffer of events and its own
+// counters, which only that thread writes, so recording takes no locks; a thread only locks
+// once, when it first records anything. Each thread keeps its first events_per_thread events
+// and counts the rest as dropped.
+
+namespace Tracing
+{
+	// A counter's total over every thread, or for a depth counter, the deepest level reached.
+	struct CounterTotal
+	{
+		std::string name;
+		std::uint64_t value = 0;
+		bool is_depth = false;
+	};
+
+#ifdef ALGORITHMS_TRACING
+	constexpr bool enabled = true;
+	constexpr size_t events_per_thread = size_t(1) << 16;
+	constexpr size_t max_counters = 256;
+
+	// Returns the time in ticks of the CPU's timestamp counter, or of std::chrono::steady_clock
+	// on CPUs without one.
+	inline std::uint64_t timestamp() noexcept
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	// A timed scope, in ticks of timestamp().
+	struct Event
+	{
+		const char* name;
+		std::uint64_t start;
+		std::uint64_t end;
+	};
+
+	// One thread's events and counters. The counts are atomic so that other threads can read
+	// what has been recorded so far.
+	struct ThreadTrace
+	{
+		size_t thread_number = 0;
+		std::unique_ptr<Event[]> events{ new Event[events_per_thread] };
+		std::atomic<size_t> event_count{ 0 };
+		std::atomic<std::uint64_t> dropped{ 0 };
+		std::array<std::atomic<std::uint64_t>, max_counters> counters{};
+		std::array<std::uint64_t, max_counters> depths{};  // The current depth of each depth counter.
+	};
+
+	// Every thread's trace and every counter's name. The traces outlive their threads, so the
+	// events of a thread pool's workers can be written after the pool is gone.
+	struct Registry
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadTrace>> threads;
+		std::vector<std::pair<const char*, bool>> counters;
+		std::uint64_t start_ticks = timestamp();
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+		static Registry& instance()
+		{
+			// Never destroyed, so threads that exit after main returns can still record.
+			static Registry* registry = new Registry;
+			return *registry;
+		}
+	};
+
+	// Returns the calling thread's trace, registering it the first time.
+	// Registering allocates, so the first call on a thread can throw std::bad_alloc. Callers that
+	// cannot throw take the trace from a caller that can instead of calling this.
+	inline ThreadTrace& this_thread()
+	{
+		thread_local ThreadTrace* trace = []
+		{
+			Registry& registry = Registry::instance();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.threads.push_back(std::make_unique<ThreadTrace>());
+			registry.threads.back()->thread_number = registry.threads.size() - 1;
+			return registry.threads.back().get();
+		}();
+		return *trace;
+	}
+
+	// Returns the number of the counter with the given name, registering it the first time.
+	// Throws std::length_error if there would be more than max_counters counters.
+	inline size_t counter_id(const char* name, bool is_depth)
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (size_t id = 0; id < registry.counters.size(); id++)
+			if (std::string(registry.counters[id].first) == name)
+				return id;
+		if (registry.counters.size() == max_counters)
+			throw std::length_error("There are too many tracing counters.");
+		registry.counters.emplace_back(name, is_depth);
+		return registry.counters.size() - 1;
+	}
+
+	inline void record(ThreadTrace& trace, const char* name, std::uint64_t start, std::uint64_t end) noexcept
+	{
+		const size_t count = trace.event_count.load(std::memory_order_relaxed);
+		if (count == events_per_thread)
+		{
+			trace.dropped.store(trace.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+		trace.events[count] = { name, start, end };
+		trace.event_count.store(count + 1, std::memory_order_release);
+	}
+
+	inline void add(size_t counter, std::uint64_t amount)
+	{
+		std::atomic<std::uint64_t>& value = this_thread().counters[counter];
+		value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+	}
+
+	// Records the time from its construction to its destruction as an event. The constructor
+	// registers the thread's trace, so that the destructor only writes to it and cannot throw.
+	class Scope
+	{
+	public:
+		explicit Scope(const char* name) : trace{ this_thread() }, name{ name }, start{ timestamp() } {}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope() { record(trace, name, start, timestamp()); }
+
+	private:
+		ThreadTrace& trace;
+		const char* name;
+		std::uint64_t start;
+	};
+
+	// Counts one more level of a recursion from its construction to its destruction.
+	class Depth
+	{
+	public:
+		explicit Depth(size_t counter) : trace{ this_thread() }, counter{ counter }
+		{
+			const std::uint64_t depth = ++trace.depths[counter];
+			if (depth > trace.counters[counter].load(std::memory_order_relaxed))
+				trace.counters[counter].store(depth, std::memory_order_relaxed);
+		}
+		Depth(const Depth&) = delete;
+		Depth& operator=(const Depth&) = delete;
+		~Depth() { trace.depths[counter] -= 1; }
+
+	private:
+		ThreadTrace& trace;
+		size_t counter;
+	};
+
+#define ALGORITHMS_TRACE_JOIN(a, b) a##b
+#define ALGORITHMS_TRACE_NAME(prefix, line) ALGORITHMS_TRACE_JOIN(prefix, line)
+#define ALGORITHMS_TRACE_SCOPE(name) const Tracing::Scope ALGORITHMS_TRACE_NAME(trace_scope_, __LINE__)(name)
+#define ALGORITHMS_TRACE_COUNT(name, amount) \
+	do \
+	{ \
+		static const size_t trace_counter = Tracing::counter_id(name, false); \
+		Tracing::add(trace_counter, std::uint64_t(amount)); \
+	} while (false)
+#define ALGORITHMS_TRACE_DEPTH(name) \
+	static const size_t ALGORITHMS_TRACE_NAME(trace_counter_, __LINE__) = Tracing::counter_id(name, true); \
+	const Tracing::Depth ALGORITHMS_TRACE_NAME(trace_depth_, __LINE__)(ALGORITHMS_TRACE_NAME(trace_counter_, __LINE__))
+
+	// Returns every counter's total, in the order they were first used.
+	inline std::vector<CounterTotal> counters()
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		std::vector<CounterTotal> totals;
+		for (size_t id = 0; id < registry.counters.size(); id++)
+		{
+			CounterTotal total{ registry.counters[id].first, 0, registry.counters[id].second };
+			for (const std::unique_ptr<ThreadTrace>& trace : registry.threads)
+			{
+				const std::uint64_t value = trace->counters[id].load(std::memory_order_relaxed);
+				total.value = total.is_depth ? std::max(total.value, value) : total.value + value;
+			}
+			totals.push_back(total);
+		}
+		return totals;
+	}
+
+	// Returns the number of events recorded by every thread, not counting dropped ones.
+	inline size_t event_count()
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		size_t count = 0;
+		for (const std::unique_ptr<ThreadTrace>& trace : registry.threads)
+			count += trace->event_count.load(std::memory_order_acquire);
+		return count;
+	}
+
+	// Writes the events and the counters' totals as JSON in the Chrome trace event format, which
+	// chrome://tracing and Perfetto open. Threads may go on recording while it runs.
+	inline void write_chrome_trace(std::ostream& stream)
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// Convert ticks to microseconds by comparing them with the clock over at least 10 ms.
+		while (std::chrono::steady_clock::now() - registry.start_time < std::chrono::milliseconds(10))
+			std::this_thread::yield();
+		const std::uint64_t end_ticks = timestamp();
+		const double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.start_time).count();
+		const double ticks_per_microsecond = double(end_ticks - registry.start_ticks) / microseconds;
+		auto time = [&](std::uint64_t ticks) { return double(std::int64_t(ticks - registry.start_ticks)) / ticks_per_microsecond; };
+
+		const auto precision = stream.precision(3);
+		const auto flags = stream.setf(std::ios::fixed, std::ios::floatfield);
+		stream << "{\"traceEvents\":[";
+		const char* separator = "\n";
+		std::uint64_t dropped = 0;
+		for (const std::unique_ptr<ThreadTrace>& trace : registry.threads)
+		{
+			stream << separator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace->thread_number
+				<< ",\"args\":{\"name\":\"thread " << trace->thread_number << "\"}}";
+			separator = ",\n";
+			const size_t count = trace->event_count.load(std::memory_order_acquire);
+			for (size_t i = 0; i < count; i++)
+			{
+				const Event& event = trace->events[i];
+				stream << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace->thread_number
+					<< ",\"ts\":" << time(event.start) << ",\"dur\":" << time(event.end) - time(event.start) << "}";
+			}
+			dropped += trace->dropped.load(std::memory_order_relaxed);
+		}
+		for (size_t id = 0; id < registry.counters.size(); id++)
+		{
+			std::uint64_t value = 0;
+			for (const std::unique_ptr<ThreadTrace>& trace : registry.threads)
+			{
+				const std::uint64_t thread_value = trace->counters[id].load(std::memory_order_relaxed);
+				value = registry.counters[id].second ? std::max(value, thread_value) : value + thread_value;
+			}
+			stream << separator << "{\"name\":\"" << registry.counters[id].first << "\",\"ph\":\"C\",\"pid\":1,\"ts\":" << time(end_ticks)
+				<< ",\"args\":{\"value\":" << value << "}}";
+			separator = ",\n";
+		}
+		stream << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":\"" << dropped << "\"}}\n";
+		stream.precision(precision);
+		stream.flags(flags);
+	}
+
+	// Clears every thread's events and counters, and restarts the trace's clock.
+	// No other thread may be recording while it runs.
+	inline void reset()
+	{
+		Registry& registry = Registry::instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (const std::unique_ptr<ThreadTrace>& trace : registry.threads)
+		{
+			trace->event_count.store(0, std::memory_order_relaxed);
+			trace->dropped.store(0, std::memory_order_relaxed);
+			for (std::atomic<std::uint64_t>& counter : trace->counters)
+				counter.store(0, std::memory_order_relaxed);
+		}
+		registry.start_ticks = timestamp();
+		registry.start_time = std::chrono::steady_clock::now();
+	}
+#else
+	constexpr bool enabled = false;
+
+#define ALGORITHMS_TRACE_SCOPE(name) ((void)0)
+#define ALGORITHMS_TRACE_COUNT(name, amount) ((void)0)
+#define ALGORITHMS_TRACE_DEPTH(name) ((void)0)
+
+	inline std::vector<CounterTotal> counters()
+	{
+		return {};
+	}
+
+	inline size_t event_count() noexcept
+	{
+		return 0;
+	}
+
+	inline void write_chrome_trace(std::ostream& stream)
+	{
+		stream << "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":\"0\"}}\n";
+	}
+
+	inline void reset() noexcept {}
+#endif
+}
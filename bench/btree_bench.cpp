@@ -0,0 +1,128 @@
+// Measures BTree.h's B+ tree against std::map for random inserts, lookups of present and missing
+// keys, full scans, short range scans, and building from sorted keys, with 64-bit keys and values,
+// and times the node traversals.
+// Usage: btree_bench [scale]
+// The scale multiplies the count of 4 million keys (default 1).
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../Algorithms/BTree.h"
+
+// Runs f and returns how many seconds it took.
+template <class Function>
+double time_seconds(Function f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prints the time per operation of the std::map and the B+ tree, and the checksums that show
+// both did the same work.
+void report(const char* label, size_t operations, double map_seconds, std::uint64_t map_sum, double tree_seconds, std::uint64_t tree_sum)
+{
+	std::printf("%-22s std::map %8.1f ns  BTree %8.1f ns  %5.2fx  checksums %s\n", label,
+		map_seconds * 1e9 / operations, tree_seconds * 1e9 / operations, map_seconds / tree_seconds,
+		map_sum == tree_sum ? "match" : "DIFFER");
+}
+
+int main(int argc, char* argv[])
+{
+	const double scale = argc > 1 ? std::atof(argv[1]) : 1;
+	const size_t count = size_t(4000000 * scale);
+	std::mt19937_64 random(20210620);
+	std::vector<std::uint64_t> keys(count);
+	for (std::uint64_t& key : keys)
+		key = random() >> 1;
+	std::vector<std::uint64_t> queries(count);
+	for (size_t i = 0; i < count; i++)
+		queries[i] = i % 2 ? keys[random() % count] : random() >> 1;  // Half are likely missing.
+	std::printf("%zu keys, up to %zu keys per node\n", count, BTree<std::uint64_t, std::uint64_t>::node_capacity);
+
+	std::map<std::uint64_t, std::uint64_t> map;
+	BTree<std::uint64_t, std::uint64_t> tree;
+	double map_seconds = time_seconds([&] { for (std::uint64_t key : keys) map.insert({ key, key }); });
+	double tree_seconds = time_seconds([&] { for (std::uint64_t key : keys) tree.insert(key, key); });
+	report("random inserts", count, map_seconds, map.size(), tree_seconds, tree.size());
+
+	std::uint64_t map_sum = 0;
+	std::uint64_t tree_sum = 0;
+	map_seconds = time_seconds([&]
+		{
+			for (std::uint64_t key : queries)
+			{
+				auto it = map.find(key);
+				map_sum += it == map.end() ? 1 : it->second;
+			}
+		});
+	tree_seconds = time_seconds([&]
+		{
+			for (std::uint64_t key : queries)
+			{
+				auto it = tree.find(key);
+				tree_sum += it == tree.end() ? 1 : it.value();
+			}
+		});
+	report("random lookups", count, map_seconds, map_sum, tree_seconds, tree_sum);
+
+	map_sum = tree_sum = 0;
+	map_seconds = time_seconds([&] { for (const auto& [key, value] : map) map_sum += value; });
+	tree_seconds = time_seconds([&] { tree.inorder([&](std::uint64_t, std::uint64_t value) { tree_sum += value; }); });
+	report("full scan", count, map_seconds, map_sum, tree_seconds, tree_sum);
+
+	// The node traversals, which add up the leaves' key counts. The count is atomic for the
+	// parallel traversal, and the others use the same one to be comparable.
+	size_t nodes = 0;
+	tree.preorder([&](auto, size_t) { nodes += 1; });
+	const auto traverse = [&](const char* label, auto traversal)
+		{
+			std::atomic<std::uint64_t> keys_seen = 0;
+			const double seconds = time_seconds([&]
+				{
+					traversal([&](BTree<std::uint64_t, std::uint64_t>::NodeView node, size_t)
+						{
+							if (node.is_leaf())
+								keys_seen += node.key_count();
+						});
+				});
+			std::printf("%-22s %8.1f ns per node  checksum %s\n", label, seconds * 1e9 / nodes, keys_seen == tree.size() ? "match" : "DIFFER");
+		};
+	traverse("preorder nodes", [&](auto visit) { tree.preorder(visit); });
+	traverse("postorder nodes", [&](auto visit) { tree.postorder(visit); });
+	traverse("level order nodes", [&](auto visit) { tree.level_order(visit); });
+	traverse("parallel level order", [&](auto visit) { tree.parallel_level_order(visit); });
+
+	// Scans of about 100 keys each, starting at random keys.
+	const size_t range_count = count / 100 + 1;
+	const std::uint64_t width = (std::uint64_t(1) << 63) / count * 100;
+	map_sum = tree_sum = 0;
+	map_seconds = time_seconds([&]
+		{
+			for (size_t i = 0; i < range_count; i++)
+			{
+				const std::uint64_t low = queries[i];
+				for (auto it = map.lower_bound(low); it != map.end() && it->first < low + width; ++it)
+					map_sum += it->second;
+			}
+		});
+	tree_seconds = time_seconds([&]
+		{
+			for (size_t i = 0; i < range_count; i++)
+				tree.scan(queries[i], queries[i] + width, [&](std::uint64_t, std::uint64_t value) { tree_sum += value; });
+		});
+	report("range scans of ~100", range_count, map_seconds, map_sum, tree_seconds, tree_sum);
+
+	// Both are built from the same sorted pairs: std::map with hints at the end, and the tree in bulk.
+	std::vector<std::pair<std::uint64_t, std::uint64_t>> sorted(map.begin(), map.end());
+	map.clear();
+	tree.clear();
+	map_seconds = time_seconds([&] { for (const auto& pair : sorted) map.insert(map.end(), pair); });
+	tree_seconds = time_seconds([&] { tree = BTree<std::uint64_t, std::uint64_t>::from_sorted(sorted.begin(), sorted.end()); });
+	report("build from sorted", sorted.size(), map_seconds, map.size(), tree_seconds, tree.size());
+}
@@ -0,0 +1,70 @@
+// Measures how parallel delta-stepping scales with the number of threads, compared with a
+// sequential shortest path tree, on grid, road-like and power-law random graphs.
+// Usage: delta_stepping_bench [scale] [max threads]
+// The scale multiplies each graph's vertex count (default 1), and the thread counts double from 1
+// up to the hardware's thread count by default.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "graph_generators.h"
+#include "../Algorithms/delta_stepping.h"
+#include "../Algorithms/ThreadPool.h"
+
+using GraphGenerators::Graph;
+
+const std::uint32_t sources[] = { 0, 7919, 104729 };
+
+// Runs a full search from each source and returns the average time per search in milliseconds.
+// The checksum of the reachable vertexes' costs shows that every search found the same costs.
+template <class Search>
+double time_searches(const Graph& graph, Search search, long long& checksum)
+{
+	checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (std::uint32_t source : sources)
+	{
+		const auto tree = search(source % graph.vertex_count());
+		for (int cost : tree.costs)
+			if (cost != Dijkstra::unreachable_cost<int>())
+				checksum += cost;
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / std::size(sources);
+}
+
+void bench(const char* name, const Graph& graph, size_t max_threads)
+{
+	std::printf("%s: %u vertexes, %llu edges\n", name, unsigned(graph.vertex_count()), (unsigned long long)graph.edge_count());
+	long long checksum = 0;
+	const double sequential = time_searches(graph, [&](std::uint32_t source)
+		{ return Dijkstra::shortest_path_tree_ids(graph, source); }, checksum);
+	std::printf("  %-28s %10.2f ms/search  checksum %lld\n", "sequential dijkstra", sequential, checksum);
+	for (int delta : { 0, 10, 100 })
+	{
+		for (size_t threads = 1; threads <= max_threads; threads *= 2)
+		{
+			ThreadPool pool(threads - 1);
+			const double elapsed = time_searches(graph, [&](std::uint32_t source)
+				{ return Dijkstra::delta_stepping_ids(graph, source, delta, pool); }, checksum);
+			char label[64];
+			std::snprintf(label, sizeof label, "delta %d, %zu threads", delta, threads);
+			std::printf("  %-28s %10.2f ms/search  %5.2fx  checksum %lld\n", label, elapsed, sequential / elapsed, checksum);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const double scale = argc > 1 ? std::atof(argv[1]) : 1;
+	const unsigned hardware_threads = std::thread::hardware_concurrency();
+	const size_t max_threads = argc > 2 ? size_t(std::atoi(argv[2])) : (hardware_threads ? hardware_threads : 1);
+	const std::uint32_t side = std::uint32_t(std::sqrt(1000000 * scale));
+	bench("grid", GraphGenerators::grid(side, 100, 1), max_threads);
+	bench("road-like", GraphGenerators::road_like(side, 2), max_threads);
+	bench("power-law", GraphGenerators::power_law(std::uint32_t(1000000 * scale), size_t(8000000 * scale), 2.1, 100, 3), max_threads);
+}
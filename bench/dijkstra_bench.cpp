@@ -0,0 +1,125 @@
+// Compares Dijkstra's algorithm's priority queues, its bidirectional and A* variants, and
+// contraction hierarchy queries on grid, road-like and power-law random graphs.
+// Usage: dijkstra_bench [scale]
+// The scale multiplies each graph's vertex count (default 1).
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph_generators.h"
+#include "../Algorithms/astar.h"
+#include "../Algorithms/ContractionHierarchy.h"
+#include "../Algorithms/PriorityQueues.h"
+
+using GraphGenerators::Graph;
+using Queries = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+Queries make_queries(const Graph& graph, size_t count, std::uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<std::uint32_t> vertex(0, graph.vertex_count() - 1);
+	Queries queries;
+	for (size_t i = 0; i < count; i++)
+		queries.push_back({ vertex(random), vertex(random) });
+	return queries;
+}
+
+// The cost a search returns, either alone or with its path.
+int result_cost(int cost)
+{
+	return cost;
+}
+
+int result_cost(const Dijkstra::Path<std::uint32_t, int>& path)
+{
+	return path.cost;
+}
+
+// Runs every query with one search function and prints the average time per query.
+template <class Search>
+void bench_search(const char* search_name, const Queries& queries, Search search)
+{
+	long long checksum = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& [source, target] : queries)
+	{
+		try
+		{
+			checksum += result_cost(search(source, target));
+		}
+		catch (std::invalid_argument&)
+		{
+			checksum -= 1;
+		}
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::printf("  %-22s %10.3f ms/query  checksum %lld\n", search_name, elapsed.count() / queries.size(), checksum);
+}
+
+// Runs every query with one queue type and prints the average time per query.
+// The checksum of the path costs shows that every queue found the same paths.
+// Every queue searches in one reused workspace, first warmed up on separate queries, so that
+// the times compare the queues rather than allocating and clearing arrays the size of the graph.
+template <class Queue>
+void bench(const char* queue_name, const Graph& graph, const Queries& warm_ups, const Queries& queries)
+{
+	Dijkstra::DijkstraWorkspace<std::uint32_t, int, Queue> workspace(graph);
+	std::vector<std::uint32_t> path;
+	auto search = [&](std::uint32_t source, std::uint32_t target)
+	{
+		const int cost = workspace.query(source, target);
+		if (cost == Dijkstra::unreachable_cost<int>())
+			throw std::invalid_argument("No path found.");
+		workspace.path_to(target, path);
+		return cost;
+	};
+	for (const auto& [source, target] : warm_ups)
+		workspace.query(source, target);
+	bench_search(queue_name, queries, search);
+}
+
+void bench_all(const char* graph_name, const Graph& graph, bool contract)
+{
+	std::printf("%s: %u vertexes, %llu edges\n", graph_name, unsigned(graph.vertex_count()), (unsigned long long)graph.edge_count());
+	const Queries queries = make_queries(graph, 40, 7);
+	const Queries warm_ups = make_queries(graph, 10, 8);
+	bench<LazyBinaryHeap<int>>("lazy binary heap", graph, warm_ups, queries);
+	bench<IndexedDaryHeap<int, 2>>("indexed binary heap", graph, warm_ups, queries);
+	bench<IndexedDaryHeap<int, 4>>("indexed 4-ary heap", graph, warm_ups, queries);
+	bench<PairingHeap<int>>("pairing heap", graph, warm_ups, queries);
+	bench<RadixHeap<int>>("radix heap", graph, warm_ups, queries);
+	bench<DialBuckets<int>>("Dial's buckets", graph, warm_ups, queries);
+
+	const Graph reverse = graph.reversed();
+	bench_search("bidirectional", queries, [&](std::uint32_t source, std::uint32_t target)
+		{ return Dijkstra::bidirectional_dijkstra_ids(graph, reverse, source, target); });
+	const Dijkstra::LandmarkHeuristic<std::uint32_t, int> landmarks(graph, 8);
+	bench_search("A* with 8 landmarks", queries, [&](std::uint32_t source, std::uint32_t target)
+		{ return Dijkstra::astar_ids(graph, source, target, landmarks); });
+
+	// Contraction hierarchies are meant for road networks; hubs make them slow to build.
+	if (!contract)
+		return;
+	const auto start = std::chrono::steady_clock::now();
+	const Dijkstra::ContractionHierarchy<std::uint32_t, int> hierarchy(graph);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::printf("  contraction hierarchy built in %.2f s with %zu shortcuts\n", elapsed.count(), hierarchy.shortcut_count());
+	Dijkstra::ContractionHierarchy<std::uint32_t, int>::Workspace workspace(hierarchy.vertex_count());
+	bench_search("contraction hierarchy", queries, [&](std::uint32_t source, std::uint32_t target)
+		{ return hierarchy.query_ids(workspace, source, target); });
+}
+
+int main(int argc, char* argv[])
+{
+	const double scale = argc > 1 ? std::atof(argv[1]) : 1;
+	const std::uint32_t side = std::uint32_t(300 * std::sqrt(scale));
+	bench_all("grid, costs 1-100", GraphGenerators::grid(side, 100, 1), true);
+	bench_all("grid, costs 1-5", GraphGenerators::grid(side, 5, 2), true);
+	bench_all("road-like", GraphGenerators::road_like(side, 3), true);
+	bench_all("power-law", GraphGenerators::power_law(std::uint32_t(100000 * scale), size_t(1000000 * scale), 2.5, 1000, 4), false);
+}
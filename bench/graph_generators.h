@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "../Algorithms/dijkstra.h"
+
+// Random graphs for benchmarks, named by their vertex IDs.
+namespace GraphGenerators
+{
+	using Graph = Dijkstra::CsrGraph<std::uint32_t, int>;
+	using Edge = Graph::Edge;
+
+	inline Graph make_graph(std::uint32_t vertex_count, const std::vector<Edge>& edges)
+	{
+		std::vector<std::uint32_t> names(vertex_count);
+		std::iota(names.begin(), names.end(), 0);
+		return Graph(std::move(names), edges);
+	}
+
+	// Adds edges in both directions between two vertexes.
+	inline void connect(std::vector<Edge>& edges, std::uint32_t a, std::uint32_t b, int cost)
+	{
+		edges.push_back({ a, b, cost });
+		edges.push_back({ b, a, cost });
+	}
+
+	// Returns a side by side square grid where each vertex connects to its 4 neighbors with
+	// uniformly random costs from 1 to max_cost.
+	inline Graph grid(std::uint32_t side, int max_cost, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<int> cost(1, max_cost);
+		std::vector<Edge> edges;
+		edges.reserve(size_t(side) * side * 4);
+		for (std::uint32_t y = 0; y < side; y++)
+			for (std::uint32_t x = 0; x < side; x++)
+			{
+				const std::uint32_t v = y * side + x;
+				if (x + 1 < side)
+					connect(edges, v, v + 1, cost(random));
+				if (y + 1 < side)
+					connect(edges, v, v + side, cost(random));
+			}
+		return make_graph(side * side, edges);
+	}
+
+	// Returns a graph shaped like a road network: intersections at jittered grid points,
+	// most neighboring intersections joined by local roads, every 32nd row and column a highway
+	// that is 4 times faster, and costs proportional to travel time. Degrees are low and
+	// distances are roughly Euclidean, like a real road map.
+	inline Graph road_like(std::uint32_t side, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<double> jitter(-0.35, 0.35);
+		std::bernoulli_distribution has_road(0.85);
+		std::vector<double> xs(size_t(side) * side), ys(size_t(side) * side);
+		for (size_t v = 0; v < xs.size(); v++)
+		{
+			xs[v] = double(v % side) + jitter(random);
+			ys[v] = double(v / side) + jitter(random);
+		}
+		auto travel_cost = [&](std::uint32_t a, std::uint32_t b, bool highway)
+		{
+			const double distance = std::hypot(xs[a] - xs[b], ys[a] - ys[b]);
+			return std::max(1, int(std::lround(distance * 100 / (highway ? 4 : 1))));
+		};
+		std::vector<Edge> edges;
+		edges.reserve(xs.size() * 4);
+		for (std::uint32_t y = 0; y < side; y++)
+			for (std::uint32_t x = 0; x < side; x++)
+			{
+				const std::uint32_t v = y * side + x;
+				const bool row_highway = y % 32 == 0;
+				const bool column_highway = x % 32 == 0;
+				if (x + 1 < side && (row_highway || has_road(random)))
+					connect(edges, v, v + 1, travel_cost(v, v + 1, row_highway));
+				if (y + 1 < side && (column_highway || has_road(random)))
+					connect(edges, v, v + side, travel_cost(v, v + side, column_highway));
+			}
+		return make_graph(side * side, edges);
+	}
+
+	// Returns a directed Chung-Lu random graph whose degrees follow a power law with the given
+	// exponent, like social and web graphs: a few hubs have most of the edges.
+	inline Graph power_law(std::uint32_t vertex_count, size_t edge_count, double exponent, int max_cost, std::uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		std::vector<double> weights(vertex_count);
+		for (std::uint32_t v = 0; v < vertex_count; v++)
+			weights[v] = std::pow(double(v) + 1, -1 / (exponent - 1));
+		std::discrete_distribution<std::uint32_t> endpoint(weights.begin(), weights.end());
+		std::uniform_int_distribution<int> cost(1, max_cost);
+		std::vector<Edge> edges;
+		edges.reserve(edge_count);
+		for (size_t i = 0; i < edge_count; i++)
+			edges.push_back({ endpoint(random), endpoint(random), cost(random) });
+		return make_graph(vertex_count, edges);
+	}
+}
@@ -0,0 +1,151 @@
+// Measures the searches of matrix_search.h on a square matrix of 32-bit integers and on a wide
+// matrix with as many items, and how fast load_matrix reads the square one from binary and text
+// files compared with reading the text a line at a time with a string stream.
+// Usage: matrix_search_bench [side] [query count] [max threads]
+// The square matrix is side by side items (default 50000, which takes 10 GB), and the thread
+// counts double from 1 up to the hardware's thread count by default.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Algorithms/matrix_search.h"
+#include "../Algorithms/ThreadPool.h"
+
+// Runs f and returns how many seconds it took.
+template <class Function>
+double time_seconds(Function f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Returns a matrix whose rows and columns are sorted, where each item is one of the items above
+// and to its left plus 0 to 2.
+std::vector<std::int32_t> make_matrix(size_t rows, size_t cols, std::mt19937_64& random)
+{
+	std::vector<std::int32_t> matrix(rows * cols);
+	for (size_t row = 0; row < rows; row++)
+		for (size_t col = 0; col < cols; col++)
+		{
+			const std::int32_t above = row > 0 ? matrix[(row - 1) * cols + col] : 0;
+			const std::int32_t left = col > 0 ? matrix[row * cols + col - 1] : 0;
+			matrix[row * cols + col] = std::max(above, left) + std::int32_t(random() % 3);
+		}
+	return matrix;
+}
+
+// Adds up the found positions, which shows that every search found the same items.
+size_t checksum(const std::vector<std::optional<MatrixPosition>>& results)
+{
+	size_t sum = 0;
+	for (const std::optional<MatrixPosition>& result : results)
+		sum += result ? result->row + result->col + 1 : 0;
+	return sum;
+}
+
+void report(const char* label, double seconds, size_t queries, size_t sum)
+{
+	std::printf("  %-42s %10.3f us per query  checksum %zu\n", label, seconds * 1e6 / queries, sum);
+}
+
+void bench(const char* name, size_t rows, size_t cols, size_t query_count, size_t max_threads, std::mt19937_64& random)
+{
+	const std::vector<std::int32_t> matrix = make_matrix(rows, cols, random);
+	std::vector<std::int32_t> queries(query_count);
+	for (std::int32_t& query : queries)
+		query = std::int32_t(random() % (std::uint64_t(matrix.back()) + 2));
+	std::printf("%s: %zu x %zu matrix, %zu queries\n", name, rows, cols, query_count);
+
+	std::vector<std::optional<MatrixPosition>> results(query_count);
+	double seconds = time_seconds([&]
+		{
+			for (size_t i = 0; i < query_count; i++)
+				results[i] = staircase_search(matrix.data(), rows, cols, queries[i]);
+		});
+	report("staircase_search", seconds, query_count, checksum(results));
+	seconds = time_seconds([&]
+		{
+			for (size_t i = 0; i < query_count; i++)
+				results[i] = divide_and_conquer_search(matrix.data(), rows, cols, queries[i]);
+		});
+	// The two searches may find different positions of repeated items, so count the found ones.
+	size_t found = 0;
+	for (size_t i = 0; i < query_count; i++)
+		found += results[i] && matrix[results[i]->row * cols + results[i]->col] == queries[i];
+	std::printf("  %-42s %10.3f us per query  found %zu\n", "divide_and_conquer_search", seconds * 1e6 / query_count, found);
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		ThreadPool pool(threads - 1);
+		seconds = time_seconds([&] { divide_and_conquer_search_batch(matrix.data(), rows, cols, queries.data(), query_count, results.data(), pool); });
+		found = 0;
+		for (size_t i = 0; i < query_count; i++)
+			found += results[i] && matrix[results[i]->row * cols + results[i]->col] == queries[i];
+		char label[64];
+		std::snprintf(label, sizeof label, "divide_and_conquer_search_batch, %zu threads", threads);
+		std::printf("  %-42s %10.3f us per query  found %zu\n", label, seconds * 1e6 / query_count, found);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const size_t side = argc > 1 ? size_t(std::atoll(argv[1])) : 50000;
+	const size_t query_count = argc > 2 ? size_t(std::atoll(argv[2])) : 1000;
+	const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t max_threads = argc > 3 ? size_t(std::atoi(argv[3])) : hardware_threads;
+	std::mt19937_64 random(20210620);
+	bench("square", side, side, query_count, max_threads, random);
+	bench("wide", 16, side * side / 16, query_count, max_threads, random);
+
+	// Write the square matrix to binary and text files and read them back.
+	const std::vector<std::int32_t> matrix = make_matrix(side, side, random);
+	const std::filesystem::path directory = std::filesystem::temp_directory_path();
+	const std::string binary_path = (directory / "matrix_search_bench.bin").string();
+	const std::string text_path = (directory / "matrix_search_bench.txt").string();
+	{
+		std::ofstream binary(binary_path, std::ios::binary);
+		write_matrix(binary, matrix.data(), side, side);
+		std::ofstream text(text_path, std::ios::binary);
+		text << side << ' ' << side << '\n';
+		for (size_t row = 0; row < side; row++)
+		{
+			std::string line;
+			for (size_t col = 0; col < side; col++)
+				line += (col > 0 ? " " : "") + std::to_string(matrix[row * side + col]);
+			text << line << '\n';
+		}
+	}
+	std::printf("loading the square matrix, %.1f MB of text\n", std::filesystem::file_size(text_path) / 1e6);
+	auto same = [&](const std::int32_t* items) { return std::equal(matrix.begin(), matrix.end(), items) ? "match" : "DIFFER"; };
+	LoadedMatrix<std::int32_t> loaded;
+	double seconds = time_seconds([&] { loaded = load_matrix<std::int32_t>(binary_path); });
+	std::printf("  %-42s %10.3f s  items %s\n", "load_matrix, binary", seconds, same(loaded.items));
+	seconds = time_seconds([&] { loaded = load_matrix<std::int32_t>(text_path); });
+	std::printf("  %-42s %10.3f s  items %s\n", "load_matrix, text", seconds, same(loaded.items));
+	std::vector<std::int32_t> parsed;
+	seconds = time_seconds([&]
+		{
+			std::ifstream text(text_path);
+			std::string line;
+			std::getline(text, line);
+			while (std::getline(text, line))
+			{
+				std::istringstream numbers(line);
+				std::int32_t number;
+				while (numbers >> number)
+					parsed.push_back(number);
+			}
+		});
+	std::printf("  %-42s %10.3f s  items %s\n", "line by line with istringstream", seconds, same(parsed.data()));
+	std::filesystem::remove(binary_path);
+	std::filesystem::remove(text_path);
+}
@@ -0,0 +1,144 @@
+// Measures how fast text with one number per line is parsed and formatted by number_text.h,
+// compared with string streams and a plain std::from_chars loop, for 64-bit unsigned integers,
+// 32-bit signed integers, and doubles.
+// Usage: number_text_bench [scale] [max threads]
+// The scale multiplies the count of 4 million numbers of each type (default 1), and the thread
+// counts double from 1 up to the hardware's thread count by default.
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Algorithms/number_text.h"
+#include "../Algorithms/ThreadPool.h"
+
+// Runs f and returns how many seconds it took.
+template <class Function>
+double time_seconds(Function f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Adds up the numbers, which shows that every parser read the same ones.
+template <class T>
+double checksum(const std::vector<T>& numbers)
+{
+	double sum = 0;
+	for (T number : numbers)
+		sum += double(number);
+	return sum;
+}
+
+void report(const char* label, double seconds, size_t bytes, double sum)
+{
+	std::printf("  %-28s %8.3f s %8.3f GB/s  checksum %.6g\n", label, seconds, bytes / seconds / 1e9, sum);
+}
+
+template <class T>
+void bench(const char* name, const std::vector<T>& numbers, size_t max_threads)
+{
+	// Print every digit that format_number would, so that both write the same numbers.
+	std::ostringstream stream;
+	stream << std::setprecision(std::numeric_limits<T>::max_digits10);
+	for (T number : numbers)
+		stream << number << '\n';
+	const std::string text = stream.str();
+	std::printf("%s: %zu numbers, %.1f MB of text\n", name, numbers.size(), text.size() / 1e6);
+
+	std::vector<T> parsed;
+	double seconds = time_seconds([&]
+		{
+			std::istringstream input(text);
+			T number;
+			while (input >> number)
+				parsed.push_back(number);
+		});
+	report("istringstream >>", seconds, text.size(), checksum(parsed));
+
+	seconds = time_seconds([&]
+		{
+			parsed.clear();
+			const char* first = text.data();
+			const char* const last = text.data() + text.size();
+			T number;
+			while (first < last)
+			{
+				first = std::from_chars(first, last, number).ptr + 1;
+				parsed.push_back(number);
+			}
+		});
+	report("std::from_chars loop", seconds, text.size(), checksum(parsed));
+
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		ThreadPool pool(threads - 1);
+		parsed.clear();
+		seconds = time_seconds([&] { parse_numbers(text.data(), text.size(), parsed, pool); });
+		char label[64];
+		std::snprintf(label, sizeof label, "parse_numbers, %zu threads", threads);
+		report(label, seconds, text.size(), checksum(parsed));
+	}
+
+	// Format into a temporary file, which the operating system mostly keeps in memory.
+	std::FILE* file = std::tmpfile();
+	if (!file)
+	{
+		std::fprintf(stderr, "Unable to create a temporary file.\n");
+		std::exit(1);
+	}
+	seconds = time_seconds([&]
+		{
+			std::ostringstream output;
+			output << std::setprecision(std::numeric_limits<T>::max_digits10);
+			for (T number : numbers)
+				output << number << '\n';
+			std::fwrite(output.str().data(), 1, output.str().size(), file);
+		});
+	report("ostringstream <<", seconds, text.size(), checksum(numbers));
+	for (size_t threads = 1; threads <= max_threads; threads *= 2)
+	{
+		ThreadPool pool(threads - 1);
+		std::rewind(file);
+		seconds = time_seconds([&] { write_numbers(file, numbers.data(), numbers.size(), pool); });
+		char label[64];
+		std::snprintf(label, sizeof label, "write_numbers, %zu threads", threads);
+		report(label, seconds, text.size(), checksum(numbers));
+	}
+	std::fclose(file);
+}
+
+int main(int argc, char* argv[])
+{
+	const double scale = argc > 1 ? std::atof(argv[1]) : 1;
+	const size_t hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+	const size_t max_threads = argc > 2 ? size_t(std::atoi(argv[2])) : hardware_threads;
+	const size_t count = size_t(4000000 * scale);
+
+	std::mt19937_64 random(20210620);
+	std::vector<std::uint64_t> unsigned_numbers(count);
+	for (std::uint64_t& number : unsigned_numbers)
+		number = random() >> (random() % 64);  // All lengths, from 1 to 20 digits.
+	bench("u64", unsigned_numbers, max_threads);
+
+	std::uniform_int_distribution<std::int32_t> int_distribution(std::numeric_limits<std::int32_t>::min());
+	std::vector<std::int32_t> int_numbers(count);
+	for (std::int32_t& number : int_numbers)
+		number = int_distribution(random);
+	bench("i32", int_numbers, max_threads);
+
+	std::lognormal_distribution<double> double_distribution(0, 4);
+	std::vector<double> double_numbers(count);
+	for (double& number : double_numbers)
+		number = double_distribution(random);
+	bench("f64", double_numbers, max_threads);
+}
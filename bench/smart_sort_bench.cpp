@@ -0,0 +1,168 @@
+// Times each of smart_sort.h's strategies on 64-bit integers and doubles in several orders, fits
+// the cost model's coefficients to the times, and then shows which strategy smart_sort picks for
+// each set of items with the fitted model, how long it takes, and how that compares with the
+// fastest strategy.
+// Usage: smart_sort_bench [scale] [threads]
+// The scale multiplies the count of 4 million items (default 1), and the threads default to the
+// hardware's thread count.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Algorithms/smart_sort.h"
+#include "../Algorithms/ThreadPool.h"
+
+// Runs f and returns how many seconds it took.
+template <class Function>
+double time_seconds(Function f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The times of each strategy on one set of items, in nanoseconds per item.
+struct Times
+{
+	std::string name;
+	std::array<double, sort_strategy_count> ns{};
+	double smart_ns = 0;
+	SortStrategy smart_choice = SortStrategy::introsort;
+};
+
+// Sorts copies of the items with each strategy, checking that they all agree, and then with
+// smart_sort and the model. Each is timed twice, and the faster time is kept.
+template <class T>
+Times time_strategies(const char* name, const std::vector<T>& items, ThreadPool& pool, const SortCostModel& model)
+{
+	Times times;
+	times.name = name;
+	times.ns.fill(std::numeric_limits<double>::infinity());
+	std::vector<T> expected = items;
+	std::sort(expected.begin(), expected.end());
+	std::vector<T> copy;
+	for (size_t strategy = 0; strategy < sort_strategy_count; strategy++)
+	{
+		if (SortStrategy(strategy) == SortStrategy::insertion || (SortStrategy(strategy) == SortStrategy::parallel && pool.concurrency() == 1))
+			continue;
+		for (int repeat = 0; repeat < 2; repeat++)
+		{
+			copy = items;
+			const double seconds = time_seconds([&] { sort_by_strategy(SortStrategy(strategy), copy.data(), copy.size(), pool); });
+			times.ns[strategy] = std::min(times.ns[strategy], seconds * 1e9 / double(items.size()));
+			if (copy != expected)
+				std::printf("%s: %s sorted wrongly\n", name, sort_strategy_name(SortStrategy(strategy)));
+		}
+	}
+	times.smart_ns = std::numeric_limits<double>::infinity();
+	for (int repeat = 0; repeat < 2; repeat++)
+	{
+		copy = items;
+		const double seconds = time_seconds([&] { times.smart_choice = smart_sort(copy.data(), copy.size(), pool, model).strategy; });
+		times.smart_ns = std::min(times.smart_ns, seconds * 1e9 / double(items.size()));
+		if (copy != expected)
+			std::printf("%s: smart_sort sorted wrongly\n", name);
+	}
+	return times;
+}
+
+int main(int argc, char* argv[])
+{
+	const double scale = argc > 1 ? std::atof(argv[1]) : 1;
+	const size_t count = size_t(4000000 * scale);
+	const size_t threads = argc > 2 ? size_t(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+	ThreadPool pool(threads - 1);
+	std::mt19937_64 random(20210620);
+
+	std::vector<std::uint64_t> random_items(count);
+	for (std::uint64_t& item : random_items)
+		item = random();
+	std::vector<std::uint64_t> narrow(count);
+	for (std::uint64_t& item : narrow)
+		item = random() % 65536;
+	std::vector<std::uint64_t> sorted = random_items;
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<std::uint64_t> reversed(sorted.rbegin(), sorted.rend());
+	std::vector<std::uint64_t> nearly_sorted = sorted;
+	for (size_t i = 0; i < count / 1000; i++)
+		std::swap(nearly_sorted[random() % count], nearly_sorted[random() % count]);
+	std::vector<std::uint64_t> runs = random_items;
+	for (size_t run = 0; run < 64; run++)
+		std::sort(runs.begin() + count * run / 64, runs.begin() + count * (run + 1) / 64);
+	std::vector<double> doubles(count);
+	for (double& item : doubles)
+		item = std::normal_distribution<double>(0, 1e6)(random);
+	std::printf("%zu items, %zu threads\n", count, pool.concurrency());
+
+	// Fit the model to the times on random, narrow, sorted, and runs of sorted items, after a
+	// round that only warms up the caches and the allocator.
+	SortCostModel model;
+	const double n = double(count);
+	time_strategies("warm-up", random_items, pool, model);
+	const Times random_times = time_strategies("random u64", random_items, pool, model);
+	const Times narrow_times = time_strategies("u64 below 65536", narrow, pool, model);
+	const Times sorted_times = time_strategies("sorted u64", sorted, pool, model);
+	const Times runs_times = time_strategies("64 sorted runs of u64", runs, pool, model);
+	auto ns = [](const Times& times, SortStrategy strategy) { return times.ns[size_t(strategy)]; };
+	const SortDecision narrow_decision = choose_sort(narrow.data(), narrow.size(), pool.concurrency(), model);
+	model.introsort_per_level = ns(random_times, SortStrategy::introsort) / std::log2(n);
+	model.presorted_discount = std::clamp(1 - ns(sorted_times, SortStrategy::introsort) / ns(random_times, SortStrategy::introsort), 0.0, 0.95);
+	// At small scales the narrow items may barely repeat, and dividing by a ratio near 0 would
+	// give a meaningless discount, so the default is kept then.
+	const double min_duplicate_ratio = 0.05;
+	if (narrow_decision.profile.duplicate_ratio >= min_duplicate_ratio)
+		model.duplicate_discount = std::clamp((1 - ns(narrow_times, SortStrategy::introsort) / ns(random_times, SortStrategy::introsort))
+			/ narrow_decision.profile.duplicate_ratio, 0.0, 0.95);
+	else
+		std::printf("the narrow items' duplicate ratio of %.3f is too low to fit duplicate_discount, so it keeps its default\n",
+			narrow_decision.profile.duplicate_ratio);
+	const double wide_passes = 8;
+	const double narrow_passes = double(narrow_decision.profile.radix_passes);
+	model.radix_per_pass = (ns(random_times, SortStrategy::radix) - ns(narrow_times, SortStrategy::radix)) / (wide_passes - narrow_passes);
+	model.radix_fixed = std::max(0.0, ns(narrow_times, SortStrategy::radix) - narrow_passes * model.radix_per_pass);
+	model.merge_fixed = ns(sorted_times, SortStrategy::adaptive_merge);
+	model.merge_per_level = (ns(runs_times, SortStrategy::adaptive_merge) - model.merge_fixed) / std::log2(64.0);
+	model.merge_short_runs = std::max(0.0, ns(random_times, SortStrategy::adaptive_merge) - model.merge_fixed
+		- model.merge_per_level * std::ceil(std::log2(n / 32)));
+	if (pool.concurrency() > 1)
+	{
+		const double p = double(pool.concurrency());
+		const double run_ns = ns(random_times, SortStrategy::parallel) * n - n * model.merge_per_level * std::ceil(std::log2(p)) - model.parallel_fixed_ns;
+		model.parallel_efficiency = std::clamp(n / p * model.introsort_per_level * std::log2(n / p) / run_ns, 0.05, 1.0);
+	}
+	std::printf("fitted cost model, in ns per item:\n"
+		"  radix_fixed = %.2f\n  radix_per_pass = %.2f\n  introsort_per_level = %.2f\n  presorted_discount = %.2f\n"
+		"  duplicate_discount = %.2f\n  merge_fixed = %.2f\n  merge_short_runs = %.2f\n  merge_per_level = %.2f\n  parallel_efficiency = %.2f\n",
+		model.radix_fixed, model.radix_per_pass, model.introsort_per_level, model.presorted_discount,
+		model.duplicate_discount, model.merge_fixed, model.merge_short_runs, model.merge_per_level, model.parallel_efficiency);
+
+	// Time smart_sort with the fitted model on every set of items.
+	std::vector<Times> all = {
+		time_strategies("random u64", random_items, pool, model),
+		time_strategies("u64 below 65536", narrow, pool, model),
+		time_strategies("sorted u64", sorted, pool, model),
+		time_strategies("reversed u64", reversed, pool, model),
+		time_strategies("nearly sorted u64", nearly_sorted, pool, model),
+		time_strategies("64 sorted runs of u64", runs, pool, model),
+		time_strategies("normal doubles", doubles, pool, model),
+	};
+	std::printf("\n%-22s %9s %9s %9s %9s   %-14s %9s %s\n", "ns per item", "radix", "merge", "introsort", "parallel", "smart choice", "smart", "vs fastest");
+	size_t fastest_count = 0;
+	for (const Times& times : all)
+	{
+		const size_t fastest = size_t(std::min_element(times.ns.begin(), times.ns.end()) - times.ns.begin());
+		fastest_count += size_t(times.smart_choice) == fastest;
+		std::printf("%-22s %9.2f %9.2f %9.2f %9.2f   %-14s %9.2f %.2fx\n", times.name.c_str(),
+			ns(times, SortStrategy::radix), ns(times, SortStrategy::adaptive_merge), ns(times, SortStrategy::introsort),
+			ns(times, SortStrategy::parallel), sort_strategy_name(times.smart_choice), times.smart_ns, times.smart_ns / times.ns[fastest]);
+	}
+	std::printf("smart_sort chose the fastest strategy for %zu of %zu sets\n", fastest_count, all.size());
+}
@@ -0,0 +1,123 @@
+// Measures the throughput and memory allocations of Dijkstra queries with and without a reusable
+// DijkstraWorkspace on a grid graph with random costs.
+// Usage: workspace_bench [side] [queries]
+// The grid is side by side vertexes (default 300), and 2000 queries run by default, after a
+// quarter as many different queries that warm up every search the same way.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph_generators.h"
+
+// Every allocation in the program goes through these, so they count them. GCC can see through
+// them to malloc and free, and then wrongly warns that news and deletes are mismatched.
+#if defined(__GNUC__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+std::atomic<size_t> allocation_count{ 0 };
+
+void* operator new(std::size_t size)
+{
+	allocation_count += 1;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+using GraphGenerators::Graph;
+
+using Queries = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+// Runs the warm-up queries untimed, and then runs every query and prints the queries per second
+// and allocations per query. Every search gets the same warm-up queries, which are not the timed
+// ones, so that none of them is timed on queries it has already answered.
+template <class Search>
+void bench(const char* name, const Queries& warm_ups, const Queries& queries, Search search)
+{
+	for (const auto& [source, target] : warm_ups)
+		search(source, target);
+	long long checksum = 0;
+	const size_t allocations_before = allocation_count;
+	const auto start = std::chrono::steady_clock::now();
+	for (const auto& [source, target] : queries)
+		checksum += search(source, target);
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	const double allocations = double(allocation_count - allocations_before) / queries.size();
+	std::printf("%-36s %10.0f queries/s %10.2f allocations/query  checksum %lld\n",
+		name, queries.size() / elapsed.count(), allocations, checksum);
+}
+
+int main(int argc, char* argv[])
+{
+	const std::uint32_t side = argc > 1 ? std::uint32_t(std::atoi(argv[1])) : 300;
+	const size_t query_count = argc > 2 ? size_t(std::atoll(argv[2])) : 2000;
+	const Graph graph = GraphGenerators::grid(side, 100, 5);
+	std::printf("grid graph: %u vertexes, %llu edges\n", unsigned(graph.vertex_count()), (unsigned long long)graph.edge_count());
+
+	// Short queries, like a service's, so that per-query overhead matters.
+	std::mt19937 random(11);
+	std::uniform_int_distribution<std::uint32_t> coordinate(0, side - 1);
+	std::uniform_int_distribution<int> offset(-10, 10);
+	auto near = [&](std::uint32_t c) { return std::uint32_t(std::min<int>(std::max<int>(int(c) + offset(random), 0), int(side) - 1)); };
+	auto make_queries = [&](size_t count)
+	{
+		Queries queries;
+		for (size_t i = 0; i < count; i++)
+		{
+			const std::uint32_t x = coordinate(random);
+			const std::uint32_t y = coordinate(random);
+			queries.push_back({ y * side + x, near(y) * side + near(x) });
+		}
+		return queries;
+	};
+	const Queries warm_ups = make_queries(std::max<size_t>(1, query_count / 4));
+	const Queries queries = make_queries(query_count);
+
+	bench("dijkstra_ids", warm_ups, queries, [&](std::uint32_t source, std::uint32_t target)
+		{
+			try
+			{
+				return Dijkstra::dijkstra_ids(graph, source, target).cost;
+			}
+			catch (std::invalid_argument&)
+			{
+				return Dijkstra::unreachable_cost<int>();
+			}
+		});
+
+	Dijkstra::DijkstraWorkspace<std::uint32_t, int> workspace(graph);
+	std::vector<std::uint32_t> path;
+	bench("DijkstraWorkspace query and path", warm_ups, queries, [&](std::uint32_t source, std::uint32_t target)
+		{
+			const int cost = workspace.query(source, target);
+			if (cost != Dijkstra::unreachable_cost<int>())
+				workspace.path_to(target, path);
+			return cost;
+		});
+
+	Dijkstra::DijkstraWorkspace<std::uint32_t, int, RadixHeap<int>> radix_workspace(graph);
+	bench("DijkstraWorkspace with a radix heap", warm_ups, queries, [&](std::uint32_t source, std::uint32_t target)
+		{
+			const int cost = radix_workspace.query(source, target);
+			if (cost != Dijkstra::unreachable_cost<int>())
+				radix_workspace.path_to(target, path);
+			return cost;
+		});
+}
@@ -0,0 +1,184 @@
+#pragma once
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A portable stand-in for the parts of Microsoft's CppUnitTest framework that the tests use, so
+// that tests.cpp also builds with CMake on any platform. CMake puts this directory on the include
+// path, while Visual Studio's test project uses the real framework.
+// Each TEST_METHOD registers itself, and UnitTest::run_all_tests runs the registered tests.
+namespace UnitTest
+{
+	// Thrown by a failed assertion.
+	struct AssertFailure
+	{
+		std::string message;
+	};
+
+	struct TestCase
+	{
+		std::string name;  // "class::method"
+		std::function<void()> run;
+	};
+
+	inline std::vector<TestCase>& registered_tests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	inline int register_test(std::string name, std::function<void()> run)
+	{
+		registered_tests().push_back({ std::move(name), std::move(run) });
+		return 0;
+	}
+
+	// The base class of each TEST_CLASS. Name provides the class's name for reports.
+	template <class Class, class Name>
+	struct TestClass
+	{
+		using Self = Class;
+		static const char* test_class_name() { return Name::get(); }
+	};
+
+	// Returns a value written the way an ostream writes it, or a placeholder for types it cannot write.
+	template <class T>
+	std::string describe(const T& value)
+	{
+		if constexpr (std::is_same_v<T, std::wstring>)
+			return std::string(value.begin(), value.end());
+		else
+		{
+			auto write = [](std::ostream& stream, const auto& v) -> decltype(stream << v, void()) { stream << v; };
+			if constexpr (std::is_invocable_v<decltype(write), std::ostream&, const T&>)
+			{
+				std::ostringstream stream;
+				write(stream, value);
+				return stream.str();
+			}
+			else
+				return "(a value)";
+		}
+	}
+
+	// Converts an assertion's optional message, which is a wide string for CppUnitTest's sake.
+	inline std::string narrow(const wchar_t* message)
+	{
+		if (!message)
+			return "";
+		std::string result;
+		for (; *message; message++)
+			result += *message < 128 ? char(*message) : '?';
+		return " " + result;
+	}
+
+	struct Assert
+	{
+		template <class Expected, class Actual>
+		static void AreEqual(const Expected& expected, const Actual& actual, const wchar_t* message = nullptr)
+		{
+			if (!(expected == actual))
+				throw AssertFailure{ "AreEqual failed: expected <" + describe(expected) + "> but got <" + describe(actual) + ">." + narrow(message) };
+		}
+
+		template <class NotExpected, class Actual>
+		static void AreNotEqual(const NotExpected& not_expected, const Actual& actual, const wchar_t* message = nullptr)
+		{
+			if (not_expected == actual)
+				throw AssertFailure{ "AreNotEqual failed: got <" + describe(actual) + ">." + narrow(message) };
+		}
+
+		static void IsTrue(bool condition, const wchar_t* message = nullptr)
+		{
+			if (!condition)
+				throw AssertFailure{ "IsTrue failed." + narrow(message) };
+		}
+
+		static void IsFalse(bool condition, const wchar_t* message = nullptr)
+		{
+			if (condition)
+				throw AssertFailure{ "IsFalse failed." + narrow(message) };
+		}
+
+		static void Fail(const wchar_t* message = nullptr)
+		{
+			throw AssertFailure{ "Fail." + narrow(message) };
+		}
+
+		template <class Exception, class Function>
+		static void ExpectException(Function function, const wchar_t* message = nullptr)
+		{
+			try
+			{
+				function();
+			}
+			catch (const Exception&)
+			{
+				return;
+			}
+			catch (...)
+			{
+				throw AssertFailure{ "ExpectException failed: a different exception was thrown." + narrow(message) };
+			}
+			throw AssertFailure{ "ExpectException failed: no exception was thrown." + narrow(message) };
+		}
+	};
+
+	// Runs each registered test whose name starts with filter, prints each failure, and
+	// returns the number of failures.
+	inline int run_all_tests(const std::string& filter = "")
+	{
+		int run = 0;
+		int failed = 0;
+		for (const TestCase& test : registered_tests())
+		{
+			if (test.name.compare(0, filter.size(), filter) != 0)
+				continue;
+			run += 1;
+			std::string failure;
+			try
+			{
+				test.run();
+			}
+			catch (const AssertFailure& error)
+			{
+				failure = error.message;
+			}
+			catch (const std::exception& error)
+			{
+				failure = std::string("Unexpected exception: ") + error.what();
+			}
+			catch (...)
+			{
+				failure = "Unexpected exception.";
+			}
+			if (!failure.empty())
+			{
+				failed += 1;
+				std::printf("FAILED %s: %s\n", test.name.c_str(), failure.c_str());
+			}
+		}
+		std::printf("%d tests run, %d failed\n", run, failed);
+		return failed;
+	}
+}
+
+namespace Microsoft::VisualStudio::CppUnitTestFramework
+{
+	using UnitTest::Assert;
+}
+
+#define TEST_CLASS(className) \
+	struct className##_test_class_name { static const char* get() { return #className; } }; \
+	class className : public ::UnitTest::TestClass<className, className##_test_class_name>
+
+#define TEST_METHOD(methodName) \
+	static void methodName##_run() { Self test; test.methodName(); } \
+	inline static const int methodName##_registration = ::UnitTest::register_test( \
+		std::string(test_class_name()) + "::" + #methodName, &methodName##_run); \
+	void methodName()
@@ -0,0 +1,9 @@
+// Runs the unit tests outside of Visual Studio.
+// Usage: tests [prefix]
+// Only the tests whose "class::method" names start with the prefix run, if one is given.
+#include "CppUnitTest.h"
+
+int main(int argc, char* argv[])
+{
+	return UnitTest::run_all_tests(argc > 1 ? argv[1] : "") == 0 ? 0 : 1;
+}
@@ -0,0 +1,2 @@
+#pragma once
+// Visual Studio's test project precompiles this header. The portable build has nothing to precompile.
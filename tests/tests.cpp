@@ -1,10 +1,43 @@
 #include "pch.h"
 #include "CppUnitTest.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
+#include "../Algorithms/astar.h"
+#include "../Algorithms/BTree.h"
+#include "../Algorithms/command_line.h"
+#include "../Algorithms/ContractionHierarchy.h"
+#include "../Algorithms/delta_stepping.h"
+#include "../Algorithms/dijkstra.h"
+#include "../Algorithms/DynamicShortestPaths.h"
+#include "../Algorithms/DoublyLinkedList.h"
+#include "../Algorithms/FlatLinkedList.h"
+#include "../Algorithms/graph_parsers.h"
 #include "../Algorithms/LinkedList.h"
+#include "../Algorithms/matrix_search.h"
+#include "../Algorithms/number_text.h"
+#include "../Algorithms/parallel_sort.h"
+#include "../Algorithms/PriorityQueues.h"
+#include "../Algorithms/smart_sort.h"
+#include "../Algorithms/SortedIndex.h"
 #include "../Algorithms/sorting.h"
-#include "../Algorithms/sorting.cpp"
+#include "../Algorithms/tracing.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -31,6 +64,80 @@ int add(int a, int b)
 	return a + b;
 }
 
+Dijkstra::GraphMap<std::string, int> make_example_graph()
+{
+	return {
+		{ "A", { { "A", 0 }, { "B", 3 }, { "C", 4 } } },
+		{ "B", { { "A", 3 }, { "B", 0 }, { "D", 6 }, { "E", 5 } } },
+		{ "C", { { "A", 4 }, { "C", 0 }, { "E", 1 } } },
+		{ "D", { { "B", 6 }, { "D", 0 }, { "E", 2 }, { "Z", 7 } } },
+		{ "E", { { "B", 5 }, { "C", 1 }, { "D", 2 }, { "E", 0 }, { "Z", 12 } } },
+		{ "Z", { { "D", 7 }, { "E", 12 }, { "Z", 0 } } },
+	};
+}
+
+// Returns a random directed graph with vertexes named 0 to vertex_count - 1.
+Dijkstra::GraphMap<int, int> make_random_graph(int vertex_count, int edge_count, int max_cost)
+{
+	Dijkstra::GraphMap<int, int> graph;
+	for (int v = 0; v < vertex_count; v++)
+		graph[v];
+	for (int i = 0; i < edge_count; i++)
+		graph[rand() % vertex_count].push_back({ rand() % vertex_count, rand() % (max_cost + 1) });
+	return graph;
+}
+
+// Returns the total cost of a path's edges, using the cheapest edge between each pair of vertexes.
+int path_cost(const Dijkstra::GraphMap<int, int>& graph, const std::vector<int>& path)
+{
+	int cost = 0;
+	for (size_t i = 1; i < path.size(); i++)
+	{
+		int cheapest = INT_MAX;
+		for (const Dijkstra::Node<int, int>& neighbor : graph.at(path[i - 1]))
+			if (neighbor.name == path[i])
+				cheapest = std::min(cheapest, neighbor.cost);
+		Assert::AreNotEqual(INT_MAX, cheapest);
+		cost += cheapest;
+	}
+	return cost;
+}
+
+// Checks that a B+ tree's nodes are sorted, full enough, and all leaves are at the same depth,
+// and that its separator keys bound the keys below them. Returns the tree's height.
+template <class Tree>
+size_t check_btree(const Tree& tree)
+{
+	size_t leaf_depth = SIZE_MAX;
+	size_t key_count = 0;
+	tree.preorder([&](typename Tree::NodeView node, size_t depth)
+		{
+			for (size_t i = 1; i < node.key_count(); i++)
+				Assert::IsTrue(node.key(i - 1) < node.key(i));
+			if (depth > 0)
+				Assert::IsTrue(node.key_count() >= Tree::node_capacity / 2);
+			Assert::IsTrue(node.key_count() <= Tree::node_capacity);
+			if (node.is_leaf())
+			{
+				if (leaf_depth == SIZE_MAX)
+					leaf_depth = depth;
+				Assert::AreEqual(leaf_depth, depth);
+				key_count += node.key_count();
+				return;
+			}
+			for (size_t i = 0; i < node.child_count(); i++)
+			{
+				typename Tree::NodeView child = node.child(i);
+				if (i > 0)
+					Assert::IsFalse(child.key(0) < node.key(i - 1));
+				if (i < node.key_count())
+					Assert::IsTrue(child.key(child.key_count() - 1) < node.key(i));
+			}
+		});
+	Assert::AreEqual(tree.size(), key_count);
+	return tree.empty() ? 0 : leaf_depth + 1;
+}
+
 namespace tests
 {
 
@@ -38,9 +145,9 @@ namespace tests
 	{
 	public:
 
-		wstring format_int_array(int arr[], int size)
+		std::wstring format_int_array(int arr[], int size)
 		{
-			wstring s = L"";
+			std::wstring s = L"";
 			for (int i = 0; i < size; i++)
 			{
 				s += std::to_wstring(arr[i]);
@@ -189,6 +296,479 @@ namespace tests
 			}
 		}
 
+		TEST_METHOD(test_comparator_instances_and_searches)
+		{
+			// A stateful comparator that sorts in descending order and counts its calls.
+			int comparisons = 0;
+			auto is_less = [&](int left, int right) { comparisons++; return left < right; };
+			int numbers[] = { 5, 1, 4, 2, 3 };
+			quicksort(numbers, 0, 4, is_less);
+			Assert::IsTrue(std::vector<int>(numbers, numbers + 5) == std::vector<int>({ 5, 4, 3, 2, 1 }));
+			Assert::IsTrue(comparisons > 0);
+			Assert::AreEqual(1, binary_search(numbers, 5, 4, is_less));
+
+			// The default comparators use the compiled instantiations in sorting.cpp.
+			std::string words[] = { "pear", "apple", "fig", "kiwi" };
+			merge_sort(words, 0, 3);
+			Assert::IsTrue(std::vector<std::string>(words, words + 4) == std::vector<std::string>({ "apple", "fig", "kiwi", "pear" }));
+			double values[] = { 2.5, -1.0, 0.5 };
+			heap_sort(values, 3);
+			Assert::AreEqual(-1.0, values[0]);
+			for (int i = 0; i < 4; i++)
+				Assert::AreEqual(i, binary_search(words, 4, words[i]));
+			Assert::AreEqual(-1, binary_search(words, 4, std::string("zucchini")));
+			Assert::AreEqual(-1, binary_search(words, 4, std::string("banana")));
+			Assert::AreEqual(2, linear_search(words, 4, std::string("kiwi")));
+		}
+
+		TEST_METHOD(test_parallel_sort)
+		{
+			ThreadPool pool(3);
+			for (size_t size : { 0, 1, 2, 7, 1000, 12345 })
+			{
+				std::vector<int> numbers(size);
+				randomize(numbers.data(), int(size), 50);
+				std::vector<int> expected = numbers;
+				std::sort(expected.begin(), expected.end());
+				parallel_sort(numbers.data(), size, pool, [](int* run, int run_size) { quicksort(run, 0, run_size - 1); });
+				Assert::IsTrue(numbers == expected);
+			}
+
+			// The runs and merges use the same comparator.
+			std::vector<int> numbers(1001);
+			randomize(numbers.data(), 1001, 1000);
+			auto is_less = [](int left, int right) { return left < right; };
+			parallel_sort(numbers.data(), numbers.size(), pool, [&](int* run, int run_size) { heap_sort(run, run_size, is_less); }, is_less);
+			Assert::IsTrue(std::is_sorted(numbers.rbegin(), numbers.rend()));
+		}
+
+		TEST_METHOD(test_command_line_sort_and_search)
+		{
+			const std::filesystem::path folder = std::filesystem::temp_directory_path();
+			const std::string input = (folder / "algorithms_test_input.bin").string();
+			const std::string output = (folder / "algorithms_test_output.bin").string();
+			const std::string queries = (folder / "algorithms_test_queries.txt").string();
+			const std::string positions = (folder / "algorithms_test_positions.txt").string();
+			std::vector<std::uint64_t> numbers(5000);
+			for (size_t i = 0; i < numbers.size(); i++)
+				numbers[i] = (i * 7919) % 10007;
+			std::ofstream(input, std::ios::binary).write(reinterpret_cast<const char*>(numbers.data()), numbers.size() * sizeof(std::uint64_t));
+			const std::uint64_t expected_first = numbers[10];
+			const std::uint64_t expected_third = numbers[20];
+			std::ofstream(queries) << expected_first << "\n\n 20000 \r\n" << expected_third << "\n";
+
+			std::ostringstream report;
+			const std::string input_option = "--input=" + input;
+			const std::string output_option = "--output=" + output;
+			const char* sort_args[] = { "algorithms", "sort", "--algo=merge", "--threads=3", input_option.c_str(), output_option.c_str() };
+			Assert::AreEqual(0, run_command_line(6, sort_args, report));
+			std::sort(numbers.begin(), numbers.end());
+			std::vector<std::uint64_t> sorted(numbers.size());
+			std::ifstream(output, std::ios::binary).read(reinterpret_cast<char*>(sorted.data()), sorted.size() * sizeof(std::uint64_t));
+			Assert::IsTrue(sorted == numbers);
+			Assert::IsTrue(report.str().find("peak memory") != std::string::npos);
+
+			// Search a text copy of the sorted output for text queries, one of which is missing.
+			const std::string text_index = (folder / "algorithms_test_index.txt").string();
+			{
+				std::ofstream file(text_index);
+				for (std::uint64_t number : numbers)
+					file << number << "\n";
+			}
+			const std::string index_option = "--index=" + text_index;
+			const std::string queries_option = "--input=" + queries;
+			const std::string positions_option = "--output=" + positions;
+			const char* search_args[] = { "algorithms", "search", index_option.c_str(), queries_option.c_str(), positions_option.c_str(), "--threads=2", "--text" };
+			Assert::AreEqual(0, run_command_line(7, search_args, report));
+			std::ifstream result(positions);
+			std::int64_t first = 0, second = 0, third = 0;
+			result >> first >> second >> third;
+			Assert::AreEqual(expected_first, numbers[size_t(first)]);
+			Assert::AreEqual(std::int64_t(-1), second);
+			Assert::AreEqual(expected_third, numbers[size_t(third)]);
+
+			const char* bad_args[] = { "algorithms", "sort", "--algo=bogo", input_option.c_str() };
+			Assert::AreEqual(2, run_command_line(4, bad_args, report));
+			for (const std::string& path : { input, output, queries, positions, text_index })
+				std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(test_parse_numbers)
+		{
+			auto parse = [](const std::string& text, auto number)
+			{
+				std::vector<decltype(number)> numbers;
+				parse_numbers(text.data(), text.size(), numbers);
+				return numbers;
+			};
+			Assert::IsTrue(parse(" 12\n\n-3 \r\n\t 00000000000000000000000042\n7", 0) == std::vector<int>({ 12, -3, 42, 7 }));
+			Assert::IsTrue(parse("18446744073709551615\n1234567890123456789\n0\n12345678", std::uint64_t())
+				== std::vector<std::uint64_t>({ 18446744073709551615u, 1234567890123456789u, 0, 12345678 }));
+			Assert::IsTrue(parse("-9223372036854775808\n9223372036854775807", std::int64_t())
+				== std::vector<std::int64_t>({ std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max() }));
+			Assert::IsTrue(parse("-2147483648\n2147483647\n", std::int32_t()) == std::vector<std::int32_t>({ INT_MIN, INT_MAX }));
+			Assert::IsTrue(parse("0.5\n-1e3\n", 0.0) == std::vector<double>({ 0.5, -1000.0 }));
+			for (const char* bad : { "2147483648", "-2147483649", "1x", "x", "1 2", "99999999999999999999", "--1", "+1" })
+				Assert::ExpectException<NumberFormatError>([&] { parse(bad, 0); });
+			Assert::ExpectException<NumberFormatError>([&] { parse("18446744073709551616", std::uint64_t()); });
+			Assert::ExpectException<NumberFormatError>([&] { parse("-1", std::uint64_t()); });
+			try
+			{
+				parse("1\n22\nthree\n", 0);
+				Assert::Fail();
+			}
+			catch (const NumberFormatError& error)
+			{
+				Assert::AreEqual(size_t(5), error.byte);
+			}
+
+			// Enough text to be parsed in several chunks.
+			ThreadPool pool(3);
+			std::vector<std::int64_t> expected(100000);
+			std::string text;
+			for (size_t i = 0; i < expected.size(); i++)
+			{
+				expected[i] = std::int64_t(i * i * 2654435761u % 1000000007) * (i % 2 ? -1 : 1);
+				text += std::to_string(expected[i]) + (i % 1000 ? "\n" : "\n\n");
+			}
+			std::vector<std::int64_t> numbers = { 5 };
+			parse_numbers(text.data(), text.size(), numbers, pool);
+			expected.insert(expected.begin(), 5);
+			Assert::IsTrue(numbers == expected);
+		}
+
+		TEST_METHOD(test_read_and_write_numbers)
+		{
+			ThreadPool pool(2);
+			std::vector<double> numbers(50000);
+			for (size_t i = 0; i < numbers.size(); i++)
+				numbers[i] = (double(i) - 2500) / 7;
+			std::FILE* file = std::tmpfile();
+			Assert::IsTrue(file != nullptr);
+			write_numbers(file, numbers.data(), numbers.size(), pool);
+			std::rewind(file);
+			Assert::IsTrue(read_numbers<double>(file, pool, 100) == numbers);  // The blocks split lines.
+
+			// A line longer than a block, and a bad line after the first block.
+			std::fclose(file);
+			file = std::tmpfile();
+			Assert::IsTrue(file != nullptr);
+			const std::string lines = "1\n" + std::string(30, ' ') + "2\n3\nfour\n";
+			std::fputs(lines.c_str(), file);
+			std::rewind(file);
+			try
+			{
+				read_numbers<int>(file, pool, 8);
+				Assert::Fail();
+			}
+			catch (const NumberFormatError& error)
+			{
+				Assert::AreEqual(lines.find("four"), error.byte);
+			}
+			std::fclose(file);
+
+			char text[32];
+			Assert::AreEqual(std::string("-9223372036854775808"), std::string(text, format_number(text, std::numeric_limits<std::int64_t>::min())));
+			Assert::AreEqual(std::string("0.1"), std::string(text, format_number(text, 0.1)));
+		}
+
+		TEST_METHOD(test_matrix_searches)
+		{
+			srand(47);
+			for (auto [rows, cols] : { std::pair<size_t, size_t>(0, 0), { 1, 1 }, { 1, 50 }, { 50, 1 }, { 7, 300 }, { 300, 7 }, { 64, 64 } })
+			{
+				// Each item is the larger of the items above and to its left plus 0 to 2, which
+				// sorts the rows and columns and repeats some items.
+				std::vector<int> matrix(rows * cols);
+				for (size_t row = 0; row < rows; row++)
+					for (size_t col = 0; col < cols; col++)
+						matrix[row * cols + col] = std::max(row > 0 ? matrix[(row - 1) * cols + col] : 0, col > 0 ? matrix[row * cols + col - 1] : 0) + rand() % 3;
+				Assert::IsTrue(is_sorted_matrix(matrix.data(), rows, cols));
+				const int largest = matrix.empty() ? 0 : matrix.back();
+				std::vector<int> values;
+				for (int value = -2; value <= largest + 2; value++)
+					values.push_back(value);
+				values.push_back(largest / 2);  // Repeat some values.
+				values.push_back(largest / 2);
+				std::vector<std::optional<MatrixPosition>> batch(values.size());
+				ThreadPool pool(2);
+				divide_and_conquer_search_batch(matrix.data(), rows, cols, values.data(), values.size(), batch.data(), pool);
+				for (size_t i = 0; i < values.size(); i++)
+				{
+					const bool present = std::find(matrix.begin(), matrix.end(), values[i]) != matrix.end();
+					for (std::optional<MatrixPosition> found : { staircase_search(matrix.data(), rows, cols, values[i]),
+						divide_and_conquer_search(matrix.data(), rows, cols, values[i]), batch[i] })
+					{
+						Assert::AreEqual(present, found.has_value());
+						if (found)
+							Assert::AreEqual(values[i], matrix[found->row * cols + found->col]);
+					}
+				}
+			}
+			std::vector<int> unsorted = { 1, 2, 3, 0 };
+			Assert::IsFalse(is_sorted_matrix(unsorted.data(), 2, 2));
+
+			// A matrix sorted the other way, by a comparator instance.
+			std::vector<int> descending = { 9, 8, 7, 6, 5, 4 };
+			std::optional<MatrixPosition> found = staircase_search(descending.data(), 2, 3, 5, std::less<int>());
+			Assert::IsTrue(found == MatrixPosition{ 1, 1 });
+			Assert::IsTrue(divide_and_conquer_search(descending.data(), 2, 3, 5, std::less<int>()) == found);
+		}
+
+		TEST_METHOD(test_load_matrix)
+		{
+			const std::filesystem::path folder = std::filesystem::temp_directory_path();
+			const std::string binary = (folder / "algorithms_test_matrix.bin").string();
+			const std::string text = (folder / "algorithms_test_matrix.txt").string();
+			const std::vector<std::int64_t> matrix = { 1, 2, 3, 4, 2, 5, 6, 9, 10, 11, 12, 13 };
+			{
+				std::ofstream file(binary, std::ios::binary);
+				write_matrix(file, matrix.data(), 3, 4);
+			}
+			LoadedMatrix<std::int64_t> loaded = load_matrix<std::int64_t>(binary);
+			Assert::AreEqual(size_t(3), loaded.rows);
+			Assert::AreEqual(size_t(4), loaded.cols);
+			Assert::IsTrue(loaded.file.has_value());
+			Assert::IsTrue(std::equal(matrix.begin(), matrix.end(), loaded.items));
+			Assert::IsTrue(staircase_search(loaded.items, loaded.rows, loaded.cols, std::int64_t(9)) == MatrixPosition{ 1, 3 });
+			auto wrong_type = [&] { load_matrix<std::int32_t>(binary); };
+			Assert::ExpectException<std::runtime_error>(wrong_type);
+
+			std::ofstream(text, std::ios::binary) << "3 4\n1 2 3 4\r\n2 5 6  9\n 10\t11 12 13\n\n";
+			loaded = load_matrix<std::int64_t>(text);
+			Assert::IsFalse(loaded.file.has_value());
+			Assert::IsTrue(std::equal(matrix.begin(), matrix.end(), loaded.items));
+			for (const char* bad : { "3 4\n1 2 3 4\n2 5 6\n10 11 12 13\n", "3 4\n1 2 3 4\n2 5 6 9\n", "3 4\n1 2 3 4\n2 5 6 9\n10 11 12 13\n14\n", "3\n" })
+			{
+				std::ofstream(text, std::ios::binary) << bad;
+				auto f = [&] { load_matrix<std::int64_t>(text); };
+				Assert::ExpectException<std::runtime_error>(f);
+			}
+			std::filesystem::remove(binary);
+			std::filesystem::remove(text);
+		}
+
+		TEST_METHOD(test_smart_sort)
+		{
+			std::vector<std::int32_t> signed_items(5000);
+			std::vector<double> doubles(5000);
+			for (size_t i = 0; i < signed_items.size(); i++)
+			{
+				signed_items[i] = std::int32_t((i * 7919) % 10007) - 5000;
+				doubles[i] = double(signed_items[i]) / 3 * (i % 2 ? 1e10 : 1e-10);
+			}
+			std::vector<std::int32_t> expected_signed = signed_items;
+			std::vector<double> expected_doubles = doubles;
+			std::sort(expected_signed.begin(), expected_signed.end());
+			std::sort(expected_doubles.begin(), expected_doubles.end());
+			radix_sort(signed_items.data(), signed_items.size());
+			radix_sort(doubles.data(), doubles.size());
+			Assert::IsTrue(signed_items == expected_signed);
+			Assert::IsTrue(doubles == expected_doubles);
+
+			// Runs up, runs down, and many equal keys, whose order must be kept.
+			std::vector<std::pair<int, int>> pairs;
+			for (int i = 0; i < 3000; i++)
+				pairs.push_back({ i < 1000 ? i / 10 : i < 2000 ? (2000 - i) / 10 : (i * 31) % 50, i });
+			std::vector<std::pair<int, int>> expected_pairs = pairs;
+			auto by_key = [](const std::pair<int, int>& left, const std::pair<int, int>& right) { return left.first > right.first; };
+			std::stable_sort(expected_pairs.begin(), expected_pairs.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+			adaptive_merge_sort(pairs.data(), pairs.size(), by_key);
+			Assert::IsTrue(pairs == expected_pairs);
+
+			std::vector<std::uint64_t> items(200000);
+			for (size_t i = 0; i < items.size(); i++)
+				items[i] = std::uint64_t(i) * 0x9e3779b97f4a7c15;
+			std::vector<std::uint64_t> sorted = items;
+			std::sort(sorted.begin(), sorted.end());
+			Assert::AreEqual(int(SortStrategy::insertion), int(choose_sort(items.data(), 20, 1).strategy));
+			Assert::AreEqual(int(SortStrategy::adaptive_merge), int(choose_sort(sorted.data(), sorted.size(), 1).strategy));
+			const SortDecision decision = choose_sort(items.data(), items.size(), 1);
+			Assert::AreEqual(int(SortStrategy::radix), int(decision.strategy));
+			Assert::AreEqual(size_t(8), decision.profile.radix_passes);
+			Assert::IsTrue(decision.profile.inversion_ratio > 0.4 && decision.profile.inversion_ratio < 0.6);
+			Assert::IsTrue(decision.profile.duplicate_ratio < 0.01);
+			Assert::IsTrue(decision.reasons.back().rfind("chose radix", 0) == 0);
+			Assert::IsTrue(std::isinf(decision.estimated_ns[size_t(SortStrategy::parallel)]));
+
+			// Every strategy, and smart_sort with a comparator that radix sort cannot follow.
+			ThreadPool pool(2);
+			for (SortStrategy strategy : { SortStrategy::radix, SortStrategy::adaptive_merge, SortStrategy::introsort, SortStrategy::parallel })
+			{
+				std::vector<std::uint64_t> copy = items;
+				sort_by_strategy(strategy, copy.data(), copy.size(), pool);
+				Assert::IsTrue(copy == sorted);
+			}
+			std::vector<std::uint64_t> descending = items;
+			const SortDecision less_decision = smart_sort(descending.data(), descending.size(), pool, SortCostModel(), std::less<std::uint64_t>());
+			Assert::IsFalse(less_decision.profile.radix_sortable);
+			Assert::IsTrue(std::equal(descending.begin(), descending.end(), sorted.rbegin()));
+			std::vector<std::string> words = { "b", "a", "c" };
+			auto radix_words = [&] { sort_by_strategy(SortStrategy::radix, words.data(), words.size()); };
+			Assert::ExpectException<std::invalid_argument>(radix_words);
+		}
+
+		TEST_METHOD(test_tracing)
+		{
+			Tracing::reset();
+			std::vector<int> items(1000);
+			for (size_t i = 0; i < items.size(); i++)
+				items[i] = int(items.size() - i);
+			std::vector<int> copy = items;
+			quicksort(items.data(), 0, int(items.size()) - 1);
+			merge_sort(copy.data(), 0, int(copy.size()) - 1);
+			ThreadPool pool(1);
+			parallel_sort(copy.data(), copy.size(), pool, [](int* run, int size) { insertion_sort(run, size); });
+
+			std::ostringstream trace;
+			Tracing::write_chrome_trace(trace);
+			Assert::IsTrue(trace.str().rfind("{\"traceEvents\":[", 0) == 0);
+			const std::vector<Tracing::CounterTotal> counters = Tracing::counters();
+			auto value = [&](const std::string& name)
+			{
+				for (const Tracing::CounterTotal& counter : counters)
+					if (counter.name == name)
+						return counter.value;
+				return std::uint64_t(0);
+			};
+			if constexpr (Tracing::enabled)
+			{
+				Assert::IsTrue(value("quicksort partitions") > 0);
+				Assert::IsTrue(value("quicksort depth") >= 10);
+				Assert::AreEqual(std::uint64_t(10), value("merge_sort passes"));
+				Assert::IsTrue(value("merge_sort merged items") > 9 * 1000 && value("merge_sort merged items") <= 10 * 1000);
+				Assert::AreEqual(size_t(4), Tracing::event_count());  // The whole sort, two runs, and one merge.
+				Assert::IsTrue(trace.str().find("\"name\":\"parallel_sort run\",\"ph\":\"X\"") != std::string::npos);
+			}
+			else
+			{
+				Assert::IsTrue(counters.empty());
+				Assert::AreEqual(size_t(0), Tracing::event_count());
+			}
+		}
+
+		TEST_METHOD(test_sorted_index)
+		{
+			const std::filesystem::path folder = std::filesystem::temp_directory_path();
+			const std::string path = (folder / "algorithms_test_sorted_index.bin").string();
+			std::vector<std::int32_t> keys(20000);
+			for (size_t i = 0; i < keys.size(); i++)
+				keys[i] = std::int32_t((i * 7919) % 10007) * 2;
+			{
+				std::ofstream file(path, std::ios::binary);
+				SortedIndex<std::int32_t>::write(file, keys);
+			}
+			std::sort(keys.begin(), keys.end());
+			{
+				const SortedIndex<std::int32_t> index(path);
+				Assert::AreEqual(keys.size(), index.size());
+				Assert::IsTrue(std::equal(keys.begin(), keys.end(), index.keys()));
+				Assert::IsFalse(index.has_payloads());
+				for (std::int32_t key : { -1, 0, 1, 2, 9999, 10000, 20012, 20013, 20014, 30000 })
+				{
+					const size_t lower = size_t(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+					const size_t upper = size_t(std::upper_bound(keys.begin(), keys.end(), key) - keys.begin());
+					Assert::AreEqual(lower, index.lower_bound(key));
+					Assert::AreEqual(upper, index.upper_bound(key));
+					Assert::AreEqual(lower < upper ? std::int64_t(lower) : std::int64_t(-1), index.find(key));
+					const size_t high = size_t(std::lower_bound(keys.begin(), keys.end(), key + 5000) - keys.begin());
+					Assert::IsTrue(index.range(key, key + 5000) == std::make_pair(lower, high));
+				}
+				auto no_payloads = [&] { index.payload(0); };
+				Assert::ExpectException<std::logic_error>(no_payloads);
+				auto wrong_type = [&] { SortedIndex<std::int64_t> wrong(path); };
+				Assert::ExpectException<std::runtime_error>(wrong_type);
+			}
+
+			// Equal keys keep their payloads in the order they were given.
+			const std::vector<std::uint16_t> words = { 3, 1, 3, 2, 1 };
+			const std::vector<std::string> payloads = { "c", "a", "", "bb", "a2" };
+			{
+				std::ofstream file(path, std::ios::binary);
+				SortedIndex<std::uint16_t>::write(file, words, payloads);
+			}
+			{
+				const SortedIndex<std::uint16_t> index(path);
+				Assert::IsTrue(index.has_payloads());
+				const std::vector<std::string> expected = { "a", "a2", "bb", "c", "" };
+				for (size_t i = 0; i < expected.size(); i++)
+					Assert::AreEqual(expected[i], std::string(index.payload(i)));
+				Assert::AreEqual(std::int64_t(3), index.find(3));
+				auto past_end = [&] { index.payload(5); };
+				Assert::ExpectException<std::out_of_range>(past_end);
+			}
+			auto mismatch = [&]
+			{
+				std::ostringstream stream;
+				SortedIndex<std::uint16_t>::write(stream, words, { "one" });
+			};
+			Assert::ExpectException<std::invalid_argument>(mismatch);
+
+			// A file of a newer version is refused.
+			{
+				std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+				const std::uint64_t newer = SortedIndex<std::uint16_t>::version + 1;
+				file.seekp(sizeof(std::uint64_t));
+				file.write(reinterpret_cast<const char*>(&newer), sizeof(newer));
+			}
+			auto wrong_version = [&] { SortedIndex<std::uint16_t> index(path); };
+			Assert::ExpectException<std::runtime_error>(wrong_version);
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(test_command_line_index)
+		{
+			const std::filesystem::path folder = std::filesystem::temp_directory_path();
+			const std::string input = (folder / "algorithms_test_index_input.txt").string();
+			const std::string index = (folder / "algorithms_test_index.sidx").string();
+			const std::string positions = (folder / "algorithms_test_index_positions.txt").string();
+			std::ofstream(input) << "50\n-7\n12\n50\n3\n";
+
+			std::ostringstream report;
+			const std::string input_option = "--input=" + input;
+			const std::string index_output_option = "--output=" + index;
+			const char* index_args[] = { "algorithms", "index", "--format=i32", "--text", input_option.c_str(), index_output_option.c_str() };
+			Assert::AreEqual(0, run_command_line(6, index_args, report));
+			Assert::AreEqual(size_t(5), SortedIndex<std::int32_t>(index).size());
+
+			// The search knows the index file by its extension and ignores --algo.
+			const std::string binary_queries = (folder / "algorithms_test_index_queries.bin").string();
+			const std::int32_t query_items[] = { 12, 4, 50, -7 };
+			std::ofstream(binary_queries, std::ios::binary).write(reinterpret_cast<const char*>(query_items), sizeof(query_items));
+			const std::string index_option = "--index=" + index;
+			const std::string queries_option = "--input=" + binary_queries;
+			const std::string positions_option = "--output=" + positions;
+			const char* search_args[] = { "algorithms", "search", "--format=i32", "--algo=linear", index_option.c_str(), queries_option.c_str(), positions_option.c_str() };
+			Assert::AreEqual(0, run_command_line(7, search_args, report));
+			std::int64_t found[4] = {};
+			std::ifstream(positions, std::ios::binary).read(reinterpret_cast<char*>(found), sizeof(found));
+			Assert::IsTrue(std::equal(std::begin(found), std::end(found), std::begin({ std::int64_t(2), std::int64_t(-1), std::int64_t(3), std::int64_t(0) })));
+
+			const char* no_output_args[] = { "algorithms", "index", input_option.c_str() };
+			Assert::AreEqual(2, run_command_line(3, no_output_args, report));
+			const std::string wrong_extension_option = "--output=" + (folder / "algorithms_test_index.bin").string();
+			const char* wrong_extension_args[] = { "algorithms", "index", input_option.c_str(), wrong_extension_option.c_str() };
+			Assert::AreEqual(2, run_command_line(4, wrong_extension_args, report));
+
+			// An array of items is searched as one even if it starts with the index files' magic number.
+			const std::string array = (folder / "algorithms_test_index_array.bin").string();
+			const std::uint64_t array_items[] = { 0x58444953, 0x58444954, 0x58444960 };
+			std::ofstream(array, std::ios::binary).write(reinterpret_cast<const char*>(array_items), sizeof(array_items));
+			const std::string array_queries = (folder / "algorithms_test_index_array_queries.bin").string();
+			const std::uint64_t array_query_items[] = { 0x58444960, 7 };
+			std::ofstream(array_queries, std::ios::binary).write(reinterpret_cast<const char*>(array_query_items), sizeof(array_query_items));
+			const std::string array_option = "--index=" + array;
+			const std::string array_queries_option = "--input=" + array_queries;
+			const char* array_args[] = { "algorithms", "search", array_option.c_str(), array_queries_option.c_str(), positions_option.c_str() };
+			Assert::AreEqual(0, run_command_line(5, array_args, report));
+			std::int64_t array_found[2] = {};
+			std::ifstream(positions, std::ios::binary).read(reinterpret_cast<char*>(array_found), sizeof(array_found));
+			Assert::AreEqual(std::int64_t(2), array_found[0]);
+			Assert::AreEqual(std::int64_t(-1), array_found[1]);
+			for (const std::string& path : { input, index, binary_queries, positions, array, array_queries })
+				std::filesystem::remove(path);
+		}
+
 	};
 
 	TEST_CLASS(linked_list)
@@ -502,6 +1082,104 @@ namespace tests
 			Assert::AreEqual(8, list[3]);
 		}
 
+		TEST_METHOD(test_iterator_with_standard_algorithms)
+		{
+			static_assert(std::is_same_v<
+				std::iterator_traits<LinkedList<int>::iterator>::iterator_category, std::forward_iterator_tag>);
+			LinkedList<int> list = { 4, 1, 3, 2 };
+			const LinkedList<int>& const_list = list;
+			Assert::AreEqual(10, std::accumulate(const_list.begin(), const_list.end(), 0));
+			Assert::AreEqual(4, *std::max_element(list.begin(), list.end()));
+			Assert::IsTrue(std::find(list.cbegin(), list.cend(), 3) != list.cend());
+			Assert::IsTrue(std::find(list.cbegin(), list.cend(), 5) == list.cend());
+			std::fill(list.begin(), list.end(), 7);
+			Assert::AreEqual(4L, long(std::count(list.begin(), list.end(), 7)));
+			LinkedList<int>::const_iterator it = list.begin();
+			Assert::IsTrue(it == list.cbegin());
+		}
+
+		TEST_METHOD(test_insert_after_and_erase_after)
+		{
+			LinkedList<int> list = { 1, 2, 3 };
+			auto it = list.insert_after(list.before_begin(), 0);
+			Assert::AreEqual(0, *it);
+			it = list.insert_after(list.begin(), { 10, 11 });
+			Assert::AreEqual(11, *it);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 0, 10, 11, 1, 2, 3 }));
+			it = list.erase_after(it);
+			Assert::AreEqual(2, *it);
+			list.erase_after(it);
+			list.append(4);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 0, 10, 11, 2, 4 }));
+			list.erase_after(list.before_begin(), list.end());
+			Assert::IsTrue(list.empty());
+			list.append(5);
+			Assert::AreEqual(5, list[0]);
+			Assert::AreEqual(size_t(1), list.size());
+		}
+
+		TEST_METHOD(test_erase_after_end)
+		{
+			LinkedList<int> list = { 1 };
+			auto f = [&] { list.erase_after(list.begin()); };
+			Assert::ExpectException<std::out_of_range>(f);
+			auto g = [&] { list.insert_after(list.end(), 2); };
+			Assert::ExpectException<std::out_of_range>(g);
+		}
+
+		TEST_METHOD(test_splice_after)
+		{
+			LinkedList<int> list1 = { 1, 2, 3 };
+			LinkedList<int> list2 = { 10, 20 };
+			list1.splice_after(list1.begin(), list2);
+			Assert::IsTrue(list1.vector() == std::vector<int>({ 1, 10, 20, 2, 3 }));
+			Assert::AreEqual(size_t(5), list1.size());
+			Assert::IsTrue(list2.empty());
+			list2.append(30);
+			list2.splice_after(list2.begin(), list1, list1.before_begin());
+			Assert::IsTrue(list2.vector() == std::vector<int>({ 30, 1 }));
+			auto first = list1.begin();
+			auto last = std::next(first, 3);
+			list2.splice_after(list2.before_begin(), list1, first, last);
+			Assert::IsTrue(list2.vector() == std::vector<int>({ 20, 2, 30, 1 }));
+			Assert::IsTrue(list1.vector() == std::vector<int>({ 10, 3 }));
+			list1.append(4);
+			list2.append(5);
+			Assert::AreEqual(size_t(3), list1.size());
+			Assert::AreEqual(size_t(5), list2.size());
+			Assert::AreEqual(5, list2[4]);
+		}
+
+		TEST_METHOD(test_splice_after_invalid_position_changes_nothing)
+		{
+			LinkedList<int> list1 = { 1, 2, 3 };
+			LinkedList<int> list2 = { 10, 20, 30 };
+			LinkedList<int> list3 = { 7 };
+			auto wrong_list = [&] { list1.splice_after(list3.before_begin(), list2, list2.before_begin()); };
+			Assert::ExpectException<std::invalid_argument>(wrong_list);
+			auto end_position = [&] { list1.splice_after(list1.end(), list2, list2.begin()); };
+			Assert::ExpectException<std::out_of_range>(end_position);
+			auto wrong_list_range = [&] { list1.splice_after(list3.before_begin(), list2, list2.before_begin(), list2.end()); };
+			Assert::ExpectException<std::invalid_argument>(wrong_list_range);
+			auto end_position_range = [&] { list1.splice_after(list1.end(), list2, list2.before_begin(), list2.end()); };
+			Assert::ExpectException<std::out_of_range>(end_position_range);
+			Assert::IsTrue(list1.vector() == std::vector<int>({ 1, 2, 3 }));
+			Assert::IsTrue(list2.vector() == std::vector<int>({ 10, 20, 30 }));
+			Assert::AreEqual(size_t(3), list2.size());
+			list2.append(40);
+			Assert::AreEqual(40, list2[3]);
+		}
+
+		TEST_METHOD(test_copy_constructor_copies_every_node)
+		{
+			LinkedList<int> list1 = { 1, 2, 3 };
+			LinkedList<int> list2(list1);
+			list2[2] = 4;
+			Assert::AreEqual(3, list1[2]);
+			Assert::AreEqual(4, list2[2]);
+			Assert::IsTrue(list1 != list2);
+		}
+
 		TEST_METHOD(test_find)
 		{
 			LinkedList<int> list = { 1, 2, 3, 4 };
@@ -565,6 +1243,168 @@ namespace tests
 			Assert::AreEqual(size_t(5), list.size());
 		}
 
+		TEST_METHOD(test_map_filter_and_reduce_with_lambdas)
+		{
+			LinkedList<int> list = { 1, 2, 3, 4, 5 };
+			int offset = 10;
+			list.map([offset](int n) { return n + offset; });
+			Assert::AreEqual(11, list[0]);
+			Assert::AreEqual(15, list[4]);
+			LinkedList<int> odds = list.filter([](int n) { return n % 2 == 1; });
+			Assert::AreEqual(size_t(3), odds.size());
+			Assert::AreEqual(13, odds[1]);
+			Assert::AreEqual(11 * 13 * 15, odds.reduce([](int a, int b) { return a * b; }));
+		}
+
+		TEST_METHOD(test_reduce_empty_list)
+		{
+			LinkedList<int> list;
+			Assert::AreEqual(0, list.reduce(add));
+			Assert::AreEqual(0, list.parallel_reduce(add));
+		}
+
+		TEST_METHOD(test_parallel_map_filter_and_reduce)
+		{
+			ThreadPool pool(3);
+			LinkedList<int> list;
+			for (int i = 1; i <= 1000; i++)
+				list.append(i);
+			list.parallel_map(square, pool);
+			Assert::AreEqual(1, list[0]);
+			Assert::AreEqual(1000 * 1000, list[999]);
+			LinkedList<int> evens = list.parallel_filter(is_even, pool);
+			Assert::AreEqual(size_t(500), evens.size());
+			Assert::IsTrue(evens == list.filter(is_even));
+			Assert::AreEqual(list.reduce(add), list.parallel_reduce(add, pool));
+			Assert::AreEqual(size_t(1000), list.size());
+		}
+
+		TEST_METHOD(test_parallel_functions_on_short_lists)
+		{
+			ThreadPool pool(7);
+			LinkedList<int> list = { 1, 2, 3 };
+			list.parallel_map(square, pool);
+			Assert::IsTrue(list == LinkedList<int>({ 1, 4, 9 }));
+			Assert::AreEqual(size_t(1), list.parallel_filter(is_even, pool).size());
+			Assert::AreEqual(14, list.parallel_reduce(add, pool));
+		}
+
+		TEST_METHOD(test_thread_pool_rethrows_exceptions)
+		{
+			ThreadPool pool(2);
+			auto f = [&] { pool.run(100, [](size_t i) { if (i == 42) throw std::runtime_error("task failed"); }); };
+			Assert::ExpectException<std::runtime_error>(f);
+		}
+
+		TEST_METHOD(test_sort)
+		{
+			for (int i = 0; i < 20; i++)
+			{
+				const int size = 1 + i * 37;
+				int numbers[1000];
+				randomize(numbers, size, 50);
+				LinkedList<int> list;
+				for (int j = 0; j < size; j++)
+					list.append(numbers[j]);
+				std::vector<int> expected = list.vector();
+				std::sort(expected.begin(), expected.end());
+				list.sort();
+				Assert::IsTrue(expected == list.vector());
+				Assert::AreEqual(size_t(size), list.size());
+			}
+		}
+
+		TEST_METHOD(test_sort_is_stable)
+		{
+			LinkedList<std::pair<int, int>> list = { { 3, 0 }, { 1, 1 }, { 3, 2 }, { 2, 3 }, { 1, 4 }, { 3, 5 } };
+			list.sort([](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+			std::vector<std::pair<int, int>> expected = { { 1, 1 }, { 1, 4 }, { 2, 3 }, { 3, 0 }, { 3, 2 }, { 3, 5 } };
+			Assert::IsTrue(expected == list.vector());
+		}
+
+		TEST_METHOD(test_sort_descending)
+		{
+			LinkedList<int> list = { 1, 5, 2, 4, 3 };
+			list.sort(std::greater<int>());
+			Assert::IsTrue(list.vector() == std::vector<int>({ 5, 4, 3, 2, 1 }));
+		}
+
+		TEST_METHOD(test_merge)
+		{
+			LinkedList<int> list1 = { 1, 3, 5, 7 };
+			LinkedList<int> list2 = { 2, 3, 8 };
+			list1.merge(std::move(list2));
+			Assert::IsTrue(list1.vector() == std::vector<int>({ 1, 2, 3, 3, 5, 7, 8 }));
+			Assert::AreEqual(size_t(7), list1.size());
+			Assert::AreEqual(size_t(0), list2.size());
+			Assert::IsTrue(list2.empty());
+		}
+
+		TEST_METHOD(test_unique)
+		{
+			LinkedList<int> list = { 1, 1, 2, 3, 3, 3, 1, 4, 4 };
+			Assert::AreEqual(size_t(4), list.unique());
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 2, 3, 1, 4 }));
+			Assert::AreEqual(size_t(5), list.size());
+		}
+
+		TEST_METHOD(test_sequential_indexing)
+		{
+			LinkedList<int> list;
+			for (int i = 0; i < 100; i++)
+				list.insert(i, i);
+			int sum = 0;
+			for (size_t i = 0; i < list.size(); i++)
+				sum += list[i];
+			Assert::AreEqual(4950, sum);
+			Assert::AreEqual(50, list[50]);
+			list.insert(-1, 10);
+			Assert::AreEqual(-1, list[10]);
+			Assert::AreEqual(49, list[50]);
+			list.remove(0);
+			Assert::AreEqual(-1, list[9]);
+			Assert::AreEqual(49, list[49]);
+			for (size_t i = 0; i < 50; i++)
+				list.remove(i);
+			Assert::AreEqual(size_t(50), list.size());
+			Assert::AreEqual(2, list[0]);
+			Assert::AreEqual(97, list[48]);
+			Assert::AreEqual(99, list[49]);
+		}
+
+		TEST_METHOD(test_indexing_after_reordering)
+		{
+			LinkedList<int> list = { 5, 4, 3, 2, 1 };
+			Assert::AreEqual(3, list[2]);
+			list.sort();
+			Assert::AreEqual(3, list[2]);
+			Assert::AreEqual(4, list[3]);
+			list.reverse();
+			Assert::AreEqual(2, list[3]);
+			list.insert_multiple({ 8, 9 }, 0);
+			Assert::AreEqual(4, list[3]);
+			list.remove(0, 2);
+			Assert::AreEqual(4, list[0]);
+		}
+
+		TEST_METHOD(test_concurrent_const_indexing)
+		{
+			LinkedList<int> list;
+			for (int i = 0; i < 1000; i++)
+				list.append(i);
+			Assert::AreEqual(500, list[500]);
+			const LinkedList<int>& reader = list;
+			std::atomic<int> wrong = 0;
+			ThreadPool pool(3);
+			pool.run(4, [&](size_t chunk) {
+				for (size_t i = chunk; i < reader.size(); i += 4)
+					if (reader[i] != int(i))
+						wrong++;
+			});
+			Assert::AreEqual(0, wrong.load());
+			Assert::AreEqual(501, list[501]);
+		}
+
 		TEST_METHOD(test_vector)
 		{
 			LinkedList<int> list = { 1, 2, 3, 4, 5 };
@@ -578,4 +1418,1115 @@ namespace tests
 		}
 
 	};
+
+	TEST_CLASS(doubly_linked_list)
+	{
+	public:
+
+		TEST_METHOD(test_initializer_list_and_square_brackets)
+		{
+			DoublyLinkedList<int> list = { 1, 2, 3, 4 };
+			Assert::AreEqual(size_t(4), list.size());
+			Assert::AreEqual(1, list[0]);
+			Assert::AreEqual(4, list[3]);
+			Assert::AreEqual(2, list[1]);
+			Assert::AreEqual(1, list.front());
+			Assert::AreEqual(4, list.back());
+		}
+
+		TEST_METHOD(test_square_brackets_out_of_range)
+		{
+			DoublyLinkedList<int> list = { 1 };
+			auto f = [&] { list[1]; };
+			Assert::ExpectException<std::out_of_range>(f);
+		}
+
+		TEST_METHOD(test_reverse_iteration)
+		{
+			DoublyLinkedList<int> list = { 1, 2, 3, 4 };
+			std::vector<int> v(list.rbegin(), list.rend());
+			Assert::IsTrue(v == std::vector<int>({ 4, 3, 2, 1 }));
+			auto it = list.end();
+			--it;
+			Assert::AreEqual(4, *it);
+		}
+
+		TEST_METHOD(test_insert_and_remove)
+		{
+			DoublyLinkedList<int> list = { 1, 2, 3, 4 };
+			list.insert(10, 2);
+			list.insert(20, 5);
+			list.prepend(0);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 0, 1, 2, 10, 3, 4, 20 }));
+			Assert::AreEqual(10, list.remove(3));
+			Assert::AreEqual(0, list.pop_front());
+			Assert::AreEqual(20, list.pop_back());
+			list.remove(1, 2);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 4 }));
+			Assert::AreEqual(4, list.back());
+			Assert::AreEqual(size_t(2), list.size());
+		}
+
+		TEST_METHOD(test_reverse_and_copy)
+		{
+			DoublyLinkedList<int> list1 = { 1, 2, 3 };
+			list1.reverse();
+			DoublyLinkedList<int> list2 = list1;
+			Assert::IsTrue(list1 == list2);
+			Assert::IsTrue(list2.vector() == std::vector<int>({ 3, 2, 1 }));
+			Assert::AreEqual(1, *list2.rbegin());
+			list2.append(0);
+			Assert::IsTrue(list1 != list2);
+		}
+
+		TEST_METHOD(test_position_index)
+		{
+			DoublyLinkedList<int> list;
+			list.enable_position_index();
+			for (int i = 0; i < 5000; i++)
+				list.append(i);
+			for (size_t i = 0; i < 5000; i += 97)
+				Assert::AreEqual(int(i), list[i]);
+			list.insert(-1, 2500);
+			Assert::AreEqual(2499, list[2499]);
+			Assert::AreEqual(-1, list[2500]);
+			Assert::AreEqual(2500, list[2501]);
+			Assert::AreEqual(4000, list[4001]);
+			list.remove(100);
+			Assert::AreEqual(101, list[100]);
+			Assert::AreEqual(4000, list[4000]);
+			Assert::AreEqual(1000, list[999]);
+			list.disable_position_index();
+			Assert::AreEqual(3000, list[3000]);
+		}
+
+		TEST_METHOD(test_position_index_while_growing_and_copying)
+		{
+			DoublyLinkedList<int> list;
+			list.enable_position_index();
+			for (int i = 0; i < 3000; i++)
+			{
+				list.append(i);
+				// Reading while growing rebuilds the index with a larger stride at each power of two.
+				Assert::AreEqual(i / 3, list[size_t(i / 3)]);
+			}
+			DoublyLinkedList<int> copy = list;
+			for (size_t i = 0; i < 3000; i += 101)
+				Assert::AreEqual(int(i), copy[i]);
+			DoublyLinkedList<int> other = { 1, 2 };
+			other.swap(copy);
+			Assert::AreEqual(2999, other[2999]);
+			Assert::AreEqual(2, copy[1]);
+			copy = other;
+			Assert::AreEqual(1500, copy[1500]);
+		}
+
+		TEST_METHOD(test_concurrent_const_indexing)
+		{
+			DoublyLinkedList<int> list;
+			list.enable_position_index();
+			for (int i = 0; i < 5000; i++)
+				list.append(i);
+			Assert::AreEqual(2000, list[2000]);
+			const DoublyLinkedList<int>& reader = list;
+			std::atomic<int> wrong = 0;
+			ThreadPool pool(3);
+			pool.run(4, [&](size_t chunk) {
+				for (size_t i = chunk; i < reader.size(); i += 37)
+					if (reader[i] != int(i))
+						wrong++;
+			});
+			Assert::AreEqual(0, wrong.load());
+			Assert::AreEqual(4000, list[4000]);
+		}
+
+	};
+
+	TEST_CLASS(flat_linked_list)
+	{
+	public:
+
+		TEST_METHOD(test_append_insert_and_square_brackets)
+		{
+			FlatLinkedList<int> list = { 1, 2, 4 };
+			list.insert(3, 2);
+			list.insert(0, 0);
+			list.append(5);
+			Assert::AreEqual(size_t(6), list.size());
+			for (int i = 0; i < 6; i++)
+				Assert::AreEqual(i, list[i]);
+			auto f = [&] { list.insert(9, 7); };
+			Assert::ExpectException<std::out_of_range>(f);
+		}
+
+		TEST_METHOD(test_remove_reuses_slots)
+		{
+			FlatLinkedList<int> list = { 1, 2, 3, 4, 5 };
+			Assert::AreEqual(2, list.remove(1));
+			list.remove(1, 2);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 5 }));
+			const size_t capacity = list.capacity();
+			list.insert(2, 1);
+			list.insert(3, 2);
+			list.insert(4, 3);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 2, 3, 4, 5 }));
+			Assert::AreEqual(capacity, list.capacity());
+		}
+
+		TEST_METHOD(test_compact_keeps_order)
+		{
+			FlatLinkedList<int> list = { 5, 4, 3, 2, 1 };
+			list.reverse();
+			list.remove(2);
+			list.insert_after(list.before_begin(), 0);
+			list.compact();
+			Assert::IsTrue(list.vector() == std::vector<int>({ 0, 1, 2, 4, 5 }));
+			Assert::AreEqual(size_t(5), list.capacity());
+			Assert::AreEqual(4, list[3]);
+			list.append(6);
+			Assert::AreEqual(6, list[5]);
+		}
+
+		TEST_METHOD(test_iterators_and_erase_after)
+		{
+			FlatLinkedList<int> list = { 1, 2, 3, 4 };
+			Assert::AreEqual(10, std::accumulate(list.cbegin(), list.cend(), 0));
+			auto it = list.erase_after(list.begin());
+			Assert::AreEqual(3, *it);
+			list.erase_after(it);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 3 }));
+			list.append(7);
+			Assert::AreEqual(7, list[2]);
+			auto f = [&] { list.erase_after(list.end()); };
+			Assert::ExpectException<std::out_of_range>(f);
+		}
+
+		TEST_METHOD(test_sort_unique_map_filter_reduce)
+		{
+			FlatLinkedList<int> list = { 3, 1, 2, 3, 1 };
+			list.sort();
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 1, 2, 3, 3 }));
+			Assert::AreEqual(size_t(2), list.unique());
+			list.map(square);
+			Assert::IsTrue(list.vector() == std::vector<int>({ 1, 4, 9 }));
+			Assert::AreEqual(size_t(1), list.filter(is_even).size());
+			Assert::AreEqual(14, list.reduce(add));
+		}
+
+		TEST_METHOD(test_copy_and_binary_round_trip)
+		{
+			FlatLinkedList<int> list = { 1, 2, 3, 4 };
+			list.remove(1);
+			FlatLinkedList<int> copy = list;
+			Assert::IsTrue(copy == list);
+			std::stringstream stream;
+			list.write(stream);
+			FlatLinkedList<int> loaded = FlatLinkedList<int>::read(stream);
+			Assert::IsTrue(loaded == list);
+			loaded.insert(2, 1);
+			Assert::IsTrue(loaded.vector() == std::vector<int>({ 1, 2, 3, 4 }));
+		}
+
+		TEST_METHOD(test_concurrent_const_indexing)
+		{
+			FlatLinkedList<int> list;
+			for (int i = 999; i >= 0; i--)
+				list.insert(i, 0);
+			Assert::AreEqual(500, list[500]);
+			const FlatLinkedList<int>& reader = list;
+			std::atomic<int> wrong = 0;
+			ThreadPool pool(3);
+			pool.run(4, [&](size_t chunk) {
+				for (size_t i = chunk; i < reader.size(); i += 4)
+					if (reader[i] != int(i))
+						wrong++;
+			});
+			Assert::AreEqual(0, wrong.load());
+			Assert::AreEqual(501, list[501]);
+		}
+
+		TEST_METHOD(test_reading_corrupt_streams)
+		{
+			FlatLinkedList<int> list = { 1, 2, 3, 4 };
+			list.remove(1);
+			std::stringstream stream;
+			list.write(stream);
+			const std::string bytes = stream.str();
+			using index_type = FlatLinkedList<int>::index_type;
+			// The header is the magic, the version, the slot count, head, tail, free_head, size, and
+			// in_order, and the links follow the 4 values.
+			auto corrupt = [&](size_t field, index_type value) {
+				std::string copy = bytes;
+				std::memcpy(&copy[field * sizeof(index_type)], &value, sizeof(value));
+				std::stringstream bad(copy);
+				FlatLinkedList<int>::read(bad);
+			};
+			auto wrong_magic = [&] { corrupt(0, 0); };
+			Assert::ExpectException<std::runtime_error>(wrong_magic);
+			auto wrong_version = [&] { corrupt(1, 2); };
+			Assert::ExpectException<std::runtime_error>(wrong_version);
+			auto head_out_of_bounds = [&] { corrupt(3, 4); };
+			Assert::ExpectException<std::runtime_error>(head_out_of_bounds);
+			auto link_out_of_bounds = [&] { corrupt(8 + 4 * sizeof(int) / sizeof(index_type), 7); };
+			Assert::ExpectException<std::runtime_error>(link_out_of_bounds);
+			auto cycle = [&] { corrupt(8 + 4 * sizeof(int) / sizeof(index_type) + 2, 0); };
+			Assert::ExpectException<std::runtime_error>(cycle);
+			auto wrong_tail = [&] { corrupt(4, 0); };
+			Assert::ExpectException<std::runtime_error>(wrong_tail);
+			std::stringstream intact(bytes);
+			Assert::IsTrue(FlatLinkedList<int>::read(intact) == list);
+		}
+
+	};
+
+	TEST_CLASS(dijkstra)
+	{
+	public:
+
+		TEST_METHOD(test_graph_map)
+		{
+			Dijkstra::Path<std::string, int> result = Dijkstra::dijkstra(make_example_graph(), std::string("A"), std::string("Z"));
+			Assert::AreEqual(14, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::string>({ "A", "C", "E", "D", "Z" }));
+		}
+
+		TEST_METHOD(test_graph_map_neighbor_only_vertex)
+		{
+			Dijkstra::GraphMap<std::string, int> graph = make_example_graph();
+			graph["Z"].push_back({ "Y", 1 });
+			Dijkstra::Path<std::string, int> result = Dijkstra::dijkstra(graph, std::string("B"), std::string("Y"));
+			Assert::AreEqual(14, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::string>({ "B", "D", "Z", "Y" }));
+			auto f = [&] { Dijkstra::dijkstra(graph, std::string("Y"), std::string("A")); };
+			Assert::ExpectException<std::invalid_argument>(f);
+		}
+
+		TEST_METHOD(test_random_graphs)
+		{
+			srand(31);
+			for (int trial = 0; trial < 20; trial++)
+			{
+				Dijkstra::GraphMap<int, int> graph = make_random_graph(40, 160, 20);
+				Dijkstra::CsrGraph<int, int> csr(graph);
+				for (int end = 0; end < 40; end++)
+				{
+					int expected = -1;
+					try
+					{
+						Dijkstra::Path<int, int> result = Dijkstra::dijkstra(graph, 0, end);
+						Assert::AreEqual(result.cost, path_cost(graph, result.path));
+						expected = result.cost;
+					}
+					catch (std::invalid_argument&) {}
+					int actual = -1;
+					try
+					{
+						Dijkstra::Path<int, int> result = Dijkstra::dijkstra(csr, 0, end);
+						Assert::AreEqual(result.cost, path_cost(graph, result.path));
+						actual = result.cost;
+					}
+					catch (std::invalid_argument&) {}
+					Assert::AreEqual(expected, actual);
+				}
+			}
+		}
+
+		template <class Queue>
+		static void check_queue()
+		{
+			Queue queue(100);
+			std::vector<int> keys(100);
+			for (int v = 0; v < 100; v++)
+			{
+				keys[v] = rand() % 1000 + 1000;
+				queue.push(v, keys[v]);
+			}
+			for (int v = 0; v < 100; v += 3)
+			{
+				keys[v] -= rand() % 1000;
+				queue.push(v, keys[v]);
+			}
+			std::vector<bool> popped(100);
+			int last = 0;
+			while (!queue.empty())
+			{
+				auto [key, vertex] = queue.pop();
+				Assert::IsTrue(key >= last);
+				last = key;
+				if (key == keys[vertex])
+				{
+					Assert::IsFalse(popped[vertex]);
+					popped[vertex] = true;
+				}
+			}
+			Assert::IsTrue(std::all_of(popped.begin(), popped.end(), [](bool b) { return b; }));
+		}
+
+		TEST_METHOD(test_priority_queues)
+		{
+			srand(33);
+			check_queue<LazyBinaryHeap<int>>();
+			check_queue<IndexedDaryHeap<int>>();
+			check_queue<IndexedDaryHeap<int, 2>>();
+			check_queue<PairingHeap<int>>();
+			check_queue<RadixHeap<int>>();
+			check_queue<DialBuckets<int>>();
+			RadixHeap<int> radix_heap(0);
+			radix_heap.push(0, 5);
+			radix_heap.pop();
+			auto f = [&] { radix_heap.push(1, 4); };
+			Assert::ExpectException<std::invalid_argument>(f);
+		}
+
+		template <class Queue>
+		static void check_dijkstra_queue(const Dijkstra::CsrGraph<int, int>& graph)
+		{
+			for (int end = 0; end < int(graph.vertex_count()); end++)
+			{
+				int expected = -1;
+				try
+				{
+					expected = Dijkstra::dijkstra(graph, 0, end).cost;
+				}
+				catch (std::invalid_argument&) {}
+				int actual = -1;
+				try
+				{
+					actual = Dijkstra::dijkstra<Queue>(graph, 0, end).cost;
+				}
+				catch (std::invalid_argument&) {}
+				Assert::AreEqual(expected, actual);
+			}
+		}
+
+		TEST_METHOD(test_dijkstra_queue_policies)
+		{
+			srand(34);
+			for (int trial = 0; trial < 10; trial++)
+			{
+				Dijkstra::CsrGraph<int, int> graph(make_random_graph(50, 250, trial % 2 ? 1000 : 5));
+				check_dijkstra_queue<IndexedDaryHeap<int>>(graph);
+				check_dijkstra_queue<PairingHeap<int>>(graph);
+				check_dijkstra_queue<RadixHeap<int>>(graph);
+				check_dijkstra_queue<DialBuckets<int>>(graph);
+			}
+		}
+
+		TEST_METHOD(test_bidirectional)
+		{
+			Dijkstra::CsrGraph<std::string, int> graph(make_example_graph());
+			Dijkstra::Path<std::string, int> result = Dijkstra::bidirectional_dijkstra(graph, std::string("A"), std::string("Z"));
+			Assert::AreEqual(14, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::string>({ "A", "C", "E", "D", "Z" }));
+		}
+
+		TEST_METHOD(test_bidirectional_and_astar_random_graphs)
+		{
+			srand(34);
+			auto zero = [](unsigned, unsigned) { return 0; };
+			for (int trial = 0; trial < 10; trial++)
+			{
+				Dijkstra::GraphMap<int, int> map = make_random_graph(60, 200, 30);
+				Dijkstra::CsrGraph<int, int> graph(map);
+				Dijkstra::CsrGraph<int, int> reverse = graph.reversed();
+				Dijkstra::LandmarkHeuristic<int, int> landmarks(graph, 4);
+				for (int start = 0; start < 60; start += 7)
+					for (int end = 0; end < 60; end++)
+					{
+						int expected = -1;
+						try
+						{
+							expected = Dijkstra::dijkstra(graph, start, end).cost;
+						}
+						catch (std::invalid_argument&) {}
+						auto check = [&](auto search)
+						{
+							int actual = -1;
+							try
+							{
+								Dijkstra::Path<int, int> result = search();
+								Assert::AreEqual(result.cost, path_cost(map, result.path));
+								Assert::AreEqual(start, result.path.front());
+								Assert::AreEqual(end, result.path.back());
+								actual = result.cost;
+							}
+							catch (std::invalid_argument&) {}
+							Assert::AreEqual(expected, actual);
+						};
+						check([&] { return Dijkstra::bidirectional_dijkstra(graph, reverse, start, end); });
+						check([&] { return Dijkstra::astar(graph, start, end, zero); });
+						check([&] { return Dijkstra::astar(graph, start, end, landmarks); });
+					}
+			}
+		}
+
+		TEST_METHOD(test_astar_coordinates)
+		{
+			// A 10 by 10 grid whose edges cost 10 times their length or more.
+			std::vector<std::pair<double, double>> coordinates;
+			std::vector<int> names;
+			std::vector<Dijkstra::CsrGraph<int, int>::Edge> edges;
+			for (unsigned v = 0; v < 100; v++)
+			{
+				coordinates.push_back({ v % 10, v / 10 });
+				names.push_back(v);
+				if (v % 10 != 9)
+				{
+					edges.push_back({ v, v + 1, 10 + int(v % 3) });
+					edges.push_back({ v + 1, v, 10 + int(v % 3) });
+				}
+				if (v < 90)
+				{
+					edges.push_back({ v, v + 10, 10 + int(v % 7) });
+					edges.push_back({ v + 10, v, 10 + int(v % 7) });
+				}
+			}
+			Dijkstra::CsrGraph<int, int> graph(names, edges);
+			Dijkstra::EuclideanHeuristic<int> euclidean(coordinates, 10);
+			for (int end = 0; end < 100; end += 9)
+				Assert::AreEqual(Dijkstra::dijkstra(graph, 3, end).cost, Dijkstra::astar(graph, 3, end, euclidean).cost);
+
+			// Seattle, Portland, and San Francisco, with road distances in kilometers.
+			Dijkstra::CsrGraph<int, int> cities({ 0, 1, 2 }, { { 0, 1, 280 }, { 1, 2, 1020 }, { 0, 2, 1400 } });
+			Dijkstra::HaversineHeuristic<int> haversine({ { 47.61, -122.33 }, { 45.52, -122.68 }, { 37.77, -122.42 } }, 0.001);
+			Assert::AreEqual(1094, haversine(0u, 2u));
+			Assert::AreEqual(1300, Dijkstra::astar(cities, 0, 2, haversine).cost);
+		}
+
+		template <class Queue>
+		static void check_workspace(const Dijkstra::CsrGraph<int, int>& graph)
+		{
+			Dijkstra::DijkstraWorkspace<int, int, Queue> workspace(graph);
+			std::vector<unsigned> path;
+			for (int i = 0; i < 200; i++)
+			{
+				const unsigned start = rand() % graph.vertex_count();
+				const unsigned end = rand() % graph.vertex_count();
+				const auto tree = Dijkstra::shortest_path_tree_ids(graph, start);
+				const int cost = workspace.query(start, end);
+				Assert::AreEqual(tree.costs[end], cost);
+				if (cost == Dijkstra::unreachable_cost<int>())
+					continue;
+				workspace.path_to(end, path);
+				Assert::AreEqual(start, path.front());
+				Assert::AreEqual(end, path.back());
+			}
+		}
+
+		TEST_METHOD(test_workspace)
+		{
+			srand(37);
+			Dijkstra::CsrGraph<int, int> graph(make_random_graph(60, 180, 25));
+			check_workspace<LazyBinaryHeap<int>>(graph);
+			check_workspace<IndexedDaryHeap<int>>(graph);
+			check_workspace<PairingHeap<int>>(graph);
+			check_workspace<RadixHeap<int>>(graph);
+			check_workspace<DialBuckets<int>>(graph);
+		}
+
+		TEST_METHOD(test_shortest_path_tree)
+		{
+			Dijkstra::CsrGraph<std::string, int> graph(make_example_graph());
+			auto tree = Dijkstra::shortest_path_tree(graph, std::string("A"));
+			Assert::IsTrue(tree.costs == std::vector<int>({ 0, 3, 4, 7, 5, 14 }));
+			Assert::IsTrue(Dijkstra::to_names(graph, tree.path_to(*graph.id("Z"))).path == std::vector<std::string>({ "A", "C", "E", "D", "Z" }));
+			Dijkstra::CsrGraph<int, double> directed({ 1, 2, 3 }, { { 0, 1, 2.5 } });
+			auto directed_tree = Dijkstra::shortest_path_tree(directed, 1);
+			Assert::IsTrue(directed_tree.reachable(1));
+			Assert::IsFalse(directed_tree.reachable(2));
+			Assert::IsTrue(directed_tree.costs[2] == std::numeric_limits<double>::infinity());
+			auto f = [&] { directed_tree.path_to(2); };
+			Assert::ExpectException<std::invalid_argument>(f);
+		}
+
+		TEST_METHOD(test_distance_matrix)
+		{
+			srand(36);
+			Dijkstra::CsrGraph<int, int> graph(make_random_graph(100, 300, 40));
+			std::vector<int> sources, targets;
+			for (int i = 0; i < 30; i++)
+				sources.push_back(rand() % 100);
+			for (int i = 0; i < 20; i++)
+				targets.push_back(rand() % 100);
+			ThreadPool pool(3);
+			std::vector<std::vector<int>> matrix = Dijkstra::distance_matrix(graph, sources, targets, pool);
+			for (size_t i = 0; i < sources.size(); i++)
+			{
+				auto tree = Dijkstra::shortest_path_tree(graph, sources[i]);
+				for (size_t j = 0; j < targets.size(); j++)
+					Assert::AreEqual(tree.costs[*graph.id(targets[j])], matrix[i][j]);
+			}
+			Assert::IsTrue(std::any_of(matrix.begin(), matrix.end(), [](const std::vector<int>& row)
+				{ return std::count(row.begin(), row.end(), Dijkstra::unreachable_cost<int>()) > 0; }));
+		}
+
+		TEST_METHOD(test_delta_stepping)
+		{
+			srand(38);
+			Dijkstra::CsrGraph<int, int> graph(make_random_graph(4000, 16000, 30));
+			ThreadPool pool(3);
+			for (int delta : { 0, 1, 7, 100 })
+			{
+				for (int i = 0; i < 3; i++)
+				{
+					const unsigned source = rand() % graph.vertex_count();
+					const auto expected = Dijkstra::shortest_path_tree_ids(graph, source);
+					const auto tree = Dijkstra::delta_stepping_ids(graph, source, delta, pool);
+					Assert::IsTrue(expected.costs == tree.costs);
+					for (unsigned v = 0; v < graph.vertex_count(); v++)
+					{
+						if (!tree.reachable(v))
+							continue;
+						const std::vector<unsigned> path = tree.path_to(v).path;
+						Assert::AreEqual(source, path.front());
+						int cost = 0;
+						for (size_t j = 1; j < path.size(); j++)
+						{
+							int cheapest = INT_MAX;
+							for (auto e = graph.first_edge(path[j - 1]); e < graph.last_edge(path[j - 1]); e++)
+								if (graph.target(e) == path[j])
+									cheapest = std::min(cheapest, graph.weight(e));
+							cost += cheapest;
+						}
+						Assert::AreEqual(tree.costs[v], cost);
+					}
+				}
+			}
+			Dijkstra::CsrGraph<int, double> directed({ 1, 2, 3 }, { { 0, 1, 2.5 }, { 1, 2, 0.5 } });
+			Assert::IsTrue(Dijkstra::delta_stepping(directed, 1, 1.0).costs == std::vector<double>({ 0, 2.5, 3 }));
+			auto f = [&] { Dijkstra::delta_stepping(directed, 4); };
+			Assert::ExpectException<std::invalid_argument>(f);
+			auto g = [&] { Dijkstra::delta_stepping(directed, 1, -1.0); };
+			Assert::ExpectException<std::invalid_argument>(g);
+		}
+
+		TEST_METHOD(test_dynamic_shortest_paths)
+		{
+			srand(40);
+			const int n = 300;
+			std::map<std::pair<unsigned, unsigned>, int> edges;
+			for (int i = 0; i < 1200; i++)
+			{
+				const std::pair<unsigned, unsigned> edge(rand() % n, rand() % n);
+				const int cost = rand() % 31;
+				if (edges.count(edge) == 0 || cost < edges[edge])
+					edges[edge] = cost;
+			}
+			auto make_graph = [&]
+			{
+				std::vector<int> names(n);
+				std::iota(names.begin(), names.end(), 0);
+				std::vector<Dijkstra::CsrGraph<int, int>::Edge> list;
+				for (const auto& [edge, cost] : edges)
+					list.push_back({ edge.first, edge.second, cost });
+				return Dijkstra::CsrGraph<int, int>(names, list);
+			};
+			Dijkstra::DynamicShortestPaths<int, int> dynamic(make_graph(), 0);
+			const int removed = Dijkstra::unreachable_cost<int>();
+			for (int round = 0; round < 60; round++)
+			{
+				std::vector<Dijkstra::DynamicShortestPaths<int, int>::EdgeUpdate> updates;
+				for (int i = 0, count = 1 + rand() % 8; i < count; i++)
+				{
+					auto it = std::next(edges.begin(), rand() % edges.size());
+					const unsigned source = rand() % 3 ? it->first.first : rand() % n;
+					const unsigned target = rand() % 3 ? it->first.second : rand() % n;
+					const int cost = rand() % 4 ? rand() % 31 : removed;
+					updates.push_back({ source, target, cost });
+					if (cost == removed)
+						edges.erase({ source, target });
+					else
+						edges[{ source, target }] = cost;
+				}
+				dynamic.update(updates);
+				const auto expected = Dijkstra::shortest_path_tree_ids(make_graph(), 0);
+				const auto& tree = dynamic.tree();
+				Assert::IsTrue(expected.costs == tree.costs);
+				for (unsigned v = 1; v < unsigned(n); v++)
+					if (tree.reachable(v))
+						Assert::AreEqual(tree.costs[v], tree.costs[tree.previous[v]] + dynamic.edge_cost(tree.previous[v], v));
+			}
+			Assert::IsTrue(dynamic.touched_count() < unsigned(n));
+			auto f = [&] { dynamic.update(0, n, 1); };
+			Assert::ExpectException<std::invalid_argument>(f);
+		}
+
+		TEST_METHOD(test_csr_graph_conversion)
+		{
+			Dijkstra::GraphMap<std::string, int> graph = make_example_graph();
+			graph["Z"].push_back({ "Y", 1 });
+			Dijkstra::CsrGraph<std::string, int> csr(graph);
+			Assert::AreEqual(size_t(7), size_t(csr.vertex_count()));
+			Assert::AreEqual(size_t(23), size_t(csr.edge_count()));
+			Assert::AreEqual(std::string("Y"), csr.name(*csr.id("Y")));
+			Assert::AreEqual(size_t(0), size_t(csr.last_edge(*csr.id("Y")) - csr.first_edge(*csr.id("Y"))));
+			Assert::IsFalse(bool(csr.id("Q")));
+		}
+
+		TEST_METHOD(test_csr_graph)
+		{
+			Dijkstra::CsrGraph<std::string, int> graph(make_example_graph());
+			Dijkstra::Path<std::string, int> result = Dijkstra::dijkstra(graph, std::string("A"), std::string("Z"));
+			Assert::AreEqual(14, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::string>({ "A", "C", "E", "D", "Z" }));
+			result = Dijkstra::dijkstra(graph, std::string("B"), std::string("B"));
+			Assert::AreEqual(0, result.cost);
+			Assert::AreEqual(size_t(1), result.path.size());
+		}
+
+		TEST_METHOD(test_csr_graph_from_edges)
+		{
+			using Graph = Dijkstra::CsrGraph<int, double>;
+			Graph graph({ 10, 20, 30 }, { { 0, 1, 1.5 }, { 1, 2, 2.0 }, { 0, 2, 4.0 } });
+			Dijkstra::Path<int, double> result = Dijkstra::dijkstra(graph, 10, 30);
+			Assert::AreEqual(3.5, result.cost);
+			Assert::IsTrue(result.path == std::vector<int>({ 10, 20, 30 }));
+			auto f = [&] { Dijkstra::dijkstra(graph, 30, 10); };
+			Assert::ExpectException<std::invalid_argument>(f);
+			auto g = [] { Graph({ 2, 1 }, {}); };
+			Assert::ExpectException<std::invalid_argument>(g);
+		}
+
+		TEST_METHOD(test_csr_graph_write_and_map)
+		{
+			srand(39);
+			Dijkstra::CsrGraph<int, int> graph(make_random_graph(200, 800, 20));
+			const std::string path = (std::filesystem::temp_directory_path() / "csr_graph_test.bin").string();
+			{
+				std::ofstream file(path, std::ios::binary);
+				graph.write(file);
+			}
+			{
+				const auto mapped = Dijkstra::CsrGraph<int, int>::map(path);
+				Assert::AreEqual(graph.vertex_count(), mapped.vertex_count());
+				Assert::IsTrue(std::equal(graph.names().begin(), graph.names().end(), mapped.names().begin()));
+				Assert::IsTrue(std::equal(graph.offsets().begin(), graph.offsets().end(), mapped.offsets().begin()));
+				Assert::IsTrue(std::equal(graph.targets().begin(), graph.targets().end(), mapped.targets().begin()));
+				Assert::IsTrue(std::equal(graph.weights().begin(), graph.weights().end(), mapped.weights().begin()));
+				Assert::IsTrue(Dijkstra::shortest_path_tree_ids(graph, 0).costs == Dijkstra::shortest_path_tree_ids(mapped, 0).costs);
+				auto f = [&] { Dijkstra::CsrGraph<int, double>::map(path); };
+				Assert::ExpectException<std::runtime_error>(f);
+			}
+			{
+				std::ofstream file(path, std::ios::binary);
+				file << "not a graph, but long enough to fill a header";
+			}
+			auto g = [&] { Dijkstra::CsrGraph<int, int>::map(path); };
+			Assert::ExpectException<std::runtime_error>(g);
+			std::filesystem::remove(path);
+		}
+
+		TEST_METHOD(test_read_dimacs_and_edge_list)
+		{
+			const std::string path = (std::filesystem::temp_directory_path() / "graph_parser_test.txt").string();
+			{
+				std::ofstream file(path);
+				file << "c a comment\np sp 4 4\na 1 2 5\na 2 3 1\r\na 1 3 9\n\na 3 4 2";
+			}
+			const auto dimacs = Dijkstra::read_dimacs<int>(path);
+			Assert::AreEqual(4u, dimacs.vertex_count());
+			Assert::AreEqual(std::uint64_t(4), dimacs.edge_count());
+			Dijkstra::Path<std::uint32_t, int> result = Dijkstra::dijkstra(dimacs, 1u, 4u);
+			Assert::AreEqual(8, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::uint32_t>({ 1, 2, 3, 4 }));
+			{
+				std::ofstream file(path);
+				file << "# source target cost\n100 7 1.5\n7 30 2.25\n100 30\n";
+			}
+			const auto edges = Dijkstra::read_edge_list<long long, double>(path);
+			Assert::IsTrue(std::vector<long long>(edges.names().begin(), edges.names().end()) == std::vector<long long>({ 7, 30, 100 }));
+			Assert::AreEqual(1.0, Dijkstra::dijkstra(edges, 100LL, 30LL).cost);
+			{
+				std::ofstream file(path);
+				file << "p sp 2 1\na 1 x 3\n";
+			}
+			auto f = [&] { Dijkstra::read_dimacs<int>(path); };
+			Assert::ExpectException<std::runtime_error>(f);
+			{
+				std::ofstream file(path);
+				file << "p sp 2 1\na 1 3 3\n";
+			}
+			Assert::ExpectException<std::runtime_error>(f);
+			std::filesystem::remove(path);
+		}
+
+	};
+
+	TEST_CLASS(contraction_hierarchy)
+	{
+	public:
+
+		TEST_METHOD(test_example_graph)
+		{
+			Dijkstra::ContractionHierarchy<std::string, int> hierarchy{ Dijkstra::CsrGraph<std::string, int>(make_example_graph()) };
+			Dijkstra::Path<std::string, int> result = hierarchy.query("A", "Z");
+			Assert::AreEqual(14, result.cost);
+			Assert::IsTrue(result.path == std::vector<std::string>({ "A", "C", "E", "D", "Z" }));
+			result = hierarchy.query("Z", "Z");
+			Assert::AreEqual(0, result.cost);
+			Assert::AreEqual(size_t(1), result.path.size());
+		}
+
+		TEST_METHOD(test_random_graphs)
+		{
+			srand(35);
+			for (int trial = 0; trial < 10; trial++)
+			{
+				Dijkstra::GraphMap<int, int> map = make_random_graph(80, trial % 2 ? 160 : 400, 50);
+				Dijkstra::CsrGraph<int, int> graph(map);
+				Dijkstra::ContractionHierarchy<int, int> hierarchy(graph);
+				Dijkstra::ContractionHierarchy<int, int>::Workspace workspace;
+				for (int start = 0; start < 80; start += 3)
+					for (int end = 0; end < 80; end++)
+					{
+						int expected = -1;
+						try
+						{
+							expected = Dijkstra::dijkstra(graph, start, end).cost;
+						}
+						catch (std::invalid_argument&) {}
+						int actual = -1;
+						try
+						{
+							Dijkstra::Path<int, int> result = hierarchy.query(workspace, start, end);
+							Assert::AreEqual(result.cost, path_cost(map, result.path));
+							Assert::AreEqual(start, result.path.front());
+							Assert::AreEqual(end, result.path.back());
+							actual = result.cost;
+						}
+						catch (std::invalid_argument&) {}
+						Assert::AreEqual(expected, actual);
+					}
+			}
+		}
+
+		TEST_METHOD(test_write_and_read)
+		{
+			srand(36);
+			Dijkstra::GraphMap<int, int> map = make_random_graph(50, 200, 20);
+			Dijkstra::ContractionHierarchy<int, int> hierarchy{ Dijkstra::CsrGraph<int, int>(map) };
+			std::stringstream stream;
+			hierarchy.write(stream);
+			Dijkstra::ContractionHierarchy<int, int> copy = Dijkstra::ContractionHierarchy<int, int>::read(stream);
+			Assert::AreEqual(hierarchy.shortcut_count(), copy.shortcut_count());
+			for (int end = 0; end < 50; end++)
+			{
+				try
+				{
+					Dijkstra::Path<int, int> expected = hierarchy.query(0, end);
+					Dijkstra::Path<int, int> actual = copy.query(0, end);
+					Assert::AreEqual(expected.cost, actual.cost);
+					Assert::IsTrue(expected.path == actual.path);
+				}
+				catch (std::invalid_argument&) {}
+			}
+			std::stringstream bad("not a hierarchy, but long enough to fill a header");
+			auto f = [&] { Dijkstra::ContractionHierarchy<int, int>::read(bad); };
+			Assert::ExpectException<std::runtime_error>(f);
+		}
+
+		TEST_METHOD(test_reading_invalid_hierarchies)
+		{
+			// A hand-written hierarchy of 3 vertexes with one up arc, from 0 to 1, that claims to be a
+			// shortcut skipping the given middle vertex, and no other arcs.
+			using Hierarchy = Dijkstra::ContractionHierarchy<int, int>;
+			auto write_hierarchy = [](std::vector<std::uint32_t> ranks, std::uint32_t middle) {
+				std::stringstream stream;
+				auto put = [&](auto value) { stream.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+				for (std::uint64_t field : { std::uint64_t(0x31304843), std::uint64_t(3), std::uint64_t(1), std::uint64_t(0), std::uint64_t(1) })
+					put(field);
+				for (int name : { 10, 20, 30 })
+					put(name);
+				for (std::uint32_t rank : ranks)
+					put(rank);
+				for (std::uint64_t offset : { 0, 1, 1, 1 })
+					put(offset);
+				put(std::uint32_t(1));
+				put(5);
+				put(middle);
+				for (std::uint64_t offset : { 0, 0, 0, 0 })
+					put(offset);
+				return stream;
+			};
+			std::stringstream repeated_rank = write_hierarchy({ 1, 1, 0 }, 2);
+			auto f = [&] { Hierarchy::read(repeated_rank); };
+			Assert::ExpectException<std::runtime_error>(f);
+			std::stringstream middle_out_of_bounds = write_hierarchy({ 1, 2, 0 }, 7);
+			auto g = [&] { Hierarchy::read(middle_out_of_bounds); };
+			Assert::ExpectException<std::runtime_error>(g);
+			std::stringstream middle_ranked_above = write_hierarchy({ 0, 2, 1 }, 2);
+			auto h = [&] { Hierarchy::read(middle_ranked_above); };
+			Assert::ExpectException<std::runtime_error>(h);
+
+			// The shortcut's middle vertex has no arcs to unpack it with, so the query throws.
+			// The workspace must still be reset for the next query.
+			std::stringstream missing_edge = write_hierarchy({ 1, 2, 0 }, 2);
+			Hierarchy hierarchy = Hierarchy::read(missing_edge);
+			Hierarchy::Workspace workspace;
+			auto unpack = [&] { hierarchy.query_ids(workspace, 0, 1); };
+			Assert::ExpectException<std::runtime_error>(unpack);
+			auto no_path = [&] { hierarchy.query_ids(workspace, 2, 1); };
+			Assert::ExpectException<std::invalid_argument>(no_path);
+			Assert::AreEqual(0, hierarchy.query_ids(workspace, 1, 1).cost);
+		}
+
+	};
+
+	TEST_CLASS(btree)
+	{
+	public:
+
+		TEST_METHOD(test_map_matches_std_map)
+		{
+			BTree<int, int> tree;
+			std::map<int, int> expected;
+			srand(45);
+			for (int i = 0; i < 60000; i++)
+			{
+				const int key = rand() % 20000;
+				if (rand() % 3 == 0)
+					Assert::AreEqual(expected.erase(key) == 1, tree.erase(key));
+				else
+					Assert::AreEqual(expected.insert({ key, i }).second, tree.insert(key, i));
+			}
+			Assert::IsTrue(check_btree(tree) >= 3);
+			Assert::AreEqual(expected.size(), tree.size());
+			auto it = tree.begin();
+			for (const auto& [key, value] : expected)
+			{
+				Assert::AreEqual(key, (*it).first);
+				Assert::AreEqual(value, it.value());
+				++it;
+			}
+			Assert::IsTrue(it == tree.end());
+			for (int key = -1; key <= 20000; key++)
+			{
+				Assert::AreEqual(expected.count(key) == 1, tree.contains(key));
+				auto lower = expected.lower_bound(key);
+				auto tree_lower = tree.lower_bound(key);
+				Assert::AreEqual(lower == expected.end(), tree_lower == tree.end());
+				if (lower != expected.end())
+					Assert::AreEqual(lower->first, tree_lower.key());
+				auto upper = expected.upper_bound(key);
+				auto tree_upper = tree.upper_bound(key);
+				Assert::AreEqual(upper == expected.end(), tree_upper == tree.end());
+				if (upper != expected.end())
+					Assert::AreEqual(upper->first, tree_upper.key());
+			}
+
+			for (auto& [key, value] : expected)
+			{
+				value += 1;
+				tree[key] += 1;
+			}
+			tree[-5] = 7;
+			Assert::AreEqual(7, tree.at(-5));
+			Assert::IsTrue(tree.erase(-5));
+			auto f = [&] { tree.at(-5); };
+			Assert::ExpectException<std::out_of_range>(f);
+			for (const auto& [key, value] : expected)
+				Assert::AreEqual(value, tree.at(key));
+
+			for (auto& [key, value] : expected)
+				Assert::IsTrue(tree.erase(key));
+			Assert::IsTrue(tree.empty());
+			Assert::IsTrue(tree.begin() == tree.end());
+			Assert::AreEqual(size_t(0), check_btree(tree));
+		}
+
+		TEST_METHOD(test_set_from_sorted)
+		{
+			for (int count : { 0, 1, 63, 64, 65, 100, 4161, 300000 })
+			{
+				std::vector<int> keys(count);
+				std::iota(keys.begin(), keys.end(), 0);
+				BTree<int> set = BTree<int>::from_sorted(keys.begin(), keys.end());
+				check_btree(set);
+				Assert::IsTrue(std::equal(set.begin(), set.end(), keys.begin(), keys.end()));
+				Assert::IsTrue(std::equal(std::make_reverse_iterator(set.end()), std::make_reverse_iterator(set.begin()), keys.rbegin(), keys.rend()));
+				for (int key = 0; key < count; key += 97)
+				{
+					Assert::IsTrue(set.erase(key));
+					Assert::AreEqual(key + 1 >= count, set.insert(key + 1));
+				}
+				check_btree(set);
+			}
+			std::vector<int> unsorted = { 1, 2, 4, 3 };
+			auto f = [&] { BTree<int>::from_sorted(unsorted.begin(), unsorted.end()); };
+			Assert::ExpectException<std::invalid_argument>(f);
+			std::vector<int> repeated = { 1, 2, 2, 3 };
+			auto g = [&] { BTree<int>::from_sorted(repeated.begin(), repeated.end()); };
+			Assert::ExpectException<std::invalid_argument>(g);
+
+			std::vector<std::pair<std::string, int>> pairs = { { "a", 1 }, { "b", 2 }, { "c", 3 } };
+			BTree<std::string, int> map = BTree<std::string, int>::from_sorted(pairs.begin(), pairs.end());
+			Assert::AreEqual(2, map.at("b"));
+			Assert::IsTrue(map.find("d") == map.end());
+		}
+
+		TEST_METHOD(test_scan_and_traversals)
+		{
+			BTree<int> set;
+			for (int i = 0; i < 10000; i++)
+				set.insert(i * 7 % 10000);
+			std::vector<int> scanned;
+			Assert::AreEqual(size_t(100), set.scan(500, 600, [&](int key) { scanned.push_back(key); }));
+			for (int i = 0; i < 100; i++)
+				Assert::AreEqual(500 + i, scanned[i]);
+			Assert::AreEqual(size_t(0), set.scan(600, 500, [](int) {}));
+			Assert::AreEqual(size_t(10), set.scan(9990, 20000, [](int) {}));
+			int previous = -1;
+			set.inorder([&](int key) { Assert::AreEqual(previous + 1, key); previous = key; });
+			Assert::AreEqual(9999, previous);
+
+			// Each traversal visits every node once. Preorder visits parents first, postorder
+			// visits them last, and level order visits the nodes by increasing depth.
+			size_t preorder_count = 0;
+			size_t postorder_count = 0;
+			size_t level_order_count = 0;
+			size_t last_depth = 0;
+			set.preorder([&](BTree<int>::NodeView node, size_t depth)
+				{
+					Assert::AreEqual(preorder_count == 0, depth == 0);
+					preorder_count += 1;
+				});
+			set.postorder([&](BTree<int>::NodeView node, size_t depth)
+				{
+					postorder_count += 1;
+					Assert::AreEqual(postorder_count == preorder_count, depth == 0);
+				});
+			set.level_order([&](BTree<int>::NodeView node, size_t depth)
+				{
+					Assert::IsTrue(depth >= last_depth);
+					last_depth = depth;
+					level_order_count += 1;
+				});
+			Assert::IsTrue(preorder_count > 1);
+			Assert::AreEqual(preorder_count, postorder_count);
+			Assert::AreEqual(preorder_count, level_order_count);
+		}
+
+		TEST_METHOD(test_node_iterators)
+		{
+			// Compare each order with the same traversal done recursively through NodeView.
+			BTree<int> set;
+			for (int i = 0; i < 30000; i++)
+				set.insert(i * 7919 % 30000);
+			std::vector<std::pair<const int*, size_t>> preorder;
+			std::vector<std::pair<const int*, size_t>> postorder;
+			std::function<void(BTree<int>::NodeView, size_t)> walk = [&](BTree<int>::NodeView node, size_t depth)
+				{
+					preorder.push_back({ &node.key(0), depth });
+					for (size_t i = 0; i < node.child_count(); i++)
+						walk(node.child(i), depth + 1);
+					postorder.push_back({ &node.key(0), depth });
+				};
+			set.preorder([&](BTree<int>::NodeView node, size_t depth) { if (depth == 0) walk(node, 0); });
+			Assert::AreEqual(set.height(), check_btree(set));
+			Assert::IsTrue(set.height() >= 3);
+
+			size_t i = 0;
+			for (auto it = set.preorder_nodes().begin(); it != set.preorder_nodes().end(); ++it, i++)
+				Assert::IsTrue(preorder[i] == std::make_pair(&(*it).key(0), it.depth()));
+			Assert::AreEqual(preorder.size(), i);
+			i = 0;
+			for (auto it = set.postorder_nodes().begin(); it != set.postorder_nodes().end(); ++it, i++)
+				Assert::IsTrue(postorder[i] == std::make_pair(&(*it).key(0), it.depth()));
+			Assert::AreEqual(postorder.size(), i);
+
+			std::vector<std::pair<const int*, size_t>> level_order(preorder);
+			std::stable_sort(level_order.begin(), level_order.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+			i = 0;
+			for (auto it = set.level_order_nodes().begin(); it != set.level_order_nodes().end(); ++it, i++)
+				Assert::IsTrue(level_order[i] == std::make_pair(&(*it).key(0), it.depth()));
+			Assert::AreEqual(level_order.size(), i);
+
+			for (size_t threads : { 0, 1, 3 })
+			{
+				ThreadPool pool(threads);
+				std::vector<std::atomic<int>> visits(level_order.size());
+				std::atomic<size_t> last_depth = 0;
+				set.parallel_level_order([&](BTree<int>::NodeView node, size_t depth)
+					{
+						Assert::IsTrue(depth >= last_depth);
+						last_depth = depth;
+						auto found = std::find(level_order.begin(), level_order.end(), std::make_pair(&node.key(0), depth));
+						visits[found - level_order.begin()] += 1;
+					}, pool);
+				for (const std::atomic<int>& count : visits)
+					Assert::AreEqual(1, count.load());
+			}
+
+			BTree<int> empty;
+			Assert::IsTrue(empty.preorder_nodes().begin() == empty.preorder_nodes().end());
+			Assert::IsTrue(empty.postorder_nodes().begin() == empty.postorder_nodes().end());
+			Assert::IsTrue(empty.level_order_nodes().begin() == empty.level_order_nodes().end());
+			Assert::AreEqual(size_t(0), empty.height());
+		}
+
+		TEST_METHOD(test_print_write_and_read)
+		{
+			// 100 keys fill one leaf of 64 keys and part of another.
+			std::vector<int> keys(100);
+			std::iota(keys.begin(), keys.end(), 1);
+			BTree<int> small = BTree<int>::from_sorted(keys.begin(), keys.end());
+			std::ostringstream printed;
+			small.print(printed);
+			std::string expected = "[65]\n[1";
+			for (int key = 2; key <= 100; key++)
+				expected += (key == 65 ? "] [" : " ") + std::to_string(key);
+			Assert::AreEqual(expected + "]\n", printed.str());
+
+			BTree<int, double> tree;
+			for (int i = 0; i < 20000; i++)
+				tree.insert(i * 31 % 20000, i / 2.0);
+			for (int i = 0; i < 20000; i += 3)
+				tree.erase(i);
+			std::stringstream stream;
+			tree.write(stream);
+			BTree<int, double> copy = BTree<int, double>::read(stream);
+			Assert::IsTrue(copy == tree);
+			std::ostringstream tree_printed;
+			std::ostringstream copy_printed;
+			tree.print(tree_printed);
+			copy.print(copy_printed);
+			Assert::AreEqual(tree_printed.str(), copy_printed.str());
+			check_btree(copy);
+			Assert::IsTrue(copy.insert(0, 1.5));
+
+			std::stringstream empty_stream;
+			BTree<int, double>().write(empty_stream);
+			Assert::IsTrue(BTree<int, double>::read(empty_stream).empty());
+
+			std::string truncated = stream.str();
+			truncated.resize(truncated.size() / 2);
+			std::istringstream truncated_stream(truncated);
+			auto f = [&] { BTree<int, double>::read(truncated_stream); };
+			Assert::ExpectException<std::runtime_error>(f);
+			std::istringstream wrong_type(stream.str());
+			auto g = [&] { BTree<std::int64_t, double>::read(wrong_type); };
+			Assert::ExpectException<std::runtime_error>(g);
+		}
+
+		TEST_METHOD(test_copy_and_move)
+		{
+			BTree<int, std::string> tree;
+			for (int i = 0; i < 5000; i++)
+				tree.insert(i, std::to_string(i));
+			BTree<int, std::string> copy = tree;
+			check_btree(copy);
+			Assert::IsTrue(copy == tree);
+			copy[5] = "five";
+			Assert::IsTrue(copy != tree);
+			BTree<int, std::string> moved = std::move(copy);
+			Assert::IsTrue(copy.empty());
+			Assert::AreEqual(std::string("five"), moved.at(5));
+			copy = moved;
+			Assert::IsTrue(copy == moved);
+			copy.insert(5000, "new");
+			Assert::AreEqual(size_t(5001), copy.size());
+			check_btree(copy);
+		}
+
+	};
 }
@@ -0,0 +1,67 @@
+// Converts a DIMACS shortest path file or a text edge list to the binary CSR graph format that
+// Dijkstra::CsrGraph::map opens in place, and then times mapping the result and searching it.
+// Usage: convert_graph <input> <output> [dimacs|edges]
+// Files ending in .gr are read as DIMACS by default, and anything else as an edge list.
+// The graph has 32-bit unsigned vertex names and int costs, so it can be opened with
+// Dijkstra::CsrGraph<std::uint32_t, int>::map.
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+#include "../Algorithms/dijkstra.h"
+#include "../Algorithms/graph_parsers.h"
+
+using Graph = Dijkstra::CsrGraph<std::uint32_t, int>;
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::fprintf(stderr, "Usage: convert_graph <input> <output> [dimacs|edges]\n");
+		return 2;
+	}
+	const std::string input = argv[1];
+	const std::string output = argv[2];
+	const bool dimacs = argc > 3 ? std::string(argv[3]) == "dimacs" : input.size() > 3 && input.substr(input.size() - 3) == ".gr";
+	try
+	{
+		auto start = std::chrono::steady_clock::now();
+		const Graph graph = dimacs ? Dijkstra::read_dimacs<int>(input) : Dijkstra::read_edge_list<std::uint32_t, int>(input);
+		std::printf("parsed %u vertexes and %llu edges in %.3f s\n",
+			unsigned(graph.vertex_count()), (unsigned long long)graph.edge_count(), seconds_since(start));
+
+		start = std::chrono::steady_clock::now();
+		{
+			std::ofstream file(output, std::ios::binary);
+			graph.write(file);
+			if (!file.flush())
+				throw std::runtime_error("Unable to write " + output);
+		}
+		std::printf("wrote %s in %.3f s\n", output.c_str(), seconds_since(start));
+
+		start = std::chrono::steady_clock::now();
+		const Graph mapped = Graph::map(output);
+		std::printf("mapped it in %.6f s\n", seconds_since(start));
+		if (mapped.vertex_count() > 0)
+		{
+			start = std::chrono::steady_clock::now();
+			const auto tree = Dijkstra::shortest_path_tree_ids(mapped, 0);
+			size_t reached = 0;
+			for (Graph::VertexId v = 0; v < mapped.vertex_count(); v++)
+				reached += tree.reachable(v);
+			std::printf("searched from vertex %u to %zu vertexes in %.3f s\n", unsigned(mapped.name(0)), reached, seconds_since(start));
+		}
+	}
+	catch (const std::exception& error)
+	{
+		std::fprintf(stderr, "%s\n", error.what());
+		return 1;
+	}
+}